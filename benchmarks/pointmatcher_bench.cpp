@@ -0,0 +1,475 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "pointmatcher/PointMatcher.h"
+#include "pointmatcher/IOFunctions.h"
+#include "synthetic_clouds.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+typedef PointMatcher<float> PM;
+typedef PM::DataPoints DP;
+typedef SyntheticClouds<float> Clouds;
+typedef PointMatcherSupport::Parametrizable::Parameters Parameters;
+using PointMatcherSupport::jsonString;
+
+//! Options of the command line
+struct Options
+{
+	vector<size_t> sizes = {10000, 100000};
+	vector<string> shapes = Clouds::shapes();
+	vector<string> kinds = {"DataPointsFilter", "Matcher", "OutlierFilter", "ErrorMinimizer", "ICP"};
+	vector<string> modules;
+	unsigned repeats = 5;
+	string config;
+	string output;
+	
+	bool runs(const string& kind) const
+	{
+		return find(kinds.begin(), kinds.end(), kind) != kinds.end();
+	}
+	bool runs(const string& kind, const string& module) const
+	{
+		return runs(kind) && (modules.empty() || find(modules.begin(), modules.end(), module) != modules.end());
+	}
+};
+
+//! Durations of the repeats of an operation of a module, or the error that stopped it
+struct Result
+{
+	string kind;
+	string module;
+	string operation;
+	string shape;
+	size_t pointCount;
+	vector<double> durations;
+	size_t outputCount = 0;
+	map<string, double> metrics;
+	string error;
+};
+typedef vector<Result> Results;
+
+//! Parameters and prerequisite filters of the modules that cannot run with their default parameters on the synthetic clouds
+struct ModuleSetup
+{
+	Parameters parameters;
+	vector<pair<string, Parameters>> prerequisites;
+};
+
+static const map<string, ModuleSetup>& moduleSetups()
+{
+	static const map<string, ModuleSetup> setups = {
+		{"CutAtDescriptorThresholdDataPointsFilter", {{{"descName", "intensity"}, {"threshold", "0.5"}}, {}}},
+		{"MaxDensityDataPointsFilter", {{}, {{"SurfaceNormalDataPointsFilter", {{"keepDensities", "1"}}}}}},
+		{"SphericalityDataPointsFilter", {{}, {{"SurfaceNormalDataPointsFilter", {{"keepEigenValues", "1"}}}}}},
+		{"GenericDescriptorOutlierFilter", {{{"descName", "intensity"}}, {}}}
+	};
+	return setups;
+}
+
+//! Return the parameters to create the module name with
+static Parameters setupParameters(const string& name)
+{
+	const auto it(moduleSetups().find(name));
+	return it == moduleSetups().end() ? Parameters() : it->second.parameters;
+}
+
+//! Apply to cloud the filters the module name needs to have run first
+static void applyPrerequisites(const string& name, DP& cloud)
+{
+	const auto it(moduleSetups().find(name));
+	if (it == moduleSetups().end())
+		return;
+	for (const auto& prerequisite: it->second.prerequisites)
+		PM::get().REG(DataPointsFilter).create(prerequisite.first, prerequisite.second)->inPlaceFilter(cloud);
+}
+
+//! Time run repeats times, calling prepare untimed before every run, and record the number of output items of the last run
+static void measure(Result& result, const unsigned repeats, const function<void()>& prepare, const function<size_t()>& run)
+{
+	try
+	{
+		for (unsigned r = 0; r < repeats; ++r)
+		{
+			prepare();
+			const chrono::steady_clock::time_point start(chrono::steady_clock::now());
+			result.outputCount = run();
+			result.durations.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+		}
+	}
+	catch (const exception& e)
+	{
+		result.durations.clear();
+		result.error = e.what();
+	}
+	
+	cerr << result.kind << " " << result.module << " " << result.operation << " on " << result.pointCount << " points of " << result.shape << ": ";
+	if (result.error.empty())
+		cerr << *min_element(result.durations.begin(), result.durations.end()) << " s" << endl;
+	else
+		cerr << "error, " << result.error << endl;
+}
+
+//! Return a new result for an operation of module
+static Result makeResult(const string& kind, const string& module, const string& operation, const string& shape, const size_t pointCount)
+{
+	Result result;
+	result.kind = kind;
+	result.module = module;
+	result.operation = operation;
+	result.shape = shape;
+	result.pointCount = pointCount;
+	return result;
+}
+
+//! Transformation of the reading clouds in the frame of the reference clouds, the registrations should find it
+static PM::TransformationParameters groundTruth()
+{
+	Eigen::Affine3f transform(Eigen::AngleAxisf(0.1f, Eigen::Vector3f(0.2f, 0.3f, 1.f).normalized()));
+	transform.translation() = Eigen::Vector3f(0.2f, -0.1f, 0.05f);
+	return transform.matrix();
+}
+
+static void benchDataPointsFilters(const Options& options, const string& shape, const DP& cloud, Results& results)
+{
+	for (const auto& entry: PM::get().REG(DataPointsFilter))
+	{
+		const string& name(entry.first);
+		if (!options.runs("DataPointsFilter", name))
+			continue;
+		Result result(makeResult("DataPointsFilter", name, "inPlaceFilter", shape, cloud.getNbPoints()));
+		try
+		{
+			const shared_ptr<PM::DataPointsFilter> filter(PM::get().REG(DataPointsFilter).create(name, setupParameters(name)));
+			DP input(cloud);
+			applyPrerequisites(name, input);
+			DP filtered;
+			measure(result, options.repeats,
+				[&]() { filtered = input; filter->init(); },
+				[&]() { filter->inPlaceFilter(filtered); return size_t(filtered.getNbPoints()); }
+			);
+		}
+		catch (const exception& e)
+		{
+			result.error = e.what();
+		}
+		results.push_back(result);
+	}
+}
+
+static void benchMatchers(const Options& options, const string& shape, const DP& reference, const DP& reading, Results& results)
+{
+	for (const auto& entry: PM::get().REG(Matcher))
+	{
+		const string& name(entry.first);
+		if (!options.runs("Matcher", name))
+			continue;
+		Result initResult(makeResult("Matcher", name, "init", shape, reference.getNbPoints()));
+		Result findResult(makeResult("Matcher", name, "findClosests", shape, reading.getNbPoints()));
+		try
+		{
+			const shared_ptr<PM::Matcher> matcher(PM::get().REG(Matcher).create(name, setupParameters(name)));
+			measure(initResult, options.repeats,
+				[]() {},
+				[&]() { matcher->init(reference); return size_t(reference.getNbPoints()); }
+			);
+			if (initResult.error.empty())
+				measure(findResult, options.repeats,
+					[]() {},
+					[&]() { return size_t(matcher->findClosests(reading).ids.cols()); }
+				);
+			else
+				findResult.error = initResult.error;
+		}
+		catch (const exception& e)
+		{
+			initResult.error = findResult.error = e.what();
+		}
+		results.push_back(initResult);
+		results.push_back(findResult);
+	}
+}
+
+static void benchOutlierFilters(const Options& options, const string& shape, const DP& reference, const DP& reading, const PM::Matches& matches, Results& results)
+{
+	for (const auto& entry: PM::get().REG(OutlierFilter))
+	{
+		const string& name(entry.first);
+		if (!options.runs("OutlierFilter", name))
+			continue;
+		Result result(makeResult("OutlierFilter", name, "compute", shape, reading.getNbPoints()));
+		try
+		{
+			const shared_ptr<PM::OutlierFilter> filter(PM::get().REG(OutlierFilter).create(name, setupParameters(name)));
+			measure(result, options.repeats,
+				[]() {},
+				[&]() { return size_t((filter->compute(reading, reference, matches).array() > 0).count()); }
+			);
+		}
+		catch (const exception& e)
+		{
+			result.error = e.what();
+		}
+		results.push_back(result);
+	}
+}
+
+static void benchErrorMinimizers(const Options& options, const string& shape, const DP& reference, const DP& reading, const PM::Matches& matches, const PM::OutlierWeights& weights, Results& results)
+{
+	for (const auto& entry: PM::get().REG(ErrorMinimizer))
+	{
+		const string& name(entry.first);
+		if (!options.runs("ErrorMinimizer", name))
+			continue;
+		Result result(makeResult("ErrorMinimizer", name, "compute", shape, reading.getNbPoints()));
+		try
+		{
+			const shared_ptr<PM::ErrorMinimizer> minimizer(PM::get().REG(ErrorMinimizer).create(name, setupParameters(name)));
+			measure(result, options.repeats,
+				[]() {},
+				[&]() { minimizer->compute(reading, reference, weights, matches); return size_t(std::round(minimizer->getPointUsedRatio() * matches.ids.size())); }
+			);
+		}
+		catch (const exception& e)
+		{
+			result.error = e.what();
+		}
+		results.push_back(result);
+	}
+}
+
+static void benchICP(const Options& options, const string& shape, const DP& reference, const DP& reading, Results& results)
+{
+	PM::ICP icp;
+	if (options.config.empty())
+	{
+		icp.setDefault();
+	}
+	else
+	{
+		ifstream chain(options.config.c_str());
+		if (!chain.good())
+			throw runtime_error("Cannot open ICP configuration " + options.config);
+		icp.loadFromYaml(chain);
+	}
+	if (!icp.inspector)
+		icp.inspector = PM::get().REG(Inspector).create("NullInspector");
+	
+	Result result(makeResult("ICP", options.config.empty() ? "default" : options.config, "compute", shape, reading.getNbPoints()));
+	PM::TransformationParameters transform;
+	measure(result, options.repeats,
+		[]() {},
+		[&]() { transform = icp(reading, reference); return size_t(icp.getReadingFiltered().getNbPoints()); }
+	);
+	if (result.error.empty())
+	{
+		const PM::TransformationParameters error(groundTruth().inverse() * transform);
+		result.metrics["translationError"] = error.topRightCorner(3, 1).norm();
+		result.metrics["rotationError"] = Eigen::AngleAxisf(Eigen::Matrix3f(error.topLeftCorner(3, 3))).angle();
+	}
+	results.push_back(result);
+}
+
+//! Return name quoted and escaped as a JSON string
+static void writeJSON(ostream& stream, const Options& options, const Results& results)
+{
+	stream.precision(9);
+	stream << "{\n";
+	stream << "  \"version\": " << jsonString(POINTMATCHER_VERSION) << ",\n";
+	stream << "  \"scalarType\": \"float\",\n";
+	stream << "  \"hardwareThreads\": " << thread::hardware_concurrency() << ",\n";
+	stream << "  \"repeats\": " << options.repeats << ",\n";
+	stream << "  \"results\": [";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result& result(results[i]);
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << "    {\"kind\": " << jsonString(result.kind) << ", \"module\": " << jsonString(result.module);
+		stream << ", \"operation\": " << jsonString(result.operation) << ", \"shape\": " << jsonString(result.shape);
+		stream << ", \"points\": " << result.pointCount;
+		if (!result.error.empty())
+		{
+			stream << ", \"error\": " << jsonString(result.error) << "}";
+			continue;
+		}
+		vector<double> durations(result.durations);
+		sort(durations.begin(), durations.end());
+		const double median(durations[durations.size() / 2]);
+		const double mean(accumulate(durations.begin(), durations.end(), 0.) / durations.size());
+		stream << ", \"outputCount\": " << result.outputCount;
+		stream << ", \"minDuration\": " << durations.front() << ", \"medianDuration\": " << median << ", \"meanDuration\": " << mean;
+		stream << ", \"pointsPerSecond\": " << (median > 0 ? result.pointCount / median : 0.);
+		for (const auto& metric: result.metrics)
+			stream << ", " << jsonString(metric.first) << ": " << metric.second;
+		stream << "}";
+	}
+	stream << "\n  ]\n}\n";
+}
+
+//! Split a comma-separated list
+static vector<string> splitList(const string& list)
+{
+	vector<string> items;
+	istringstream stream(list);
+	string item;
+	while (getline(stream, item, ','))
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+static void usage(const char* name)
+{
+	cerr << "Usage: " << name << " [OPTIONS]\n\n";
+	cerr << "Benchmark the registered modules and the ICP chain on deterministic synthetic clouds, and write the timings as JSON.\n\n";
+	cerr << "Options:\n";
+	cerr << "  --sizes LIST     comma-separated point counts (default: 10000,100000)\n";
+	cerr << "  --shapes LIST    comma-separated shapes among planes, corridor and sphere (default: all)\n";
+	cerr << "  --kinds LIST     comma-separated benchmarks among DataPointsFilter, Matcher, OutlierFilter, ErrorMinimizer and ICP (default: all)\n";
+	cerr << "  --modules LIST   comma-separated module names to benchmark (default: all registered modules)\n";
+	cerr << "  --repeats N      number of timed runs of every benchmark (default: 5)\n";
+	cerr << "  --config FILE    YAML configuration of the ICP chain (default: the chain of ICP::setDefault())\n";
+	cerr << "  --output FILE    file to write the JSON results to (default: standard output)\n";
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const string option(argv[i]);
+		if (option == "--help" || option == "-h")
+		{
+			usage(argv[0]);
+			return 0;
+		}
+		if (i + 1 >= argc)
+		{
+			cerr << "Missing value for option " << option << "\n\n";
+			usage(argv[0]);
+			return 1;
+		}
+		const string value(argv[++i]);
+		if (option == "--sizes")
+		{
+			options.sizes.clear();
+			for (const string& size: splitList(value))
+				options.sizes.push_back(stoul(size));
+		}
+		else if (option == "--shapes")
+			options.shapes = splitList(value);
+		else if (option == "--kinds")
+			options.kinds = splitList(value);
+		else if (option == "--modules")
+			options.modules = splitList(value);
+		else if (option == "--repeats")
+			options.repeats = max(1, atoi(value.c_str()));
+		else if (option == "--config")
+			options.config = value;
+		else if (option == "--output")
+			options.output = value;
+		else
+		{
+			cerr << "Unknown option " << option << "\n\n";
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	
+	Results results;
+	try
+	{
+		const shared_ptr<PM::Transformation> rigidTransformation(PM::get().REG(Transformation).create("RigidTransformation"));
+		for (const string& shape: options.shapes)
+		{
+			for (const size_t size: options.sizes)
+			{
+				const DP reference(Clouds::generate(shape, size, 1));
+				const DP reading(rigidTransformation->compute(Clouds::generate(shape, size, 2), groundTruth().inverse()));
+				
+				if (options.runs("DataPointsFilter"))
+					benchDataPointsFilters(options, shape, reference, results);
+				if (options.runs("Matcher"))
+					benchMatchers(options, shape, reference, reading, results);
+				if (options.runs("OutlierFilter") || options.runs("ErrorMinimizer"))
+				{
+					const shared_ptr<PM::Matcher> matcher(PM::get().REG(Matcher).create("KDTreeMatcher"));
+					matcher->init(reference);
+					const PM::Matches matches(matcher->findClosests(reading));
+					if (options.runs("OutlierFilter"))
+						benchOutlierFilters(options, shape, reference, reading, matches, results);
+					if (options.runs("ErrorMinimizer"))
+					{
+						const PM::OutlierWeights weights(PM::get().REG(OutlierFilter).create("TrimmedDistOutlierFilter")->compute(reading, reference, matches));
+						benchErrorMinimizers(options, shape, reference, reading, matches, weights, results);
+					}
+				}
+				if (options.runs("ICP"))
+					benchICP(options, shape, reference, reading, results);
+			}
+		}
+	}
+	catch (const exception& e)
+	{
+		cerr << "Error: " << e.what() << endl;
+		return 1;
+	}
+	
+	if (options.output.empty())
+		writeJSON(cout, options, results);
+	else
+	{
+		ofstream output(options.output.c_str());
+		if (!output.good())
+		{
+			cerr << "Cannot open output file " << options.output << endl;
+			return 1;
+		}
+		writeJSON(output, options, results);
+	}
+	return 0;
+}
@@ -0,0 +1,250 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef __POINTMATCHER_BENCHMARKS_SYNTHETIC_CLOUDS_H
+#define __POINTMATCHER_BENCHMARKS_SYNTHETIC_CLOUDS_H
+
+#include "pointmatcher/PointMatcher.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Deterministic synthetic 3D clouds, used to benchmark the modules without downloading datasets
+/*!
+	The clouds only depend on their shape, point count and seed, on every
+	platform: the random numbers are drawn from std::mt19937, whose output is
+	fixed by the standard, and converted without the standard distributions,
+	whose output is not. Every cloud comes with exact normals, the
+	observation directions and incidence angles from a sensor placed inside
+	the shape, a uniform intensity in [0,1) and a maxSearchDist of 1, so that
+	the modules needing these descriptors can run on them directly.
+*/
+template<typename T>
+struct SyntheticClouds
+{
+	typedef typename PointMatcher<T>::DataPoints DataPoints; //!< alias
+	typedef typename DataPoints::Label Label; //!< alias
+	typedef typename DataPoints::Labels Labels; //!< alias
+	typedef Eigen::Matrix<double, 3, 1> Vector3; //!< a point or direction, generated in double precision
+	
+	//! Random numbers giving the same sequence on every platform
+	struct Random
+	{
+		Random(const std::uint32_t seed):
+			engine(seed)
+		{}
+		
+		//! Return a number uniformly distributed in [0,1)
+		double uniform()
+		{
+			return (engine() >> 5) * (1. / 134217728.);
+		}
+		
+		//! Return a number following the standard normal distribution, using the Box-Muller transform
+		double normal()
+		{
+			const double radius(std::sqrt(-2. * std::log(1. - uniform())));
+			return radius * std::cos(2. * M_PI * uniform());
+		}
+		
+	private:
+		std::mt19937 engine;
+	};
+	
+	//! Rectangular face of a shape, spanned by two edges from a corner
+	struct Face
+	{
+		Vector3 corner;
+		Vector3 edgeU;
+		Vector3 edgeV;
+		
+		double area() const { return edgeU.cross(edgeV).norm(); }
+		Vector3 normal() const { return edgeU.cross(edgeV).normalized(); }
+	};
+	typedef std::vector<Face> Faces;
+	
+	//! Return the names of the available shapes
+	static std::vector<std::string> shapes()
+	{
+		return {"planes", "corridor", "sphere"};
+	}
+	
+	//! Return a cloud of pointCount points on the given shape
+	static DataPoints generate(const std::string& shape, const size_t pointCount, const std::uint32_t seed)
+	{
+		if (shape == "planes")
+			return planes(pointCount, seed);
+		if (shape == "corridor")
+			return corridor(pointCount, seed);
+		if (shape == "sphere")
+			return sphere(pointCount, seed);
+		throw std::runtime_error("Unknown synthetic shape " + shape + ", must be planes, corridor or sphere");
+	}
+	
+	//! Return the corner of a room, a 10 m floor and two 3 m high walls, seen from its middle, with 5 mm of noise
+	static DataPoints planes(const size_t pointCount, const std::uint32_t seed)
+	{
+		const Faces faces = {
+			{Vector3(0, 0, 0), Vector3(10, 0, 0), Vector3(0, 10, 0)},
+			{Vector3(0, 0, 0), Vector3(0, 10, 0), Vector3(0, 0, 3)},
+			{Vector3(0, 0, 0), Vector3(0, 0, 3), Vector3(10, 0, 0)}
+		};
+		return sampleFaces(faces, Vector3(5, 5, 1.5), 0.005, pointCount, seed);
+	}
+	
+	//! Return a 40 m long, 2 m wide and 2.5 m high corridor along x, seen from its middle, with 5 mm of noise
+	/*!
+		Registrations on this shape are unconstrained along the corridor.
+	*/
+	static DataPoints corridor(const size_t pointCount, const std::uint32_t seed)
+	{
+		const Faces faces = {
+			{Vector3(0, -1, 0), Vector3(40, 0, 0), Vector3(0, 2, 0)},
+			{Vector3(0, -1, 2.5), Vector3(0, 2, 0), Vector3(40, 0, 0)},
+			{Vector3(0, -1, 0), Vector3(0, 0, 2.5), Vector3(40, 0, 0)},
+			{Vector3(0, 1, 0), Vector3(40, 0, 0), Vector3(0, 0, 2.5)}
+		};
+		return sampleFaces(faces, Vector3(20, 0, 1.2), 0.005, pointCount, seed);
+	}
+	
+	//! Return a sphere of radius 5 m seen from its center, with 5 cm of radial noise
+	/*!
+		Registrations on this shape are unconstrained in rotation.
+	*/
+	static DataPoints sphere(const size_t pointCount, const std::uint32_t seed)
+	{
+		Random random(seed);
+		DataPoints cloud(allocate(pointCount));
+		Writer writer(cloud);
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			const double z(2. * random.uniform() - 1.);
+			const double angle(2. * M_PI * random.uniform());
+			const double planar(std::sqrt(1. - z * z));
+			const Vector3 direction(planar * std::cos(angle), planar * std::sin(angle), z);
+			const double radius(5. + 0.05 * random.normal());
+			writer.set(i, radius * direction, -direction, Vector3::Zero(), random);
+		}
+		return cloud;
+	}
+	
+private:
+	//! Return a cloud of pointCount points with the features and descriptors of the synthetic clouds
+	static DataPoints allocate(const size_t pointCount)
+	{
+		Labels featureLabels;
+		featureLabels.push_back(Label("x", 1));
+		featureLabels.push_back(Label("y", 1));
+		featureLabels.push_back(Label("z", 1));
+		featureLabels.push_back(Label("pad", 1));
+		Labels descriptorLabels;
+		descriptorLabels.push_back(Label("normals", 3));
+		descriptorLabels.push_back(Label("observationDirections", 3));
+		descriptorLabels.push_back(Label("incidenceAngles", 1));
+		descriptorLabels.push_back(Label("intensity", 1));
+		descriptorLabels.push_back(Label("maxSearchDist", 1));
+		DataPoints cloud(featureLabels, descriptorLabels, pointCount);
+		cloud.features.row(3).setOnes();
+		cloud.getDescriptorViewByName("maxSearchDist").setOnes();
+		return cloud;
+	}
+	
+	//! Writes the points of a cloud allocated by allocate() and their descriptors
+	struct Writer
+	{
+		Writer(DataPoints& cloud):
+			features(cloud.features),
+			normals(cloud.getDescriptorViewByName("normals")),
+			observationDirections(cloud.getDescriptorViewByName("observationDirections")),
+			incidenceAngles(cloud.getDescriptorViewByName("incidenceAngles")),
+			intensity(cloud.getDescriptorViewByName("intensity"))
+		{}
+		
+		//! Set the point i, its normal being oriented toward the sensor
+		void set(const size_t i, const Vector3& point, const Vector3& normal, const Vector3& sensor, Random& random)
+		{
+			const Vector3 observationDirection(sensor - point);
+			const Vector3 orientedNormal(normal.dot(observationDirection) < 0 ? Vector3(-normal) : normal);
+			features.col(i).head(3) = point.cast<T>();
+			normals.col(i) = orientedNormal.cast<T>();
+			observationDirections.col(i) = observationDirection.cast<T>();
+			incidenceAngles(0, i) = T(std::acos(observationDirection.normalized().dot(orientedNormal)));
+			intensity(0, i) = T(random.uniform());
+		}
+		
+	private:
+		typename PointMatcher<T>::Matrix& features;
+		typename DataPoints::View normals;
+		typename DataPoints::View observationDirections;
+		typename DataPoints::View incidenceAngles;
+		typename DataPoints::View intensity;
+	};
+	
+	//! Return pointCount points drawn uniformly on the faces, offset along their normal by a normal noise of standard deviation noise
+	static DataPoints sampleFaces(const Faces& faces, const Vector3& sensor, const double noise, const size_t pointCount, const std::uint32_t seed)
+	{
+		std::vector<double> cumulatedAreas;
+		double totalArea(0);
+		for (const Face& face: faces)
+		{
+			totalArea += face.area();
+			cumulatedAreas.push_back(totalArea);
+		}
+		
+		Random random(seed);
+		DataPoints cloud(allocate(pointCount));
+		Writer writer(cloud);
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			const double area(random.uniform() * totalArea);
+			size_t f(0);
+			while (f + 1 < faces.size() && cumulatedAreas[f] <= area)
+				++f;
+			const Face& face(faces[f]);
+			const Vector3 normal(face.normal());
+			const double u(random.uniform());
+			const double v(random.uniform());
+			const Vector3 point(face.corner + u * face.edgeU + v * face.edgeV + noise * random.normal() * normal);
+			writer.set(i, point, normal, sensor, random);
+		}
+		return cloud;
+	}
+};
+
+#endif // __POINTMATCHER_BENCHMARKS_SYNTHETIC_CLOUDS_H
@@ -593,13 +593,21 @@ EvaluationModule::EvaluationModule():
 
 void EvaluationModule::evaluateSolution(const string &tmp_file_name, const string &yaml_config, const int &coreId, PMIO::FileInfoVector::const_iterator it_eval, PMIO::FileInfoVector::const_iterator it_end)
 {
-	PM::DataPoints refCloud, readCloud;
+	PM::DataPoints readCloud;
 	string last_read_name = "";
 	string last_ref_name = "";
 	const int count = std::distance(it_eval, it_end);
 	int current_line = 0;
 	timer t_eval_list;
 
+	// Build ICP based on config file
+	PM::ICP icp;
+	ifstream ifs(yaml_config.c_str());
+	icp.loadFromYaml(ifs);
+
+	// Consecutive tests often share their reference, which is then filtered and indexed once
+	std::shared_ptr<const PM::ICP::PreparedReference> refCloud;
+
 	std::ofstream fout(tmp_file_name.c_str());
 	if (!fout.good())
 	{
@@ -620,15 +628,10 @@ void EvaluationModule::evaluateSolution(const string &tmp_file_name, const strin
 
 		if(last_ref_name != it_eval->referenceFileName)
 		{
-			refCloud = PM::DataPoints::load(it_eval->referenceFileName);
+			refCloud = icp.prepareReference(PM::DataPoints::load(it_eval->referenceFileName));
 			last_ref_name = it_eval->referenceFileName;
 		}
 
-		// Build ICP based on config file
-		PM::ICP icp;
-		ifstream ifs(yaml_config.c_str());
-		icp.loadFromYaml(ifs);
-
 		const TP Tinit = it_eval->initialTransformation;
 
 		timer t_icp;
@@ -638,7 +641,7 @@ void EvaluationModule::evaluateSolution(const string &tmp_file_name, const strin
 		// Apply ICP
 		try
 		{
-			Tresult = icp(readCloud, refCloud, Tinit);
+			Tresult = icp.compute(readCloud, *refCloud, Tinit);
 		}
 		catch (PM::ConvergenceError error)
 		{
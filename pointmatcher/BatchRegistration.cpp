@@ -0,0 +1,209 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "BatchRegistration.h"
+#include "Functions.h"
+#include "Timer.h"
+
+#include <map>
+#include <mutex>
+
+using namespace std;
+using namespace PointMatcherSupport;
+
+//! Construct a pair to register
+template<typename T>
+BatchRegistration<T>::Pair::Pair(const std::shared_ptr<const DataPoints>& reading, const std::shared_ptr<const DataPoints>& reference, const TransformationParameters& initialTransformation):
+	reading(reading),
+	reference(reference),
+	initialTransformation(initialTransformation)
+{}
+
+//! Construct an empty outcome
+template<typename T>
+BatchRegistration<T>::Outcome::Outcome():
+	duration(0)
+{}
+
+//! Construct a batch registering with icp on nbThreads threads
+template<typename T>
+BatchRegistration<T>::BatchRegistration(const ICP& icp, const unsigned nbThreads):
+	icp(icp),
+	nbThreads(nbThreads)
+{}
+
+//! Pairs in memory, sharing the preparation of references by address
+template<typename T>
+struct PairsSource
+{
+	typedef typename BatchRegistration<T>::Pairs Pairs;
+	typedef typename BatchRegistration<T>::DataPoints DataPoints;
+	typedef typename BatchRegistration<T>::TransformationParameters TransformationParameters;
+	typedef const DataPoints* Key;
+	
+	const Pairs& pairs;
+	
+	PairsSource(const Pairs& pairs): pairs(pairs) {}
+	size_t size() const { return pairs.size(); }
+	Key referenceKey(const size_t i) const { return pairs[i].reference.get(); }
+	std::shared_ptr<const DataPoints> loadReading(const size_t i) const { return pairs[i].reading; }
+	std::shared_ptr<const DataPoints> loadReference(const size_t i) const { return pairs[i].reference; }
+	const TransformationParameters& initialTransformation(const size_t i) const { return pairs[i].initialTransformation; }
+};
+
+//! Pairs of files, sharing the preparation of references by file name
+template<typename T>
+struct FilesSource
+{
+	typedef typename BatchRegistration<T>::FileInfoVector FileInfoVector;
+	typedef typename BatchRegistration<T>::DataPoints DataPoints;
+	typedef typename BatchRegistration<T>::TransformationParameters TransformationParameters;
+	typedef std::string Key;
+	
+	const FileInfoVector& files;
+	
+	FilesSource(const FileInfoVector& files): files(files) {}
+	size_t size() const { return files.size(); }
+	const Key& referenceKey(const size_t i) const { return files[i].referenceFileName; }
+	std::shared_ptr<const DataPoints> loadReading(const size_t i) const { return std::make_shared<const DataPoints>(DataPoints::load(files[i].readingFileName)); }
+	std::shared_ptr<const DataPoints> loadReference(const size_t i) const { return std::make_shared<const DataPoints>(DataPoints::load(files[i].referenceFileName)); }
+	const TransformationParameters& initialTransformation(const size_t i) const { return files[i].initialTransformation; }
+};
+
+//! Register all pairs of source, preparing every reference once and releasing it after its last pair
+template<typename T, typename Source>
+static typename BatchRegistration<T>::Outcomes computeAll(const BatchRegistration<T>& batch, const Source& source)
+{
+	typedef typename BatchRegistration<T>::ICP::PreparedReference PreparedReference;
+	typedef typename BatchRegistration<T>::DataPoints DataPoints;
+	typedef typename BatchRegistration<T>::TransformationParameters TransformationParameters;
+	typedef std::shared_ptr<const PreparedReference> PreparedReferencePtr;
+	
+	//! A reference, ready once its first pair has prepared it
+	struct SharedReference
+	{
+		std::shared_future<PreparedReferencePtr> prepared; //!< prepared reference, invalid until the first pair starts
+		size_t remainingPairs; //!< number of pairs not yet registered against it
+		
+		SharedReference(): remainingPairs(0) {}
+	};
+	
+	const size_t count(source.size());
+	typename BatchRegistration<T>::Outcomes outcomes(count);
+	
+	std::mutex referencesMutex;
+	std::map<typename Source::Key, SharedReference> references;
+	for (size_t i = 0; i < count; ++i)
+		++references[source.referenceKey(i)].remainingPairs;
+	
+	parallelForEach(count, batch.nbThreads, [&](const size_t i, unsigned)
+	{
+		typename BatchRegistration<T>::Outcome& outcome(outcomes[i]);
+		
+		// the first pair of a reference prepares it, the others wait for it
+		std::promise<PreparedReferencePtr> preparation;
+		std::shared_future<PreparedReferencePtr> prepared;
+		bool mustPrepare(false);
+		{
+			std::lock_guard<std::mutex> lock(referencesMutex);
+			SharedReference& reference(references[source.referenceKey(i)]);
+			if (!reference.prepared.valid())
+			{
+				reference.prepared = preparation.get_future().share();
+				mustPrepare = true;
+			}
+			prepared = reference.prepared;
+		}
+		
+		try
+		{
+			if (mustPrepare)
+			{
+				try
+				{
+					preparation.set_value(batch.icp.prepareReferenceConcurrently(*source.loadReference(i)));
+				}
+				catch (...)
+				{
+					preparation.set_exception(std::current_exception());
+				}
+			}
+			
+			const std::shared_ptr<const DataPoints> reading(source.loadReading(i));
+			TransformationParameters initialTransformation(source.initialTransformation(i));
+			if (initialTransformation.rows() == 0)
+				initialTransformation = TransformationParameters::Identity(reading->features.rows(), reading->features.rows());
+			const PreparedReferencePtr reference(prepared.get());
+			
+			timer t;
+			outcome.result = batch.icp.computeConcurrently(*reading, *reference, initialTransformation);
+			outcome.duration = t.elapsed();
+		}
+		catch (const std::exception& e)
+		{
+			outcome.error = e.what();
+		}
+		
+		std::lock_guard<std::mutex> lock(referencesMutex);
+		typename std::map<typename Source::Key, SharedReference>::iterator it(references.find(source.referenceKey(i)));
+		if (--it->second.remainingPairs == 0)
+			references.erase(it);
+	});
+	
+	return outcomes;
+}
+
+//! Register the readings of pairs against their references and return the outcomes in the order of pairs
+template<typename T>
+typename BatchRegistration<T>::Outcomes BatchRegistration<T>::compute(const Pairs& pairs) const
+{
+	return computeAll(*this, PairsSource<T>(pairs));
+}
+
+//! Load and register the readings of files against their references and return the outcomes in the order of files
+/*!
+	The configuration file names of files are ignored, all pairs are
+	registered with icp. The reference files are loaded once for all pairs
+	sharing the same file name.
+*/
+template<typename T>
+typename BatchRegistration<T>::Outcomes BatchRegistration<T>::compute(const FileInfoVector& files) const
+{
+	return computeAll(*this, FilesSource<T>(files));
+}
+
+template struct BatchRegistration<float>;
+template struct BatchRegistration<double>;
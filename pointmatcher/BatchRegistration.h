@@ -0,0 +1,94 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#ifndef __POINTMATCHER_BATCHREGISTRATION_H
+#define __POINTMATCHER_BATCHREGISTRATION_H
+
+#include "PointMatcher.h"
+#include "IO.h"
+
+//! Registration of many reading/reference pairs with the same ICP chain, on several threads
+/*!
+	The pairs are distributed to the threads one at a time, in input order,
+	so that a thread that is done with a pair takes the next one; loading,
+	filtering and registration of different pairs thus overlap. Each
+	reference is filtered, centered and indexed once, by the first thread that
+	needs it, and the pairs sharing it are registered against the same
+	prepared reference with ICP::computeConcurrently(). The matcher of the
+	chain must therefore allow concurrent queries.
+*/
+template<typename T>
+struct BatchRegistration
+{
+	typedef PointMatcher<T> PM; //!< alias
+	typedef typename PM::DataPoints DataPoints; //!< alias
+	typedef typename PM::TransformationParameters TransformationParameters; //!< alias
+	typedef typename PM::ICP ICP; //!< alias
+	typedef typename PointMatcherIO<T>::FileInfoVector FileInfoVector; //!< alias
+	
+	//! A reading to register against a reference, both in memory
+	struct Pair
+	{
+		std::shared_ptr<const DataPoints> reading; //!< reading point cloud
+		std::shared_ptr<const DataPoints> reference; //!< reference point cloud, prepared once for all the pairs pointing to it
+		TransformationParameters initialTransformation; //!< initial estimate of the transformation, identity if empty
+		
+		Pair(const std::shared_ptr<const DataPoints>& reading, const std::shared_ptr<const DataPoints>& reference, const TransformationParameters& initialTransformation = TransformationParameters());
+	};
+	typedef std::vector<Pair> Pairs; //!< a vector of Pair
+	
+	//! Outcome of the registration of one pair
+	struct Outcome
+	{
+		typename ICP::Result result; //!< result of the registration, valid if error is empty
+		std::string error; //!< message of the exception that stopped the loading, preparation or registration, empty on success
+		double duration; //!< time taken by the registration in seconds, excluding the loading and the preparation of the reference
+		
+		Outcome();
+		bool succeeded() const { return error.empty(); } //!< return whether result is valid
+	};
+	typedef std::vector<Outcome> Outcomes; //!< a vector of Outcome, in the order of the input pairs
+	
+	const ICP& icp; //!< chain used for all registrations, not modified
+	const unsigned nbThreads; //!< number of threads, 0 meaning as many as hardware threads
+	
+	BatchRegistration(const ICP& icp, const unsigned nbThreads = 0);
+	
+	Outcomes compute(const Pairs& pairs) const;
+	Outcomes compute(const FileInfoVector& files) const;
+};
+
+#endif // __POINTMATCHER_BATCHREGISTRATION_H
@@ -0,0 +1,139 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#ifndef __POINTMATCHER_DATAPOINTS3D_H
+#define __POINTMATCHER_DATAPOINTS3D_H
+
+#include "PointMatcher.h"
+
+#include <cassert>
+#include <type_traits>
+
+//! Fixed-size access to the points and directions of 3D clouds, for the modules that have a fast path when the features have 4 rows
+/*!
+	DataPoints keeps its features and descriptors in dynamic-size matrices,
+	so that the columns taken from them go through dynamic-size code and
+	often through temporaries. The views below map the 3 rows of a column to
+	a fixed-size vector, in place, so that per-point arithmetic is done with
+	fixed-size 3-vectors and 3x3 matrices. They do not copy the cloud and stay
+	valid as long as its matrices are not resized.
+*/
+template<typename T>
+struct DataPoints3D
+{
+	typedef typename PointMatcher<T>::DataPoints DataPoints; //!< alias
+	typedef Eigen::Matrix<T, 3, 1> Vector3; //!< a 3D point or direction
+	typedef Eigen::Matrix<T, 3, 3> Matrix3; //!< a 3D covariance or rotation
+	
+	//! Columns of 3 rows taken from a column-major matrix, Scalar being const T for a read-only view
+	template<typename Scalar>
+	struct Columns
+	{
+		//! Fixed-size vector mapped on a column
+		typedef Eigen::Map<typename std::conditional<std::is_const<Scalar>::value, const Vector3, Vector3>::type> VectorMap;
+		
+		Scalar* data; //!< first coefficient of the first column
+		Eigen::Index stride; //!< distance between the first coefficients of two consecutive columns
+		Eigen::Index count; //!< number of columns
+		
+		Columns(Scalar* data, const Eigen::Index stride, const Eigen::Index count):
+			data(data),
+			stride(stride),
+			count(count)
+		{}
+		
+		//! Construct a view on the same columns as a writable view
+		Columns(const Columns<T>& that):
+			data(that.data),
+			stride(that.stride),
+			count(that.count)
+		{}
+		
+		//! Return column i
+		VectorMap operator[](const Eigen::Index i) const
+		{
+			assert(i >= 0 && i < count);
+			return VectorMap(data + i * stride);
+		}
+		
+		//! Return the number of columns
+		Eigen::Index size() const { return count; }
+	};
+	typedef Columns<const T> ConstColumns; //!< read-only view
+	typedef Columns<T> MutableColumns; //!< writable view
+	
+	//! Return whether cloud is a homogeneous 3D cloud, as required by points()
+	static bool isApplicable(const DataPoints& cloud)
+	{
+		return cloud.features.rows() == 4;
+	}
+	
+	//! Return whether cloud has a descriptor name of 3 rows, as required by descriptor()
+	static bool hasDescriptor3D(const DataPoints& cloud, const std::string& name)
+	{
+		return cloud.descriptorExists(name, 3);
+	}
+	
+	//! Return the Euclidean coordinates of the points of cloud
+	static ConstColumns points(const DataPoints& cloud)
+	{
+		assert(isApplicable(cloud));
+		return ConstColumns(cloud.features.data(), cloud.features.rows(), cloud.features.cols());
+	}
+	
+	//! Return the Euclidean coordinates of the points of cloud
+	static MutableColumns points(DataPoints& cloud)
+	{
+		assert(isApplicable(cloud));
+		return MutableColumns(cloud.features.data(), cloud.features.rows(), cloud.features.cols());
+	}
+	
+	//! Return the 3-row descriptor name of cloud, for instance its normals
+	static ConstColumns descriptor(const DataPoints& cloud, const std::string& name)
+	{
+		assert(hasDescriptor3D(cloud, name));
+		return ConstColumns(cloud.descriptors.data() + cloud.getDescriptorStartingRow(name), cloud.descriptors.rows(), cloud.descriptors.cols());
+	}
+	
+	//! Return the 3-row descriptor name of cloud, for instance its normals
+	static MutableColumns descriptor(DataPoints& cloud, const std::string& name)
+	{
+		assert(hasDescriptor3D(cloud, name));
+		return MutableColumns(cloud.descriptors.data() + cloud.getDescriptorStartingRow(name), cloud.descriptors.rows(), cloud.descriptors.cols());
+	}
+};
+
+#endif // __POINTMATCHER_DATAPOINTS3D_H
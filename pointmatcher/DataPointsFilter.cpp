@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "StageTimer.h"
 
 #ifdef SYSTEM_YAML_CPP
     #include "yaml-cpp/yaml.h"
@@ -64,18 +65,73 @@ template<typename T>
 void PointMatcher<T>::DataPointsFilter::init()
 {}
 
+//! By default, filters depend on the whole cloud
+template<typename T>
+bool PointMatcher<T>::DataPointsFilter::isChunkSafe() const
+{
+	return false;
+}
+
+//! By default, filters might modify the points
+template<typename T>
+bool PointMatcher<T>::DataPointsFilter::isPredicate() const
+{
+	return false;
+}
+
+//! Only implemented by predicate filters
+template<typename T>
+void PointMatcher<T>::DataPointsFilter::updateKeepMask(const DataPoints& cloud, KeepMask& keep)
+{
+	throw std::runtime_error(className + " is not a predicate filter, it cannot be applied on a keep mask");
+}
+
+//! Move the points whose flag is set to the beginning of cloud, and resize it
+template<typename T>
+void PointMatcher<T>::DataPointsFilter::compact(DataPoints& cloud, const KeepMask& keep)
+{
+	assert(keep.size() == cloud.features.cols());
+	const int nbPointsIn(cloud.features.cols());
+
+	// skip the leading points that are kept, they do not move
+	int j = 0;
+	while (j < nbPointsIn && keep(j))
+		++j;
+	for (int i = j + 1; i < nbPointsIn; ++i)
+	{
+		if (keep(i))
+		{
+			cloud.setColFrom(j, cloud, i);
+			++j;
+		}
+	}
+
+	cloud.conservativeResize(j);
+}
+
+//! Flag the points to keep with updateKeepMask(), then compact the cloud
+template<typename T>
+void PointMatcher<T>::DataPointsFilter::filterWithKeepMask(DataPoints& cloud)
+{
+	KeepMask keep(KeepMask::Constant(cloud.features.cols(), true));
+	updateKeepMask(cloud, keep);
+	compact(cloud, keep);
+}
+
 template struct PointMatcher<float>::DataPointsFilter;
 template struct PointMatcher<double>::DataPointsFilter;
 
 
 //! Construct an empty chain
 template<typename T>
-PointMatcher<T>::DataPointsFilters::DataPointsFilters()
+PointMatcher<T>::DataPointsFilters::DataPointsFilters():
+	fusePredicates(false)
 {}
 
 //! Construct a chain from a YAML file
 template<typename T>
-PointMatcher<T>::DataPointsFilters::DataPointsFilters(std::istream& in)
+PointMatcher<T>::DataPointsFilters::DataPointsFilters(std::istream& in):
+	fusePredicates(false)
 {
 	YAML::Parser parser(in);
 	YAML::Node doc;
@@ -112,19 +168,43 @@ void PointMatcher<T>::DataPointsFilters::apply(DataPoints& cloud)
 	cloud.assertDescriptorConsistency();
 	const int nbPointsBeforeFilters(cloud.features.cols());
 	LOG_INFO_STREAM("Applying " << this->size() << " DataPoints filters - " << nbPointsBeforeFilters << " points in");
+
+	// flags of the points kept by the current run of predicate filters, empty if the cloud is compacted
+	typename DataPointsFilter::KeepMask keep;
+	int nbPointsIn(nbPointsBeforeFilters);
 	for (DataPointsFiltersIt it = this->begin(); it != this->end(); ++it)
 	{
-		const int nbPointsIn(cloud.features.cols());
 		if (nbPointsIn == 0) {
 			throw ConvergenceError("no points to filter");
 		}
 
-		(*it)->inPlaceFilter(cloud);
-		cloud.assertDescriptorConsistency();
+		int nbPointsOut;
+		const StageTimer<T> timer("DataPointsFilter", (*it)->className, nbPointsIn);
+		if (fusePredicates && (*it)->isPredicate())
+		{
+			if (keep.size() == 0)
+				keep.setConstant(cloud.features.cols(), true);
+			(*it)->updateKeepMask(cloud, keep);
+			nbPointsOut = keep.count();
+		}
+		else
+		{
+			if (keep.size() != 0)
+			{
+				DataPointsFilter::compact(cloud, keep);
+				keep.resize(0);
+			}
+			(*it)->inPlaceFilter(cloud);
+			cloud.assertDescriptorConsistency();
+			nbPointsOut = cloud.features.cols();
+		}
 
-		const int nbPointsOut(cloud.features.cols());
 		LOG_INFO_STREAM("* " << (*it)->className << " - " << nbPointsOut << " points out (-" << (100 - double(nbPointsOut*100.)/nbPointsIn) << "%)");
+		nbPointsIn = nbPointsOut;
 	}
+
+	if (keep.size() != 0)
+		DataPointsFilter::compact(cloud, keep);
 	
 	const int nbPointsAfterFilters(cloud.features.cols());
 	LOG_INFO_STREAM("Applied " << this->size() << " filters - " << nbPointsAfterFilters << " points out (-" << (100 - double(nbPointsAfterFilters*100.)/nbPointsBeforeFilters) << "%)");
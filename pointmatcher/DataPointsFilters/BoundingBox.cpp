@@ -64,13 +64,23 @@ typename PointMatcher<T>::DataPoints BoundingBoxDataPointsFilter<T>::filter(
 template<typename T>
 void BoundingBoxDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void BoundingBoxDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	const int nbPointsIn = cloud.features.cols();
 	const int nbRows = cloud.features.rows();
 
-	int j = 0;
 	for (int i = 0; i < nbPointsIn; ++i)
 	{
+		if (!keep(i))
+			continue;
+
 		bool keepPt = false;
 		const Vector point = cloud.features.col(i);
 
@@ -85,14 +95,8 @@ void BoundingBoxDataPointsFilter<T>::inPlaceFilter(
 		else
 			keepPt = in_box;
 
-		if(keepPt)
-		{
-			cloud.setColFrom(j, cloud, i);
-			++j;
-		}
+		keep(i) = keepPt;
 	}
-
-	cloud.conservativeResize(j);
 }
 
 template struct BoundingBoxDataPointsFilter<float>;
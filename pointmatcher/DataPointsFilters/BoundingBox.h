@@ -49,6 +49,7 @@ struct BoundingBoxDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	
 	typedef typename PointMatcher<T>::Vector Vector;
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	
 	inline static const std::string description()
 	{
@@ -79,4 +80,7 @@ struct BoundingBoxDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	BoundingBoxDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isChunkSafe() const { return true; }
+	virtual bool isPredicate() const { return true; }
+	virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
@@ -61,6 +61,14 @@ CutAtDescriptorThresholdDataPointsFilter<T>::filter(const DataPoints& input)
 template<typename T>
 void CutAtDescriptorThresholdDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void CutAtDescriptorThresholdDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	// Check field exists
 	if (!cloud.descriptorExists(descName))
@@ -69,35 +77,24 @@ void CutAtDescriptorThresholdDataPointsFilter<T>::inPlaceFilter(
 	}
 
 	const int nbPointsIn = cloud.features.cols();
-	typename DataPoints::View values = cloud.getDescriptorViewByName(descName);
+	const typename DataPoints::ConstView values = cloud.getDescriptorViewByName(descName);
 
-	// fill cloud values
-	int j = 0;
 	if (useLargerThan)
 	{
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			const T value(values(0,i));
-			if (value <= threshold)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = values(0,i) <= threshold;
 		}
 	}
 	else
 	{
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			const T value(values(0,i));
-			if (value >= threshold)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = values(0,i) >= threshold;
 		}
 	}
-	cloud.conservativeResize(j);
 }
 
 template struct CutAtDescriptorThresholdDataPointsFilter<float>;
@@ -50,6 +50,7 @@ struct CutAtDescriptorThresholdDataPointsFilter: public PointMatcher<T>::DataPoi
 	typedef Parametrizable::InvalidParameter InvalidParameter;
 	
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	typedef typename PointMatcher<T>::DataPoints::InvalidField InvalidField;
 	
   inline static const std::string description()
@@ -73,4 +74,7 @@ struct CutAtDescriptorThresholdDataPointsFilter: public PointMatcher<T>::DataPoi
   CutAtDescriptorThresholdDataPointsFilter(const Parameters& params = Parameters());
   virtual DataPoints filter(const DataPoints& input);
   virtual void inPlaceFilter(DataPoints& cloud);
+  virtual bool isChunkSafe() const { return true; }
+  virtual bool isPredicate() const { return true; }
+  virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
@@ -60,6 +60,14 @@ typename PointMatcher<T>::DataPoints DistanceLimitDataPointsFilter<T>::filter(
 template<typename T>
 void DistanceLimitDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void DistanceLimitDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	using namespace PointMatcherSupport;
 
@@ -72,54 +80,31 @@ void DistanceLimitDataPointsFilter<T>::inPlaceFilter(
 	const int nbPointsIn = cloud.features.cols();
 	const int nbRows = cloud.features.rows();
 
-	int j = 0;
 	if(dim == -1) // Euclidean distance
 	{
 		const T absMaxDist = anyabs(dist);
 		for(int i = 0; i < nbPointsIn; ++i)
 		{
+			if(!keep(i))
+				continue;
 			if(removeInside)
-			{
-				if(cloud.features.col(i).head(nbRows-1).norm() > absMaxDist)
-				{
-					cloud.setColFrom(j, cloud, i);
-					++j;
-				}
-			}
+				keep(i) = cloud.features.col(i).head(nbRows-1).norm() > absMaxDist;
 			else
-			{
-				if(cloud.features.col(i).head(nbRows-1).norm() < absMaxDist)
-				{
-					cloud.setColFrom(j, cloud, i);
-					++j;
-				}
-			}
+				keep(i) = cloud.features.col(i).head(nbRows-1).norm() < absMaxDist;
 		}
 	}
 	else // Single-axis distance
 	{
 		for(int i = 0; i < nbPointsIn; ++i)
 		{
+			if(!keep(i))
+				continue;
 			if(removeInside)
-			{
-				if((cloud.features(dim, i)) > dist)
-				{
-					cloud.setColFrom(j, cloud, i);
-					++j;
-				}
-			}
+				keep(i) = (cloud.features(dim, i)) > dist;
 			else
-			{
-				if((cloud.features(dim, i)) < dist)
-				{
-					cloud.setColFrom(j, cloud, i);
-					++j;
-				}
-			}
+				keep(i) = (cloud.features(dim, i)) < dist;
 		}
 	}
-
-	cloud.conservativeResize(j);
 }
 
 template struct DistanceLimitDataPointsFilter<float>;
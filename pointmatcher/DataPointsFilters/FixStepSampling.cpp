@@ -71,20 +71,26 @@ FixStepSamplingDataPointsFilter<T>::filter(const DataPoints& input)
 // In-place filter
 template<typename T>
 void FixStepSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove, counting only the points still kept
+template<typename T>
+void FixStepSamplingDataPointsFilter<T>::updateKeepMask(const DataPoints& cloud, KeepMask& keep)
 {
 	const int iStep(step);
-	const int nbPointsIn = cloud.features.cols();
 	const int phase(rand() % iStep);
 
-	int j = 0;
-	for (int i = phase; i < nbPointsIn; i += iStep)
+	int k = 0;
+	for (int i = 0; i < keep.size(); ++i)
 	{
-		cloud.setColFrom(j, cloud, i);
-		++j;
+		if (!keep(i))
+			continue;
+		keep(i) = k >= phase && (k - phase) % iStep == 0;
+		++k;
 	}
 
-	cloud.conservativeResize(j);
-
 	const double deltaStep(startStep * stepMult - startStep);
 	step *= stepMult;
 	if (deltaStep < 0 && step < endStep)
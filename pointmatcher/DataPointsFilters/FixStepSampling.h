@@ -48,6 +48,7 @@ struct FixStepSamplingDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	typedef Parametrizable::InvalidParameter InvalidParameter;
 	
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	
 	inline static const std::string description()
 	{
@@ -76,4 +77,6 @@ public:
 	virtual void init();
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isPredicate() const { return true; }
+	virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
@@ -53,4 +53,5 @@ struct IdentityDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isChunkSafe() const { return true; }
 };
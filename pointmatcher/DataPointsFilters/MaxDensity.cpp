@@ -59,7 +59,15 @@ template<typename T>
 void MaxDensityDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
 {
-	typedef typename DataPoints::View View;
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove, the saturation being computed on the points still kept
+template<typename T>
+void MaxDensityDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
+{
+	typedef typename DataPoints::ConstView ConstView;
 
 	// Force densities to be computed
 	if (!cloud.descriptorExists("densities"))
@@ -67,15 +75,18 @@ void MaxDensityDataPointsFilter<T>::inPlaceFilter(
 		throw InvalidField("MaxDensityDataPointsFilter: Error, no densities found in descriptors.");
 	}
 
-	const int nbPointsIn = cloud.features.cols();
-	View densities = cloud.getDescriptorViewByName("densities");
-	const T lastDensity = densities.maxCoeff();
-	const int nbSaturatedPts = (densities.array() == lastDensity).count();
+	const int nbPointsIn = keep.count();
+	const ConstView densities = cloud.getDescriptorViewByName("densities");
+	T lastDensity = -std::numeric_limits<T>::infinity();
+	for (int i = 0; i < keep.size(); ++i)
+		if (keep(i))
+			lastDensity = std::max(lastDensity, densities(0,i));
+	const int nbSaturatedPts = (keep && densities.row(0).transpose().array() == lastDensity).count();
 
-	// fill cloud values
-	int j = 0;
-	for (int i = 0; i < nbPointsIn; ++i)
+	for (int i = 0; i < keep.size(); ++i)
 	{
+		if (!keep(i))
+			continue;
 		const T density(densities(0,i));
 		if (density > maxDensity)
 		{
@@ -88,20 +99,9 @@ void MaxDensityDataPointsFilter<T>::inPlaceFilter(
 				acceptRatio = acceptRatio * (1-nbSaturatedPts/nbPointsIn);
 			}
 
-			if (r < acceptRatio)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
-		}
-		else
-		{
-			cloud.setColFrom(j, cloud, i);
-			++j;
+			keep(i) = r < acceptRatio;
 		}
 	}
-
-	cloud.conservativeResize(j);
 }
 
 template struct MaxDensityDataPointsFilter<float>;
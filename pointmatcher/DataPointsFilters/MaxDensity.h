@@ -48,6 +48,7 @@ struct MaxDensityDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	typedef Parametrizable::InvalidParameter InvalidParameter;
 	
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	typedef typename PointMatcher<T>::DataPoints::InvalidField InvalidField;
 	
 	inline static const std::string description()
@@ -67,5 +68,7 @@ struct MaxDensityDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	MaxDensityDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isPredicate() const { return true; }
+	virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
 
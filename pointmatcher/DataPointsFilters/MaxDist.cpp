@@ -61,6 +61,14 @@ typename PointMatcher<T>::DataPoints MaxDistDataPointsFilter<T>::filter(
 template<typename T>
 void MaxDistDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void MaxDistDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	using namespace PointMatcherSupport;
 	
@@ -73,32 +81,23 @@ void MaxDistDataPointsFilter<T>::inPlaceFilter(
 	const int nbPointsIn = cloud.features.cols();
 	const int nbRows = cloud.features.rows();
 
-	int j = 0;
 	if(dim == -1) // Euclidean distance
 	{
 		const T absMaxDist = anyabs(maxDist);
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			if (cloud.features.col(i).head(nbRows-1).norm() < absMaxDist)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = cloud.features.col(i).head(nbRows-1).norm() < absMaxDist;
 		}
 	}
 	else // Single-axis distance
 	{
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			if ((cloud.features(dim, i)) < maxDist)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = (cloud.features(dim, i)) < maxDist;
 		}
 	}
-
-	cloud.conservativeResize(j);
 }
 
 template struct MaxDistDataPointsFilter<float>;
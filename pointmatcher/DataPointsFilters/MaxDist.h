@@ -48,6 +48,7 @@ struct MaxDistDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	typedef Parametrizable::InvalidParameter InvalidParameter;
 	
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	
 	inline static const std::string description()
 	{
@@ -68,4 +69,7 @@ struct MaxDistDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	MaxDistDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isChunkSafe() const { return true; }
+	virtual bool isPredicate() const { return true; }
+	virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
@@ -64,68 +64,50 @@ MaxQuantileOnAxisDataPointsFilter<T>::filter(
 // In-place filter
 template<typename T>
 void MaxQuantileOnAxisDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove, the quantile being computed on the points still kept
+template<typename T>
+void MaxQuantileOnAxisDataPointsFilter<T>::updateKeepMask(const DataPoints& cloud, KeepMask& keep)
 {
 	if (int(dim) >= cloud.features.rows())
 		throw InvalidParameter((boost::format("MaxQuantileOnAxisDataPointsFilter: Error, filtering on dimension number %1%, larger than feature dimensionality %2%") % dim % cloud.features.rows()).str());
 
-	const int nbPointsIn = cloud.features.cols();
-	
-	if (removeBeyond) {
-		const int nbPointsOut = nbPointsIn * ratio;
+	const int nbPointsIn = keep.count();
 
-		// build array
-		std::vector<T> values;
-		values.reserve(nbPointsIn);
-		for (int x = 0; x < nbPointsIn; ++x)
+	// build array
+	std::vector<T> values;
+	values.reserve(nbPointsIn);
+	for (int x = 0; x < keep.size(); ++x)
+		if (keep(x))
 			values.push_back(cloud.features(dim, x));
 
-		// get quartiles value
-		std::nth_element(values.begin(), values.begin() + (values.size() * ratio), values.end());
+	// get quartiles value
+	std::nth_element(values.begin(), values.begin() + (values.size() * ratio), values.end());
+
+	if (removeBeyond) {
+		const int nbPointsOut = nbPointsIn * ratio;
 		const T limit = values[nbPointsOut];
 
-		// copy towards beginning the elements we keep
-		int j = 0;
-		for (int i = 0; i < nbPointsIn; ++i)
+		// flag the elements we keep
+		for (int i = 0; i < keep.size(); ++i)
 		{
-			if (cloud.features(dim, i) < limit)
-			{
-				assert(j <= i);
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = cloud.features(dim, i) < limit;
 		}
-		assert(j <= nbPointsOut);
-
-		cloud.conservativeResize(j);
 	}
 	else {
 		const int nbPointsOut = nbPointsIn * (1 - ratio);
-
-		// build array
-		std::vector<T> values;
-		values.reserve(nbPointsIn);
-		for (int x = 0; x < nbPointsIn; ++x)
-			values.push_back(cloud.features(dim, x));
-
-		// get quartiles value
-		std::nth_element(values.begin(), values.begin() + (values.size() * ratio), values.end());
-
 		const T limit = values[nbPointsIn-nbPointsOut];
 
-		// copy towards beginning the elements we keep
-		int j = 0;
-		for (int i = 0; i < nbPointsIn; ++i)
+		// flag the elements we keep
+		for (int i = 0; i < keep.size(); ++i)
 		{
-			if (cloud.features(dim, i) > limit)
-			{
-				assert(j <= i);
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = cloud.features(dim, i) > limit;
 		}
-		assert(j <= nbPointsOut);
-
-		cloud.conservativeResize(j);
 	}
 }
 
@@ -61,6 +61,14 @@ typename PointMatcher<T>::DataPoints MinDistDataPointsFilter<T>::filter(
 template<typename T>
 void MinDistDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void MinDistDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	using namespace PointMatcherSupport;
 	
@@ -70,33 +78,23 @@ void MinDistDataPointsFilter<T>::inPlaceFilter(
 	const int nbPointsIn = cloud.features.cols();
 	const int nbRows = cloud.features.rows();
 
-	int j = 0;
 	if(dim == -1) // Euclidean distance
 	{
 		const T absMinDist = anyabs(minDist);
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			if (cloud.features.col(i).head(nbRows-1).norm() > absMinDist)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = cloud.features.col(i).head(nbRows-1).norm() > absMinDist;
 		}
 	}
 	else // Single axis distance
 	{
 		for (int i = 0; i < nbPointsIn; ++i)
 		{
-			if ((cloud.features(dim, i)) > minDist)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
-			}
+			if (keep(i))
+				keep(i) = (cloud.features(dim, i)) > minDist;
 		}
 	}
-
-	cloud.conservativeResize(j);
-
 }
 
 template struct MinDistDataPointsFilter<float>;
@@ -44,8 +44,8 @@ OctreeGridDataPointsFilter<T>::FirstPtsSampler::FirstPtsSampler(DataPoints& dp)
 }
 
 template <typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::FirstPtsSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::FirstPtsSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
@@ -95,8 +95,8 @@ OctreeGridDataPointsFilter<T>::RandomPtsSampler::RandomPtsSampler(
 	std::srand(seed);
 }
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
@@ -143,8 +143,8 @@ OctreeGridDataPointsFilter<T>::CentroidSampler::CentroidSampler(DataPoints& dp)
 }
 	
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::CentroidSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::CentroidSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
@@ -215,20 +215,23 @@ OctreeGridDataPointsFilter<T>::MedoidSampler::MedoidSampler(DataPoints& dp)
 }
 	
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::MedoidSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::MedoidSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{		
 		auto* data = oc.getData();
 		const std::size_t nbData = (*data).size();
 
-		auto dist = [](const typename Octree_<T,dim>::Point& p1, const typename Octree_<T,dim>::Point& p2) -> T {		
+		typedef typename Node::Point Point;
+		const std::size_t dim = Point::RowsAtCompileTime;
+		
+		auto dist = [](const Point& p1, const Point& p2) -> T {		
 				return (p1 - p2).norm();		
 			};
 			
 		//Build centroid
-		typename Octree_<T,dim>::Point center;
+		Point center;
 		for(std::size_t i=0;i<dim;++i) center(i)=T(0.);
 		
 		for(std::size_t id=0;id<nbData;++id)
@@ -288,7 +291,8 @@ OctreeGridDataPointsFilter<T>::OctreeGridDataPointsFilter(const Parameters& para
 		OctreeGridDataPointsFilter::availableParameters(), params),
 	buildParallel{Parametrizable::get<bool>("buildParallel")},
 	maxPointByNode{Parametrizable::get<std::size_t>("maxPointByNode")},
-	maxSizeByNode{Parametrizable::get<T>("maxSizeByNode")}
+	maxSizeByNode{Parametrizable::get<T>("maxSizeByNode")},
+	linear{Parametrizable::get<bool>("linear")}
 {
 	try 
 	{
@@ -328,10 +332,24 @@ template<typename T>
 template<std::size_t dim>
 void OctreeGridDataPointsFilter<T>::sample(DataPoints& cloud)
 {
-	Octree_<T,dim> oc;
-	
-	oc.build(cloud, maxPointByNode, maxSizeByNode, buildParallel);
-	
+	if(linear)
+	{
+		LinearOctree_<T,dim> oc;
+		oc.build(cloud, maxPointByNode, maxSizeByNode, buildParallel ? 0 : 1);
+		this->sampleOctree(cloud, oc);
+	}
+	else
+	{
+		Octree_<T,dim> oc;
+		oc.build(cloud, maxPointByNode, maxSizeByNode, buildParallel);
+		this->sampleOctree(cloud, oc);
+	}
+}
+
+template<typename T>
+template<typename Tree>
+void OctreeGridDataPointsFilter<T>::sampleOctree(DataPoints& cloud, Tree& oc)
+{
 	switch(samplingMethod)
 	{
 		case SamplingMethod::FIRST_PTS:
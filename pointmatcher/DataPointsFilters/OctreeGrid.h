@@ -36,6 +36,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "utils/octree.h"
+#include "utils/linearoctree.h"
 
 #include <unordered_map>
 
@@ -49,6 +50,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  * Processings are applyed via a Visitor through Depth-first search in the Octree (DFS)
  * i.e. for each node, the Visitor/Callback is called
+ *
+ * The octree is either Octree_, or LinearOctree_ which sorts the points by Morton code
+ * and is built in parallel at every level. Both have the same leaves, visited in the same order.
  */
 template<typename T>
 struct OctreeGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
@@ -80,7 +84,8 @@ struct OctreeGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 			{"buildParallel", "If 1 (true), use threads to build the octree.", "1", "0", "1", P::Comp<bool>},
 			{"maxPointByNode", "Number of point under which the octree stop dividing.", "1", "1", "4294967295", &P::Comp<std::size_t>},
 			{"maxSizeByNode", "Size of the bounding box under which the octree stop dividing.", "0", "0", "+inf", &P::Comp<T>},
-			{"samplingMethod", "Method to sample the Octree: First Point (0), Random (1), Centroid (2) (more accurate but costly), Medoid (3) (more accurate but costly)", "0", "0", "3", &P::Comp<int>}
+			{"samplingMethod", "Method to sample the Octree: First Point (0), Random (1), Centroid (2) (more accurate but costly), Medoid (3) (more accurate but costly)", "0", "0", "3", &P::Comp<int>},
+			{"linear", "If 1 (true), use a linear octree, with the points sorted by Morton code and the nodes in a single array. Faster to build on large clouds, its depth is limited to 21 levels in 3D and 32 in 2D.", "0", "0", "1", P::Comp<bool>}
 		//FIXME: add seed parameter for the random sampling
 		};
 	}
@@ -99,8 +104,8 @@ public:
 		FirstPtsSampler(DataPoints& dp);
 		virtual ~FirstPtsSampler(){}
 		
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 		
 		virtual bool finalize();
 	};
@@ -116,8 +121,8 @@ public:
 		RandomPtsSampler(DataPoints& dp, const std::size_t seed_);
 		virtual ~RandomPtsSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 		
 		virtual bool finalize();
 	};
@@ -131,8 +136,8 @@ public:
 	
 		virtual ~CentroidSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 	};
 	//Nearest point from the centroid (contained in the cloud)
 	struct MedoidSampler : public FirstPtsSampler
@@ -145,8 +150,8 @@ public:
 	
 		virtual ~MedoidSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);		
+		template<typename Node>
+		bool operator()(Node& oc);		
 	};
 
 //-------	
@@ -159,6 +164,8 @@ public:
 	T           maxSizeByNode;
 	
 	SamplingMethod samplingMethod;
+	
+	bool linear;
 
 //Methods	
 	//Constructor, uses parameter interface
@@ -173,4 +180,5 @@ public:
 
 private:
 	template<std::size_t dim> void sample(DataPoints& cloud);
+	template<typename Tree> void sampleOctree(DataPoints& cloud, Tree& oc);
 };
@@ -83,20 +83,29 @@ template<typename T>
 void RandomSamplingDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
 {
-	const size_t nbPointsIn = cloud.features.cols();
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove, drawing a random number for every point still kept
+template<typename T>
+void RandomSamplingDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
+{
+	const size_t nbPointsIn = keep.count();
 	const size_t nbPointsOut = nbPointsIn * prob;
 
 	const Eigen::VectorXf randomNumbers{sampleRandomIndices(nbPointsIn)};
 	size_t j{0u};
-	for (size_t i{0u}; i < nbPointsIn && j<=nbPointsOut; ++i)
+	size_t k{0u};
+	for (int i{0}; i < keep.size(); ++i)
 	{
-		if (randomNumbers(i) < prob)
-		{
-			cloud.setColFrom(j, cloud, i);
+		if (!keep(i))
+			continue;
+		keep(i) = j<=nbPointsOut && randomNumbers(k) < prob;
+		if (keep(i))
 			++j;
-		}
+		++k;
 	}
-	cloud.conservativeResize(j);
 }
 
 template struct RandomSamplingDataPointsFilter<float>;
@@ -48,22 +48,25 @@ typename PointMatcher<T>::DataPoints RemoveNaNDataPointsFilter<T>::filter(
 template<typename T>
 void RemoveNaNDataPointsFilter<T>::inPlaceFilter(
 	DataPoints& cloud)
+{
+	this->filterWithKeepMask(cloud);
+}
+
+// Flag the points to remove
+template<typename T>
+void RemoveNaNDataPointsFilter<T>::updateKeepMask(
+	const DataPoints& cloud, KeepMask& keep)
 {
 	const int nbPointsIn = cloud.features.cols();
 
-	int j = 0;
 	for (int i = 0; i < nbPointsIn; ++i)
 	{
+		if (!keep(i))
+			continue;
 		const BOOST_AUTO(colArray, cloud.features.col(i).array());
 		const BOOST_AUTO(hasNaN, !(colArray == colArray).all());
-		if (!hasNaN)
-		{
-			cloud.setColFrom(j, cloud, i);
-			++j;
-		}
+		keep(i) = !hasNaN;
 	}
-
-	cloud.conservativeResize(j);
 }
 
 template struct RemoveNaNDataPointsFilter<float>;
@@ -41,6 +41,7 @@ template<typename T>
 struct RemoveNaNDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 {
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
+	typedef typename PointMatcher<T>::DataPointsFilter::KeepMask KeepMask;
 	
 	inline static const std::string description()
 	{
@@ -52,4 +53,7 @@ struct RemoveNaNDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 																																	PointMatcherSupport::Parametrizable::Parameters()) {}
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isChunkSafe() const { return true; }
+	virtual bool isPredicate() const { return true; }
+	virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
 };
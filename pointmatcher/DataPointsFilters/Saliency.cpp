@@ -45,7 +45,8 @@ SaliencyDataPointsFilter<T>::SaliencyDataPointsFilter(const Parameters& params)
 	sigma{Parametrizable::get<T>("sigma")},
 	keepNormals{Parametrizable::get<bool>("keepNormals")},
 	keepLabels{Parametrizable::get<bool>("keepLabels")},
-	keepTensors{Parametrizable::get<bool>("keepTensors")}
+	keepTensors{Parametrizable::get<bool>("keepTensors")},
+	nbThreads{Parametrizable::get<unsigned>("nbThreads")}
 {
 }
 
@@ -63,7 +64,7 @@ void SaliencyDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 {
 	const std::size_t nbPts = cloud.getNbPoints();
 	
-	TensorVoting<T> tv{sigma, k};
+	TensorVoting<T> tv{sigma, k, nbThreads};
 	
 	//Refinement step
 	tv.refine(cloud);
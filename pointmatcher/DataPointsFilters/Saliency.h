@@ -70,7 +70,8 @@ struct SaliencyDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 			{"sigma", "Scale of the vote.", "0.2", "0.", "+inf", &P::Comp<T>},
 			{"keepNormals", "Flag to keep normals computed by TV.", "1", "0", "1", P::Comp<bool>},
 			{"keepLabels", "Flag to keep labels computed by TV.", "1", "0", "1", P::Comp<bool>},
-			{"keepTensors", "Flag to keep elements Tensors computed by TV.", "1", "0", "1", P::Comp<bool>}
+			{"keepTensors", "Flag to keep elements Tensors computed by TV.", "1", "0", "1", P::Comp<bool>},
+			{"nbThreads", "Number of threads used by TV, 0 uses all hardware threads", "1", "0", "65535", &P::Comp<unsigned>}
 		};
 	}
 
@@ -80,6 +81,7 @@ public:
 	const bool keepNormals;
 	const bool keepLabels;
 	const bool keepTensors;
+	const unsigned nbThreads;
 	
 	//Ctor, uses parameter interface
 	SaliencyDataPointsFilter(const Parameters& params = Parameters());
@@ -48,7 +48,8 @@ SpectralDecompositionDataPointsFilter<T>::SpectralDecompositionDataPointsFilter(
 	keepNormals{Parametrizable::get<bool>("keepNormals")},
 	keepLabels{Parametrizable::get<bool>("keepLabels")},
 	keepLambdas{Parametrizable::get<bool>("keepLambdas")},
-	keepTensors{Parametrizable::get<bool>("keepTensors")}
+	keepTensors{Parametrizable::get<bool>("keepTensors")},
+	nbThreads{Parametrizable::get<unsigned>("nbThreads")}
 {
 }
 
@@ -68,7 +69,7 @@ void SpectralDecompositionDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	
 	if(k > nbPts) return;
 	
-	TensorVoting<T> tv{sigma, k};
+	TensorVoting<T> tv{sigma, k, nbThreads};
 	
 //--- 1. Vote to determine prefered orientation + density estimation -----------
 	tv.encode(cloud, TensorVoting<T>::Encoding::BALL);
@@ -142,23 +143,25 @@ void SpectralDecompositionDataPointsFilter<T>::addDescriptor(DataPoints& pts, co
 	
 	if(keepLabels_ or keepLambdas_)
 	{
-	#pragma omp parallel for
-		for(std::size_t i = 0; i < nbPts; ++i)
+		PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 		{
-			const T lambda1 = tv.surfaceness(i) + tv.curveness(i) + tv.pointness(i);
-			const T lambda2 = tv.curveness(i) + tv.pointness(i);
-			const T lambda3 = tv.pointness(i);
+			for(std::size_t i = begin; i < end; ++i)
+			{
+				const T lambda1 = tv.surfaceness(i) + tv.curveness(i) + tv.pointness(i);
+				const T lambda2 = tv.curveness(i) + tv.pointness(i);
+				const T lambda3 = tv.pointness(i);
 	
-			int index;
-			Vector coeff = (Vector(3) << lambda3, (lambda2 - lambda3), (lambda1 - lambda2)).finished();
-			coeff.maxCoeff(&index);  
+				int index;
+				Vector coeff = (Vector(3) << lambda3, (lambda2 - lambda3), (lambda1 - lambda2)).finished();
+				coeff.maxCoeff(&index);  
 
-			labels(i) = index + 1 ;
+				labels(i) = index + 1 ;
 		
-			l1(i) = lambda1 * k;
-			l2(i) = lambda2 * k;
-			l3(i) = lambda3 * k;
-		}
+				l1(i) = lambda1 * k;
+				l2(i) = lambda2 * k;
+				l3(i) = lambda3 * k;
+			}
+		});
 	}
 	try
 	{	
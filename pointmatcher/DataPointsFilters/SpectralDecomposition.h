@@ -83,7 +83,8 @@ struct SpectralDecompositionDataPointsFilter : public PointMatcher<T>::DataPoint
 			{"keepNormals", "Flag to keep normals computed by TV.", "1", "0", "1", P::Comp<bool>},
 			{"keepLabels", "Flag to keep labels computed by TV.", "1", "0", "1", P::Comp<bool>},
 			{"keepLambdas", "Flag to keep lambdas computed by TV.", "1", "0", "1", P::Comp<bool>},
-			{"keepTensors", "Flag to keep elements Tensors computed by TV.", "1", "0", "1", P::Comp<bool>}
+			{"keepTensors", "Flag to keep elements Tensors computed by TV.", "1", "0", "1", P::Comp<bool>},
+			{"nbThreads", "Number of threads used by TV, 0 uses all hardware threads", "1", "0", "65535", &P::Comp<unsigned>}
 		};
 	}
 
@@ -96,6 +97,7 @@ public:
 	const bool keepLabels;
 	const bool keepLambdas;
 	const bool keepTensors;
+	const unsigned nbThreads;
 	
 	//Ctor, uses parameter interface
 	SpectralDecompositionDataPointsFilter(const Parameters& params = Parameters());
@@ -41,10 +41,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PointMatcherPrivate.h"
 #include "IO.h"
 #include "MatchersImpl.h"
+#include "DataPoints3D.h"
 
 #include <boost/format.hpp>
 
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
 #include "DataPointsFilters/utils/utils.h"
+#include "Functions.h"
 
 // SurfaceNormalDataPointsFilter
 // Constructor
@@ -62,7 +68,8 @@ SurfaceNormalDataPointsFilter<T>::SurfaceNormalDataPointsFilter(const Parameters
 	keepMatchedIds(Parametrizable::get<bool>("keepMatchedIds")),
 	keepMeanDist(Parametrizable::get<bool>("keepMeanDist")),
 	sortEigen(Parametrizable::get<bool>("sortEigen")),
-	smoothNormals(Parametrizable::get<bool>("smoothNormals"))
+	smoothNormals(Parametrizable::get<bool>("smoothNormals")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 }
 
@@ -154,6 +161,7 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 	boost::assign::insert(param) ( "knn", toParam(knn) );
 	boost::assign::insert(param) ( "epsilon", toParam(epsilon) );
 	boost::assign::insert(param) ( "maxDist", toParam(maxDist) );
+	boost::assign::insert(param) ( "nbThreads", toParam(nbThreads) );
 
 	KDTreeMatcher matcher(param);
 	matcher.init(cloud);
@@ -163,92 +171,222 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 
 	// Search for surrounding points and compute descriptors
 	int degenerateCount(0);
-	for (int i = 0; i < pointsCount; ++i)
+	if (featDim == 4)
 	{
-		bool isDegenerate = false;
-		// Mean of nearest neighbors (NN)
-		Matrix d(featDim-1, knn);
-		int realKnn = 0;
-
-		for(int j = 0; j < int(knn); ++j)
+		// 3D fast path: fixed-size types, no allocation per point
+		typedef typename DataPoints3D<T>::Vector3 Vector3;
+		typedef typename DataPoints3D<T>::Matrix3 Matrix3;
+		const typename DataPoints3D<T>::ConstColumns points(DataPoints3D<T>::points(cloud));
+
+		const bool needEigen(keepNormals || keepEigenValues || keepEigenVectors);
+		// The closed-form solver orders and signs the eigenvectors differently than the general one,
+		// which only matters when they are sorted anyway, and it is not precise enough in float
+		const bool useDirectSolver(sortEigen && std::is_same<T, double>::value);
+		std::vector<int> chunkDegenerateCounts(getThreadCount(nbThreads), 0);
+		parallelFor(pointsCount, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned chunk)
 		{
-			if (matches.dists(j,i) != Matches::InvalidDist)
+			Eigen::SelfAdjointEigenSolver<Matrix3> directSolver;
+			Eigen::EigenSolver<Matrix3> solver;
+			for (int i = int(begin); i < int(end); ++i)
 			{
-				const int refIndex(matches.ids(j,i));
-				d.col(realKnn) = cloud.features.block(0, refIndex, featDim-1, 1);
-				++realKnn;
-			}
-		}
-		d.conservativeResize(Eigen::NoChange, realKnn);
+				bool isDegenerate = false;
+				
+				// Mean of nearest neighbors (NN)
+				Vector3 mean(Vector3::Zero());
+				int realKnn = 0;
+				for(int j = 0; j < int(knn); ++j)
+				{
+					if (matches.dists(j,i) != Matches::InvalidDist)
+					{
+						mean += points[matches.ids(j,i)];
+						++realKnn;
+					}
+				}
+				mean /= T(realKnn);
 
-		const Vector mean = d.rowwise().sum() / T(realKnn);
-		const Matrix NN = d.colwise() - mean;
+				Matrix3 C(Matrix3::Zero());
+				T maxSquaredNorm(0);
+				for(int j = 0; j < int(knn); ++j)
+				{
+					if (matches.dists(j,i) != Matches::InvalidDist)
+					{
+						const Vector3 nn(points[matches.ids(j,i)] - mean);
+						C.noalias() += nn * nn.transpose();
+						maxSquaredNorm = std::max(maxSquaredNorm, nn.squaredNorm());
+					}
+				}
+
+				Vector3 eigenVa(Vector3::Zero());
+				Matrix3 eigenVe(Matrix3::Zero());
+				// Ensure that the matrix is suited for eigenvalues calculation
+				if(needEigen)
+				{
+					if(Eigen::FullPivHouseholderQR<Matrix3>(C).rank()+1 >= 3)
+					{
+						if(useDirectSolver)
+						{
+							// eigenvalues are returned in ascending order, so no sorting is needed
+							directSolver.computeDirect(C);
+							eigenVa = directSolver.eigenvalues();
+							eigenVe = directSolver.eigenvectors();
+						}
+						else
+						{
+							solver.compute(C);
+							eigenVa = solver.eigenvalues().real();
+							eigenVe = solver.eigenvectors().real();
+
+							if(sortEigen)
+							{
+								std::array<int, 3> idx = {{0, 1, 2}};
+								std::sort(idx.begin(), idx.end(), [&](const int a, const int b) { return eigenVa(a) < eigenVa(b); });
+								const Vector3 tmp_eigenVa(eigenVa);
+								const Matrix3 tmp_eigenVe(eigenVe);
+								for(int k = 0; k < 3; ++k)
+								{
+									eigenVa(k) = tmp_eigenVa(idx[k]);
+									eigenVe.col(k) = tmp_eigenVe.col(idx[k]);
+								}
+							}
+						}
+					}
+					else
+					{
+						++chunkDegenerateCounts[chunk];
+						isDegenerate = true;
+					}
+				}
 
-		const Matrix C(NN * NN.transpose());
-		Vector eigenVa = Vector::Zero(featDim-1, 1);
-		Matrix eigenVe = Matrix::Zero(featDim-1, featDim-1);
-		// Ensure that the matrix is suited for eigenvalues calculation
-		if(keepNormals || keepEigenValues || keepEigenVectors)
+				if(keepNormals)
+				{
+					// keep the eigenvector of the smallest eigenvalue, the first one if they are sorted
+					int normalId(0);
+					if(!sortEigen)
+						eigenVa.minCoeff(&normalId);
+					// clamp normals to [-1,1] to handle approximation errors
+					normals->col(i) = eigenVe.col(normalId).cwiseMax(-1.0).cwiseMin(1.0);
+				}
+				if(keepDensities)
+				{
+					if(isDegenerate)
+						(*densities)(0, i) = 0.;
+					else
+						(*densities)(0, i) = T(realKnn) / ((4./3.)*M_PI*std::pow(std::sqrt(maxSquaredNorm), 3));
+				}
+				if(keepEigenValues)
+				{
+					for(int k = 0; k < 3; ++k)
+						(*eigenValues)(k, i) = eigenVa(k);
+				}
+				if(keepEigenVectors)
+				{
+					// serialize row major
+					for(int k = 0; k < 3; ++k)
+						for(int l = 0; l < 3; ++l)
+							(*eigenVectors)(k*3 + l, i) = eigenVe(k, l);
+				}
+				if(keepMeanDist)
+				{
+					if(isDegenerate)
+						(*meanDists)(0, i) = std::numeric_limits<std::size_t>::max();
+					else
+						(*meanDists)(0, i) = (points[i] - mean).norm();
+				}
+			}
+		});
+		for (const int count : chunkDegenerateCounts)
+			degenerateCount += count;
+	}
+	else
+	{
+		// Generic path
+		for (int i = 0; i < pointsCount; ++i)
 		{
-			if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
+			bool isDegenerate = false;
+			// Mean of nearest neighbors (NN)
+			Matrix d(featDim-1, knn);
+			int realKnn = 0;
+
+			for(int j = 0; j < int(knn); ++j)
 			{
-				const Eigen::EigenSolver<Matrix> solver(C);
-				eigenVa = solver.eigenvalues().real();
-				eigenVe = solver.eigenvectors().real();
+				if (matches.dists(j,i) != Matches::InvalidDist)
+				{
+					const int refIndex(matches.ids(j,i));
+					d.col(realKnn) = cloud.features.block(0, refIndex, featDim-1, 1);
+					++realKnn;
+				}
+			}
+			d.conservativeResize(Eigen::NoChange, realKnn);
 
-				if(sortEigen)
+			const Vector mean = d.rowwise().sum() / T(realKnn);
+			const Matrix NN = d.colwise() - mean;
+
+			const Matrix C(NN * NN.transpose());
+			Vector eigenVa = Vector::Zero(featDim-1, 1);
+			Matrix eigenVe = Matrix::Zero(featDim-1, featDim-1);
+			// Ensure that the matrix is suited for eigenvalues calculation
+			if(keepNormals || keepEigenValues || keepEigenVectors)
+			{
+				if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
 				{
-					const std::vector<size_t> idx = sortIndexes<T>(eigenVa);
-					const size_t idxSize = idx.size();
-					Vector tmp_eigenVa = eigenVa;
-					Matrix tmp_eigenVe = eigenVe;
-					for(size_t i=0; i<idxSize; ++i)
+					const Eigen::EigenSolver<Matrix> solver(C);
+					eigenVa = solver.eigenvalues().real();
+					eigenVe = solver.eigenvectors().real();
+
+					if(sortEigen)
 					{
-						eigenVa(i,0) = tmp_eigenVa(idx[i], 0);
-						eigenVe.col(i) = tmp_eigenVe.col(idx[i]);
+						const std::vector<size_t> idx = sortIndexes<T>(eigenVa);
+						const size_t idxSize = idx.size();
+						Vector tmp_eigenVa = eigenVa;
+						Matrix tmp_eigenVe = eigenVe;
+						for(size_t i=0; i<idxSize; ++i)
+						{
+							eigenVa(i,0) = tmp_eigenVa(idx[i], 0);
+							eigenVe.col(i) = tmp_eigenVe.col(idx[i]);
+						}
 					}
 				}
+				else
+				{
+					//std::cout << "WARNING: Matrix C needed for eigen decomposition is degenerated. Expected cause: no noise in data" << std::endl;
+					++degenerateCount;
+					isDegenerate = true;
+				}
 			}
-			else
-			{
-				//std::cout << "WARNING: Matrix C needed for eigen decomposition is degenerated. Expected cause: no noise in data" << std::endl;
-				++degenerateCount;
-				isDegenerate = true;
-			}
-		}
 
-		if(keepNormals)
-		{
-			if(sortEigen)
-				normals->col(i) = eigenVe.col(0);
-			else
-				normals->col(i) = computeNormal<T>(eigenVa, eigenVe);
+			if(keepNormals)
+			{
+				if(sortEigen)
+					normals->col(i) = eigenVe.col(0);
+				else
+					normals->col(i) = computeNormal<T>(eigenVa, eigenVe);
 			
-			// clamp normals to [-1,1] to handle approximation errors
-			normals->col(i) = normals->col(i).cwiseMax(-1.0).cwiseMin(1.0);
-		}
-		if(keepDensities)
-		{
-			if(isDegenerate)
-				(*densities)(0, i) = 0.;
-			else
-				(*densities)(0, i) = computeDensity<T>(NN);
-		}
-		if(keepEigenValues)
-			eigenValues->col(i) = eigenVa;
-		if(keepEigenVectors)
-			eigenVectors->col(i) = serializeEigVec<T>(eigenVe);
-		if(keepMeanDist)
-		{
-			if(isDegenerate)
-				(*meanDists)(0, i) = std::numeric_limits<std::size_t>::max();
-			else
+				// clamp normals to [-1,1] to handle approximation errors
+				normals->col(i) = normals->col(i).cwiseMax(-1.0).cwiseMin(1.0);
+			}
+			if(keepDensities)
 			{
-				const Vector point = cloud.features.block(0, i, featDim-1, 1);
-				(*meanDists)(0, i) = (point - mean).norm();
+				if(isDegenerate)
+					(*densities)(0, i) = 0.;
+				else
+					(*densities)(0, i) = computeDensity<T>(NN);
+			}
+			if(keepEigenValues)
+				eigenValues->col(i) = eigenVa;
+			if(keepEigenVectors)
+				eigenVectors->col(i) = serializeEigVec<T>(eigenVe);
+			if(keepMeanDist)
+			{
+				if(isDegenerate)
+					(*meanDists)(0, i) = std::numeric_limits<std::size_t>::max();
+				else
+				{
+					const Vector point = cloud.features.block(0, i, featDim-1, 1);
+					(*meanDists)(0, i) = (point - mean).norm();
+				}
 			}
-		}
 
+		}
 	}
 
 	if(keepMatchedIds)
@@ -75,7 +75,8 @@ struct SurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 			{"keepMatchedIds" , "whether the identifiers of matches points should be added as descriptors to the resulting cloud", "0"},
 			{"keepMeanDist" , "whether the distance to the nearest neighbor mean should be added as descriptors to the resulting cloud", "0"},
 			{"sortEigen" , "whether the eigenvalues and eigenvectors should be sorted (ascending) based on the eigenvalues", "0"},
-			{"smoothNormals", "whether the normal vector should be average with the nearest neighbors", "0"}
+			{"smoothNormals", "whether the normal vector should be average with the nearest neighbors", "0"},
+			{"nbThreads", "number of threads used for the neighbor search and the descriptor computation, 0 uses all hardware threads", "1", "0", "65535", &P::Comp<unsigned>}
 		};
 	}
 	
@@ -90,6 +91,7 @@ struct SurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	const bool keepMeanDist;
 	const bool sortEigen;
 	const bool smoothNormals;
+	const unsigned nbThreads;
 
 	SurfaceNormalDataPointsFilter(const Parameters& params = Parameters());
 	virtual ~SurfaceNormalDataPointsFilter() {};
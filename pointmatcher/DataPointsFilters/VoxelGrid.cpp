@@ -34,6 +34,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "VoxelGrid.h"
 
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
 
 // VoxelGridDataPointsFilter
 template <typename T>
@@ -42,7 +46,8 @@ VoxelGridDataPointsFilter<T>::VoxelGridDataPointsFilter() :
 	vSizeY(1),
 	vSizeZ(1),
 	useCentroid(true),
-	averageExistingDescriptors(true) 
+	averageExistingDescriptors(true),
+	useSparseGrid(false)
 {
 }
 
@@ -54,7 +59,8 @@ VoxelGridDataPointsFilter<T>::VoxelGridDataPointsFilter(const Parameters& params
 	vSizeY(Parametrizable::get<T>("vSizeY")),
 	vSizeZ(Parametrizable::get<T>("vSizeZ")),
 	useCentroid(Parametrizable::get<bool>("useCentroid")),
-	averageExistingDescriptors(Parametrizable::get<bool>("averageExistingDescriptors"))
+	averageExistingDescriptors(Parametrizable::get<bool>("averageExistingDescriptors")),
+	useSparseGrid(Parametrizable::get<bool>("useSparseGrid"))
 {
 }
 
@@ -97,6 +103,12 @@ void VoxelGridDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	Vector minValues = cloud.features.rowwise().minCoeff();
 	Vector maxValues = cloud.features.rowwise().maxCoeff();
 
+	if (useSparseGrid)
+	{
+		sparseInPlaceFilter(cloud, minValues);
+		return;
+	}
+
 	const T minBoundX = minValues.x() / vSizeX;
 	const T maxBoundX = maxValues.x() / vSizeX;
 	const T minBoundY = minValues.y() / vSizeY;
@@ -120,14 +132,19 @@ void VoxelGridDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	if (featDim == 4 )
 	  numDivZ = 1 + maxBoundZ - minBoundZ;
 
-	unsigned int numVox = numDivX * numDivY;
+	std::uint64_t numVoxels = std::uint64_t(numDivX) * numDivY;
 	if (featDim == 4)
-		numVox *= numDivZ;
+		numVoxels *= numDivZ;
 	
-	if(numVox == 0)
+	if(numVoxels == 0)
 	{
 		throw InvalidParameter("VoxelGridDataPointsFilter: The number of voxel couldn't be computed. There might be NaNs in the feature matrix. Use the fileter RemoveNaNDataPointsFilter before this one if it's the case.");
 	}
+	if(numVoxels > std::numeric_limits<unsigned int>::max())
+	{
+		throw InvalidParameter((boost::format("VoxelGridDataPointsFilter: Too many voxels (%1%) for a dense grid. Try increasing the voxel dimensions or set useSparseGrid to 1.") % numVoxels).str());
+	}
+	const unsigned int numVox = numVoxels;
 
 	// Assume point cloud is randomly ordered
 	// compute a linear index of the following type
@@ -343,6 +360,123 @@ void VoxelGridDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	//	cloud.times.conservativeResize(Eigen::NoChange, numPtsOut)
 }
 
+//! Same as the dense grid, but only the occupied voxels are stored, in a hash table indexed by their packed integer coordinates
+template <typename T>
+void VoxelGridDataPointsFilter<T>::sparseInPlaceFilter(DataPoints& cloud, const Vector& minValues)
+{
+	typedef typename DataPoints::Index Index;
+
+	const Index numPoints(cloud.features.cols());
+	const int featDim(cloud.features.rows());
+	const int descDim(cloud.descriptors.rows());
+	const int timeDim(cloud.times.rows());
+	const int spaceDim(featDim - 1);
+
+	// The grid is aligned on the minimum of the cloud, as the dense one.
+	// Integer coordinates of voxels are packed in a 64-bit key, using 21
+	// bits per axis in 3D and 32 in 2D.
+	Vector vSize(spaceDim);
+	vSize(0) = vSizeX;
+	vSize(1) = vSizeY;
+	if (spaceDim == 3)
+		vSize(2) = vSizeZ;
+	const Vector minBounds(minValues.head(spaceDim).cwiseQuotient(vSize));
+	const int bitsPerAxis(spaceDim == 3 ? 21 : 32);
+	const std::uint64_t maxCoord((std::uint64_t(1) << bitsPerAxis) - 1);
+
+	if (!minBounds.allFinite() || !cloud.features.topRows(spaceDim).allFinite())
+	{
+		throw InvalidParameter("VoxelGridDataPointsFilter: The voxel coordinates couldn't be computed. There might be NaNs in the feature matrix. Use the fileter RemoveNaNDataPointsFilter before this one if it's the case.");
+	}
+
+	struct SparseVoxel
+	{
+		Index numPoints;
+		Index firstPoint;
+		std::uint64_t key;
+	};
+	std::vector<SparseVoxel> voxels;
+	std::unordered_map<std::uint64_t, std::size_t> voxelIndices;
+	std::vector<std::size_t> indices(numPoints);
+
+	for (Index p = 0; p < numPoints; ++p)
+	{
+		std::uint64_t key(0);
+		for (int d = 0; d < spaceDim; ++d)
+		{
+			const T coord(std::floor(cloud.features(d,p)/vSize(d) - minBounds(d)));
+			if (coord > T(maxCoord))
+				throw InvalidParameter((boost::format("VoxelGridDataPointsFilter: The cloud spans more than %1% voxels along an axis. Try increasing the voxel dimensions.") % maxCoord).str());
+			key |= std::uint64_t(coord) << (d * bitsPerAxis);
+		}
+
+		// Voxels are created in the order of their first point
+		const auto inserted(voxelIndices.insert(std::make_pair(key, voxels.size())));
+		if (inserted.second)
+			voxels.push_back(SparseVoxel{0, p, key});
+
+		indices[p] = inserted.first->second;
+		++voxels[indices[p]].numPoints;
+	}
+
+	// Sum up the points of every voxel in its first point
+	for (Index p = 0; p < numPoints; ++p)
+	{
+		const Index firstPoint = voxels[indices[p]].firstPoint;
+		if (firstPoint == p)
+			continue;
+
+		if (useCentroid)
+		{
+			for (int f = 0; f < spaceDim; ++f)
+				cloud.features(f,firstPoint) += cloud.features(f,p);
+		}
+		if (averageExistingDescriptors)
+		{
+			for (int d = 0; d < descDim; ++d)
+				cloud.descriptors(d,firstPoint) += cloud.descriptors(d,p);
+			for (int d = 0; d < timeDim; ++d)
+				cloud.times(d,firstPoint) += cloud.times(d,p);
+		}
+	}
+
+	// Normalize sums and move the voxels to the start of the cloud, their
+	// first points being in increasing order
+	const Index numPtsOut(voxels.size());
+	for (Index i = 0; i < numPtsOut; ++i)
+	{
+		const SparseVoxel& voxel(voxels[i]);
+		const Index firstPoint(voxel.firstPoint);
+
+		if (useCentroid)
+		{
+			for (int f = 0; f < spaceDim; ++f)
+				cloud.features(f,firstPoint) /= voxel.numPoints;
+		}
+		else
+		{
+			for (int f = 0; f < spaceDim; ++f)
+			{
+				const std::uint64_t coord((voxel.key >> (f * bitsPerAxis)) & maxCoord);
+				cloud.features(f,firstPoint) = (minBounds(f) + coord + T(0.5)) * vSize(f);
+			}
+		}
+
+		if (averageExistingDescriptors)
+		{
+			for (int d = 0; d < descDim; ++d)
+				cloud.descriptors(d,firstPoint) /= voxel.numPoints;
+			for (int d = 0; d < timeDim; ++d)
+				cloud.times(d,firstPoint) /= voxel.numPoints;
+		}
+
+		assert(i <= firstPoint);
+		cloud.setColFrom(i, cloud, firstPoint);
+	}
+
+	cloud.conservativeResize(numPtsOut);
+}
+
 template struct VoxelGridDataPointsFilter<float>;
 template struct VoxelGridDataPointsFilter<double>;
 
@@ -70,7 +70,8 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 			{"vSizeY", "Dimension of each voxel cell in y direction", "1.0", "0.001", "+inf", &P::Comp<T>},
 			{"vSizeZ", "Dimension of each voxel cell in z direction", "1.0", "0.001", "+inf", &P::Comp<T>},
 			{"useCentroid", "If 1 (true), down-sample by using centroid of voxel cell.  If false (0), use center of voxel cell.", "1", "0", "1", P::Comp<bool>},
-			{"averageExistingDescriptors", "whether the filter keep the existing point descriptors and average them or should it drop them", "1", "0", "1", P::Comp<bool>}
+			{"averageExistingDescriptors", "whether the filter keep the existing point descriptors and average them or should it drop them", "1", "0", "1", P::Comp<bool>},
+			{"useSparseGrid", "If 1 (true), only store the occupied voxels in a hash table, so that memory grows with the number of occupied voxels rather than with the extent of the cloud. If false (0), use a dense grid covering the bounding box of the cloud.", "0", "0", "1", P::Comp<bool>}
 		};
 	}
 
@@ -79,6 +80,7 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 	const T vSizeZ;
 	const bool useCentroid;
 	const bool averageExistingDescriptors;
+	const bool useSparseGrid;
 
 	struct Voxel {
 		unsigned int    numPoints;
@@ -95,4 +97,7 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+
+private:
+	void sparseInPlaceFilter(DataPoints& cloud, const Vector& minValues);
 };
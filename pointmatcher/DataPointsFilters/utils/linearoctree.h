@@ -0,0 +1,163 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2018,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "PointMatcher.h"
+#include "Functions.h"
+
+#include "octree.h"
+
+/*!
+ * \class linearoctree.h
+ * \brief Linear octree class for DataPoints spatial representation
+ *
+ * Alternative to Octree_ for large point clouds, with the same decomposition:
+ * a node is split in (8/4) cells of half its size until it holds at most a
+ * given number of points, or until its size is below a given size.
+ *
+ * Instead of allocating every node, the points are sorted by Morton code, so
+ * that the points of every node are a contiguous range of the sorted indexes.
+ * The nodes are stored in one array, level after level, and the (8/4) children
+ * of a node are consecutive in this array. The codes, the sort and every level
+ * of the tree are computed in parallel.
+ *
+ * The Morton code of a point is computed by descending the cells with the same
+ * comparisons as Octree_, so both trees have the same leaves, and the indexes
+ * in every leaf are sorted in increasing order, as in Octree_. The depth is
+ * limited by the 64 bits of the code: 21 levels in 3D and 32 levels in 2D.
+ * Cells at this depth are leaves, whatever their number of points.
+ *
+ * The tree is visited as Octree_, with a Visitor implementing:
+ *	```cpp
+ *	template<typename T>
+ *	struct Visitor {
+ *		template<typename Cell>
+ *		bool operator()(Cell& cell);
+ *	};
+ *	```
+ */
+template < typename T, std::size_t dim >
+class LinearOctree_
+{
+public:
+	using PM = PointMatcher<T>;
+	using DP = typename PM::DataPoints;
+	using Id = typename DP::Index;
+	
+	using Data = typename DP::Index;
+	
+	using Point = Eigen::Matrix<T,dim,1>;
+	using Code = std::uint64_t;
+	
+	static constexpr std::size_t nbCells = PointMatcherSupport::pow(2, dim);
+	static constexpr std::size_t maxDepth = 64 / dim;
+
+	//! Contiguous range of point indexes
+	struct DataRange
+	{
+		const Data* first;
+		std::size_t count;
+		
+		std::size_t size() const { return count; }
+		const Data& operator[](std::size_t i) const { return first[i]; }
+		const Data* begin() const { return first; }
+		const Data* end() const { return first + count; }
+	};
+
+private:
+	struct Node
+	{
+		std::size_t begin; // first point of the node in the sorted indexes
+		std::size_t end; // end of the points of the node in the sorted indexes
+		std::size_t firstChild; // position of the first child in nodes, 0 for leaves
+		std::size_t depth;
+		Point center;
+		T radius;
+	};
+	
+	std::vector<Node, Eigen::aligned_allocator<Node>> nodes;
+	std::vector<Data> ids; // indexes of the points, sorted by Morton code
+
+public:
+	//! View on a node, passed to visitors
+	class Cell
+	{
+		const LinearOctree_* tree;
+		std::size_t node;
+		DataRange data;
+		
+	public:
+		using Point = Eigen::Matrix<T,dim,1>;
+		
+		Cell(const LinearOctree_* tree, std::size_t node);
+		
+		bool isLeaf() const;
+		bool isRoot() const;
+		bool isEmpty() const;
+		
+		std::size_t getDepth() const;
+		T getRadius() const;
+		Point getCenter() const;
+		
+		const DataRange* getData() const;
+		Cell operator[](std::size_t idx) const;
+	};
+
+	LinearOctree_();
+	
+	// Build tree from DataPoints with a specified stop parameter, 0 threads uses all hardware threads
+	bool build(const DP& pts, std::size_t maxDataByNode=1, T maxSizeByNode=T(0.), unsigned nbThreads=0);
+	
+	Cell root() const;
+	std::size_t getNbNodes() const;
+	
+	// Visit the nodes depth-first, in the same order as Octree_
+	template < typename Callback >
+	bool visit(Callback& cb) const;
+
+private:
+	inline std::size_t idx(const Point& pt, const Point& center) const;
+	inline Code code(const Point& pt, const Point& center, const T radius) const;
+	inline std::size_t digit(const Code c, const std::size_t depth) const;
+	
+	void sortByCode(std::vector<std::pair<Code, Data>>& keys, unsigned nbThreads) const;
+};
+
+#include "linearoctree.hpp"
+
+template<typename T> using LinearQuadtree = LinearOctree_<T,2>;
+template<typename T> using LinearOctree = LinearOctree_<T,3>;
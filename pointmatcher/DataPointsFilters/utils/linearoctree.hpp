@@ -0,0 +1,347 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2018,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include "linearoctree.h"
+
+#include <algorithm>
+#include <utility>
+#include <ciso646>
+
+template<typename T, std::size_t dim>
+LinearOctree_<T,dim>::Cell::Cell(const LinearOctree_* tree, std::size_t node):
+	tree{tree}, node{node}
+{
+	const Node& n = tree->nodes[node];
+	data.first = tree->ids.data() + n.begin;
+	//Data element are exclusively contained in leaves node
+	data.count = (n.firstChild == 0) ? n.end - n.begin : 0;
+}
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Cell::isLeaf() const
+{
+	return (tree->nodes[node].firstChild == 0);
+}
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Cell::isRoot() const
+{
+	return (node == 0);
+}
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Cell::isEmpty() const
+{
+	return (data.size() == 0);
+}
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::Cell::getDepth() const
+{
+	return tree->nodes[node].depth;
+}
+template<typename T, std::size_t dim>
+T LinearOctree_<T,dim>::Cell::getRadius() const
+{
+	return tree->nodes[node].radius;
+}
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Point LinearOctree_<T,dim>::Cell::getCenter() const
+{
+	return tree->nodes[node].center;
+}
+template<typename T, std::size_t dim>
+const typename LinearOctree_<T,dim>::DataRange* LinearOctree_<T,dim>::Cell::getData() const
+{
+	return &data;
+}
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Cell LinearOctree_<T,dim>::Cell::operator[](std::size_t idx) const
+{
+	assert(idx<nbCells and not isLeaf());
+	return Cell(tree, tree->nodes[node].firstChild + idx);
+}
+
+template<typename T, std::size_t dim>
+LinearOctree_<T,dim>::LinearOctree_()
+{
+}
+
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Cell LinearOctree_<T,dim>::root() const
+{
+	assert(not nodes.empty());
+	return Cell(this, 0);
+}
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::getNbNodes() const
+{
+	return nodes.size();
+}
+
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::idx(const Point& pt, const Point& center) const
+{
+	std::size_t id = 0;
+
+	for(std::size_t i=0; i<dim; ++i)
+		id|= ((pt(i) > center(i)) << i);
+
+	return id;
+}
+
+//Descend the cells as Octree_ does, appending the id of the cell of every level
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Code LinearOctree_<T,dim>::code(const Point& pt, const Point& center, const T radius) const
+{
+	Point c = center;
+	T r = radius;
+	Code morton = 0;
+	for(std::size_t depth=0; depth<maxDepth; ++depth)
+	{
+		const std::size_t id = idx(pt, c);
+		morton = (morton << dim) | Code(id);
+		const Point offset = OctreeHelper<T,dim>::offsetTable[id] * r;
+		c = c + offset;
+		r *= 0.5;
+	}
+	return morton;
+}
+
+//Id of the cell containing a code, among the children of a node at depth
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::digit(const Code c, const std::size_t depth) const
+{
+	return std::size_t(c >> (dim * (maxDepth - 1 - depth))) & (nbCells - 1);
+}
+
+//Sort chunks in parallel, then merge them pairwise
+template<typename T, std::size_t dim>
+void LinearOctree_<T,dim>::sortByCode(std::vector<std::pair<Code, Data>>& keys, unsigned nbThreads) const
+{
+	using namespace PointMatcherSupport;
+	
+	const std::size_t nbKeys = keys.size();
+	const std::size_t nbChunks = std::min<std::size_t>(getThreadCount(nbThreads), nbKeys);
+	if(nbChunks <= 1)
+	{
+		std::sort(keys.begin(), keys.end());
+		return;
+	}
+	
+	//same chunks as parallelFor
+	std::vector<std::size_t> bounds(nbChunks + 1);
+	for(std::size_t i=0; i<=nbChunks; ++i)
+		bounds[i] = (nbKeys * i) / nbChunks;
+	
+	parallelFor(nbKeys, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+	{
+		std::sort(keys.begin() + begin, keys.begin() + end);
+	});
+	
+	for(std::size_t width=1; width<nbChunks; width*=2)
+	{
+		const std::size_t nbMerges = (nbChunks + 2*width - 1) / (2*width);
+		parallelFor(nbMerges, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+		{
+			for(std::size_t i=begin; i<end; ++i)
+			{
+				const std::size_t first = 2*width*i;
+				const std::size_t middle = first + width;
+				if(middle >= nbChunks) continue;
+				const std::size_t last = std::min(first + 2*width, nbChunks);
+				std::inplace_merge(keys.begin() + bounds[first], keys.begin() + bounds[middle], keys.begin() + bounds[last]);
+			}
+		});
+	}
+}
+
+// Build tree from DataPoints with a specified number of points by node
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::build(const DP& pts, std::size_t maxDataByNode, T maxSizeByNode, unsigned nbThreads)
+{
+	using namespace PointMatcherSupport;
+	typedef typename PM::Vector Vector;
+	
+	nodes.clear();
+	
+	const std::size_t nbPts = pts.getNbPoints();
+	if(nbPts == 0)
+	{
+		ids.clear();
+		return false;
+	}
+	
+	//Build bounding box, as Octree_
+	Node root;
+	
+	Vector minValues = pts.features.rowwise().minCoeff();
+	Vector maxValues = pts.features.rowwise().maxCoeff();
+	
+	Point min = minValues.head(dim);
+	Point max = maxValues.head(dim);
+	
+	Point radii = max - min;
+	root.center = min + radii * 0.5;
+	
+	root.radius = radii(0);
+	for(std::size_t i=1; i<dim; ++i)
+		if (root.radius < radii(i)) root.radius = radii(i);
+		
+	root.radius*=0.5;
+	root.begin = 0;
+	root.end = nbPts;
+	root.firstChild = 0;
+	root.depth = 0;
+	
+	//Sort the points by Morton code
+	std::vector<std::pair<Code, Data>> keys(nbPts);
+	parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+	{
+		for(std::size_t i=begin; i<end; ++i)
+			keys[i] = std::make_pair(code(pts.features.col(i).head(dim), root.center, root.radius), Data(i));
+	});
+	sortByCode(keys, nbThreads);
+	
+	std::vector<Code> codes(nbPts);
+	ids.resize(nbPts);
+	parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+	{
+		for(std::size_t i=begin; i<end; ++i)
+		{
+			codes[i] = keys[i].first;
+			ids[i] = keys[i].second;
+		}
+	});
+	
+	//Build the tree level by level, the children of the nodes of a level are appended after it
+	nodes.push_back(root);
+	std::size_t levelBegin = 0;
+	std::size_t levelEnd = 1;
+	while(levelBegin < levelEnd)
+	{
+		const std::size_t levelSize = levelEnd - levelBegin;
+		
+		//Check stop condition
+		std::vector<std::size_t> firstChildren(levelSize);
+		parallelFor(levelSize, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+		{
+			for(std::size_t i=begin; i<end; ++i)
+			{
+				const Node& node = nodes[levelBegin + i];
+				const bool isLeaf = (node.radius*2.0 <= maxSizeByNode) or (node.end - node.begin <= maxDataByNode) or (node.depth == maxDepth);
+				firstChildren[i] = isLeaf ? 0 : nbCells;
+			}
+		});
+		
+		//Allocate the children
+		std::size_t nextLevelEnd = levelEnd;
+		for(std::size_t& firstChild : firstChildren)
+		{
+			const std::size_t nbChildren = firstChild;
+			firstChild = (nbChildren > 0) ? nextLevelEnd : 0;
+			nextLevelEnd += nbChildren;
+		}
+		nodes.resize(nextLevelEnd);
+		
+		//Split the ranges of the nodes, the ids of the cells being sorted in the range of a node
+		parallelFor(levelSize, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+		{
+			for(std::size_t i=begin; i<end; ++i)
+			{
+				Node& node = nodes[levelBegin + i];
+				node.firstChild = firstChildren[i];
+				if(node.firstChild == 0) continue;
+				
+				const T halfRadius = node.radius * 0.5;
+				std::size_t childBegin = node.begin;
+				for(std::size_t c=0; c<nbCells; ++c)
+				{
+					const std::size_t childEnd = std::partition_point(
+						codes.begin() + childBegin, codes.begin() + node.end,
+						[&](const Code key) { return digit(key, node.depth) <= c; }
+					) - codes.begin();
+					
+					Node& child = nodes[node.firstChild + c];
+					child.begin = childBegin;
+					child.end = childEnd;
+					child.firstChild = 0;
+					child.depth = node.depth + 1;
+					const Point offset = OctreeHelper<T,dim>::offsetTable[c] * node.radius;
+					child.center = node.center + offset;
+					child.radius = halfRadius;
+					
+					childBegin = childEnd;
+				}
+			}
+		});
+		
+		levelBegin = levelEnd;
+		levelEnd = nextLevelEnd;
+	}
+	
+	//Points of a leaf are sorted by code, sort them by index as in Octree_
+	parallelFor(nodes.size(), nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+	{
+		for(std::size_t i=begin; i<end; ++i)
+			if(nodes[i].firstChild == 0 and nodes[i].end - nodes[i].begin > 1)
+				std::sort(ids.begin() + nodes[i].begin, ids.begin() + nodes[i].end);
+	});
+	
+	return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, std::size_t dim>
+template<typename Callback>
+bool LinearOctree_<T,dim>::visit(Callback& cb) const
+{
+	if(nodes.empty()) return true;
+	
+	//Depth-first traversal, children in increasing id order
+	std::vector<std::size_t> stack(1, 0);
+	while(not stack.empty())
+	{
+		const std::size_t node = stack.back();
+		stack.pop_back();
+		
+		// Call the callback for this node (if the callback returns false, then
+		// stop traversing.
+		Cell cell(this, node);
+		if (!cb(cell)) return false;
+		
+		const std::size_t firstChild = nodes[node].firstChild;
+		if(firstChild != 0)
+			for(std::size_t c=nbCells; c-- > 0;)
+				stack.push_back(firstChild + c);
+	}
+	
+	return true;
+}
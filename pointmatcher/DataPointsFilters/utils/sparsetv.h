@@ -32,6 +32,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 
 #include "pointmatcher/PointMatcher.h"
+#include "pointmatcher/Functions.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 #include <Eigen/Core>
 #include <Eigen/Eigenvalues>
@@ -80,6 +85,7 @@ public:
 //--attributes
 	const T sigma; //control the scale of the voting field
 	std::size_t k; //number of neighbors
+	const unsigned nbThreads; //number of threads, 0 uses all hardware threads
 
 	Tensors tensors;
 	
@@ -106,7 +112,7 @@ private:
 
 public:
 //--ctor
-	TensorVoting(T sigma_ = T(0.2), std::size_t k_ = 50);
+	TensorVoting(T sigma_ = T(0.2), std::size_t k_ = 50, unsigned nbThreads_ = 1);
 //--dtor
 	~TensorVoting();
 
@@ -178,6 +184,24 @@ public:
 	};
 private:
 	void computeKnn(const DP& pts);
+	
+	using VoteList = std::vector<std::pair<Index, Tensor>>;
+	
+	//votes cast by the voters of a chunk: added to the tensors of the points of the chunk, kept in outgoing for the other points
+	struct Votes
+	{
+		Tensors& tensors;
+		const std::vector<std::size_t>& chunkBegins;
+		const std::size_t chunk;
+		std::vector<VoteList>& outgoing; //by chunk of the votee
+		
+		void add(const Index votee, const Tensor& vote);
+	};
+	
+	//call castVotes(voter, votes) on every voter in parallel, every thread adding the votes for its own points to tensors
+	//and keeping the others until the end of the round, when they are added by the threads owning these points
+	template <typename F>
+	void accumulateVotes(const std::size_t nbPts, const F& castVotes);
 };
 
 #include "sparsetv.hpp"
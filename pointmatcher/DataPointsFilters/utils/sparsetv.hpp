@@ -35,7 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 //--ctor
 template <typename T>
-TensorVoting<T>::TensorVoting(T sigma_, std::size_t k_) : sigma{sigma_}, k{k_}
+TensorVoting<T>::TensorVoting(T sigma_, std::size_t k_, unsigned nbThreads_) : sigma{sigma_}, k{k_}, nbThreads{nbThreads_}
 {
 }
 //--dtor
@@ -61,18 +61,22 @@ void TensorVoting<T>::encode(const DP& pts, Encoding encoding)
 	{
 		case Encoding::ZERO:
 		{
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i) 
-				tensors(i) = Tensor::Zero();
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					tensors(i) = Tensor::Zero();
+			});
 			break;
 		}
 //------		
 		case Encoding::UBALL:
 		case Encoding::BALL:
 		{
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
-				tensors(i) = Tensor::Identity();
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					tensors(i) = Tensor::Identity();
+			});
 			break;
 		}
 		case Encoding::SBALL:
@@ -82,21 +86,25 @@ void TensorVoting<T>::encode(const DP& pts, Encoding encoding)
 				throw InvalidField("TensorVoting<T>::encode: Error, cannot find balls in descriptors.");
 
 			const auto& balls_ = pts.getDescriptorViewByName("balls");
-#pragma omp parallel for						
-			for(std::size_t i = 0; i < nbPts; ++i)
-				tensors(i) = Tensor::Identity() * balls_(0,i);
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					tensors(i) = Tensor::Identity() * balls_(0,i);
+			});
 
 			break;
 		}
 //------
 		case Encoding::UPLATE:
 		{
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
-				tensors(i) << 
-					1., 0., 0., 
-					0., 1., 0., 
-					0., 0., 0.;
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					tensors(i) << 
+						1., 0., 0., 
+						0., 1., 0., 
+						0., 0., 0.;
+			});
 			break;
 		}			
 		case Encoding::PLATE:
@@ -107,25 +115,29 @@ void TensorVoting<T>::encode(const DP& pts, Encoding encoding)
 				throw InvalidField("TensorVoting<T>::encode: Error, cannot find plates in descriptors.");
 
 			const auto& plates_ = pts.getDescriptorViewByName("plates");
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 			{
-				const Vector3 n1 = plates_.col(i).segment(1,3);
-				const Vector3 n2 = plates_.col(i).tail(3);
+				for(std::size_t i = begin; i < end; ++i)
+				{
+					const Vector3 n1 = plates_.col(i).segment(1,3);
+					const Vector3 n2 = plates_.col(i).tail(3);
 				
-				tensors(i) = (encoding == Encoding::SPLATE ? plates_(0,i) : 1.) * (n1 * n1.transpose() + n2 * n2.transpose());
-			}
+					tensors(i) = (encoding == Encoding::SPLATE ? plates_(0,i) : 1.) * (n1 * n1.transpose() + n2 * n2.transpose());
+				}
+			});
 			break;
 		}
 //------	
 		case Encoding::USTICK:
 		{
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
-				tensors(i) << 
-					1., 0., 0., 
-					0., 0., 0., 
-					0., 0., 0.;
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+			{
+				for(std::size_t i = begin; i < end; ++i)
+					tensors(i) << 
+						1., 0., 0., 
+						0., 0., 0., 
+						0., 0., 0.;
+			});
 			break;
 		}				
 		case Encoding::STICK:
@@ -136,12 +148,14 @@ void TensorVoting<T>::encode(const DP& pts, Encoding encoding)
 				throw InvalidField("TensorVoting<T>::encode: Error, cannot find sticks in descriptors.");
 
 			const auto& sticks_ = pts.getDescriptorViewByName("sticks");
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 			{
-				const Vector3 n = sticks_.col(i).tail(3);		
-				tensors(i) = (encoding == Encoding::SSTICK ? sticks_(0,i) : 1.) * (n * n.transpose());
-			}
+				for(std::size_t i = begin; i < end; ++i)
+				{
+					const Vector3 n = sticks_.col(i).tail(3);		
+					tensors(i) = (encoding == Encoding::SSTICK ? sticks_(0,i) : 1.) * (n * n.transpose());
+				}
+			});
 			break;
 		}
 //------
@@ -156,14 +170,16 @@ void TensorVoting<T>::encode(const DP& pts, Encoding encoding)
 
 			const auto& sticks_ = pts.getDescriptorViewByName("sticks");
 			const auto& plates_ = pts.getDescriptorViewByName("plates");
-#pragma omp parallel for
-			for(std::size_t i = 0; i < nbPts; ++i)
+			PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 			{
-				const Tensor S = sticks_.col(i).tail(3) * sticks_.col(i).tail(3).transpose();
-				const Tensor P = plates_.col(i).segment(1,3) * plates_.col(i).segment(1,3).transpose() + plates_.col(i).tail(3) * plates_.col(i).tail(3).transpose();
+				for(std::size_t i = begin; i < end; ++i)
+				{
+					const Tensor S = sticks_.col(i).tail(3) * sticks_.col(i).tail(3).transpose();
+					const Tensor P = plates_.col(i).segment(1,3) * plates_.col(i).segment(1,3).transpose() + plates_.col(i).tail(3) * plates_.col(i).tail(3).transpose();
 		
-				tensors(i) = (sticks_(0,i) / k) * S + (plates_(0,i) / k) * P;
-			}
+					tensors(i) = (sticks_(0,i) / k) * S + (plates_(0,i) / k) * P;
+				}
+			});
 			break;
 		}	
 	}
@@ -173,14 +189,16 @@ template <typename T>
 void TensorVoting<T>::disableBallComponent()
 {
 	const std::size_t nbPts = tensors.rows();
-#pragma omp parallel for
-	for(std::size_t i = 0; i < nbPts; ++i)
+	PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 	{
-		const Tensor S = sticks.col(i).tail(3) * sticks.col(i).tail(3).transpose();
-		const Tensor P = plates.col(i).segment(1,3) * plates.col(i).segment(1,3).transpose() + plates.col(i).tail(3) * plates.col(i).tail(3).transpose();
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			const Tensor S = sticks.col(i).tail(3) * sticks.col(i).tail(3).transpose();
+			const Tensor P = plates.col(i).segment(1,3) * plates.col(i).segment(1,3).transpose() + plates.col(i).tail(3) * plates.col(i).tail(3).transpose();
 		
-		tensors(i) = (sticks(0,i) / k) * S + (plates(0,i) / k) * P;
-	}
+			tensors(i) = (sticks(0,i) / k) * S + (plates(0,i) / k) * P;
+		}
+	});
 }
 
 template <typename T>
@@ -220,7 +238,7 @@ void TensorVoting<T>::ballVote(const DP& pts, bool doKnn)
 	
 	if(doKnn) computeKnn(pts);
 	
-	for(std::size_t voter = 0; voter < nbPts; ++voter)
+	accumulateVotes(nbPts, [&](const std::size_t voter, Votes& votes)
 	{
 		for(std::size_t j = 0; j < k ; j++)
 		{
@@ -239,12 +257,11 @@ void TensorVoting<T>::ballVote(const DP& pts, bool doKnn)
 					if(normVv > 0.)
 					{
 						//accumulate vote a votee location with decay function weighting voter vote
-						const Tensor acc = tensors(votee) + DecayFunction::sradial(normDist) * (I - vv / normVv);
-						tensors(votee) = acc;
+						votes.add(votee, DecayFunction::sradial(normDist) * (I - vv / normVv));
 					}
 			}	
 		}
-	}
+	});
 }
 
 	
@@ -261,7 +278,7 @@ void TensorVoting<T>::stickVote(const DP& pts, bool doKnn)
 		
 	if(doKnn) computeKnn(pts);
 	
-	for(std::size_t voter = 0; voter < nbPts; ++voter)
+	accumulateVotes(nbPts, [&](const std::size_t voter, Votes& votes)
 	{
 		Vector3 vn = sticks_.col(voter).tail(3).normalized(); //normal
 		const Vector3 O  = pts.features.col(voter).head(3); //voter coord
@@ -299,12 +316,11 @@ void TensorVoting<T>::stickVote(const DP& pts, bool doKnn)
 					const Vector3 vc = vn * std::cos(2. * theta) - vt * std::sin(2. * theta); //vote cast								
 		
 					//accumulate vote a votee location with decay function weighting voter vote			
-					const Tensor acc = tensors(votee) + sticks_(0, voter) * DecayFunction::eta(normDist * sigma, sigma, vvn) * (vc * vc.transpose());					
-					tensors(votee) = acc;
+					votes.add(votee, sticks_(0, voter) * DecayFunction::eta(normDist * sigma, sigma, vvn) * (vc * vc.transpose()));
 				}
 			}	
 		}
-	}
+	});
 }
 
 //FIXME: not sure of the implementation...
@@ -321,7 +337,7 @@ void TensorVoting<T>::plateVote(const DP& pts, bool doKnn)
 		
 	if(doKnn) computeKnn(pts);
 		
-	for(std::size_t voter = 0; voter < nbPts; ++voter)
+	accumulateVotes(nbPts, [&](const std::size_t voter, Votes& votes)
 	{
 		Matrix U(3,2); U << plates_.col(voter).segment(1,3), plates_.col(voter).tail(3);
 		const Matrix Ns = U*U.transpose(); //normalspace
@@ -363,13 +379,12 @@ void TensorVoting<T>::plateVote(const DP& pts, bool doKnn)
 						const Vector3 vc = vn * std::cos(2. * theta) - vt * std::sin(2. * theta); //vote cast
 			
 						//accumulate vote a votee location with decay function weighting voter vote			
-						const Tensor acc = tensors(votee) + plates_(0, voter) * DecayFunction::eta(normDist*sigma, sigma, vvn) * (vc * vc.transpose());				
-						tensors(votee) = acc;
+						votes.add(votee, plates_(0, voter) * DecayFunction::eta(normDist*sigma, sigma, vvn) * (vc * vc.transpose()));
 					}
 				}	
 			}
 		}
-	}
+	});
 }
 
 /*******************************************************************************
@@ -387,40 +402,43 @@ void TensorVoting<T>::cfvote(const DP& pts, bool doKnn)
 	const Tensors K = tensors; //save old tensors values
 	encode(pts, Encoding::ZERO); //all tensors are zero
 	
-#pragma omp parallel for
-	for(std::size_t votee = 0; votee < nbPts; ++votee) //vote sites
+	//every votee gathers its votes, so that votees can be processed in parallel
+	PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 	{
-		const Vector3 x_i  = pts.features.col(votee).head(3);
-		
-		for(std::size_t j = 0; j < k ; j++) //voters
+		for(std::size_t votee = begin; votee < end; ++votee) //vote sites
 		{
-			const Index voter = indices(j,votee); //get voter at site Xi
+			const Vector3 x_i  = pts.features.col(votee).head(3);
 		
-			if(voter == NNS::InvalidIndex) continue;		
-			if(voter == Index(votee)) continue;
+			for(std::size_t j = 0; j < k ; j++) //voters
+			{
+				const Index voter = indices(j,votee); //get voter at site Xi
+		
+				if(voter == NNS::InvalidIndex) continue;		
+				if(voter == Index(votee)) continue;
 			
-			const Vector3 x_j = pts.features.col(voter).head(3); 
-			Vector3 r_ij = x_i - x_j;
+				const Vector3 x_j = pts.features.col(voter).head(3); 
+				Vector3 r_ij = x_i - x_j;
 			
-			const T normDist = r_ij.norm() / sigma;
+				const T normDist = r_ij.norm() / sigma;
 			
-			if(normDist > 0. and normDist < 3.) //if not too far
-			{
-				r_ij.normalize();
+				if(normDist > 0. and normDist < 3.) //if not too far
+				{
+					r_ij.normalize();
 
-				const Tensor rrt = r_ij * r_ij.transpose();
-				const Tensor R_ij = (Tensor::Identity() - 2. * rrt);
-				const Tensor Rp_ij  = (Tensor::Identity() - .5 * rrt) * R_ij;
-				const T c_ij = DecayFunction::cij((x_i - x_j).norm(), sigma);
+					const Tensor rrt = r_ij * r_ij.transpose();
+					const Tensor R_ij = (Tensor::Identity() - 2. * rrt);
+					const Tensor Rp_ij  = (Tensor::Identity() - .5 * rrt) * R_ij;
+					const T c_ij = DecayFunction::cij((x_i - x_j).norm(), sigma);
 				
-				//accumulate vote a voter location with decay function weighting voter vote	
-				const Tensor S_ij = c_ij * R_ij * K(voter) * Rp_ij;
+					//accumulate vote a voter location with decay function weighting voter vote	
+					const Tensor S_ij = c_ij * R_ij * K(voter) * Rp_ij;
 				
-				const Tensor acc = tensors(votee) + S_ij;
-				tensors(votee) = acc;
-			}	
+					const Tensor acc = tensors(votee) + S_ij;
+					tensors(votee) = acc;
+				}	
+			}
 		}
-	}
+	});
 }
 
 template <typename T>
@@ -432,42 +450,44 @@ void TensorVoting<T>::decompose()
 	sparsePlate.resize(nbPts);
 	sparseBall.resize(nbPts);
 	
-#pragma omp parallel for	
-	for(std::size_t i = 0; i < nbPts; ++i)
+	PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 	{
-		Eigen::SelfAdjointEigenSolver<Tensor> solver(tensors(i));
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			Eigen::SelfAdjointEigenSolver<Tensor> solver(tensors(i));
 		
-		const Matrix33 eigenVe = solver.eigenvectors();
-		const Vector3 eigenVa = solver.eigenvalues().array().abs();
+			const Matrix33 eigenVe = solver.eigenvectors();
+			const Vector3 eigenVa = solver.eigenvalues().array().abs();
 		
-		// lambda1 > lambda2 > lambda3 > 0
-		int lambda1_idx; const T lambda1 = eigenVa.maxCoeff(&lambda1_idx);
-		int lambda3_idx; const T lambda3 = eigenVa.minCoeff(&lambda3_idx);
-		const int lambda2_idx = (0+1+2) - (lambda1_idx + lambda3_idx);
-		const T lambda2 = eigenVa(lambda2_idx);
+			// lambda1 > lambda2 > lambda3 > 0
+			int lambda1_idx; const T lambda1 = eigenVa.maxCoeff(&lambda1_idx);
+			int lambda3_idx; const T lambda3 = eigenVa.minCoeff(&lambda3_idx);
+			const int lambda2_idx = (0+1+2) - (lambda1_idx + lambda3_idx);
+			const T lambda2 = eigenVa(lambda2_idx);
 		
-		const T norm = 1;   
+			const T norm = 1;   
 		
-		if(not (lambda1 >= lambda2 and lambda2 >= lambda3) or lambda2_idx > 2. or lambda2_idx < 0.)
-		{
-			sparseStick(i) 	<< 0.0001,0.,0.,0.;
-			sparsePlate(i) 	<< 0.0001,0.,0.,0.;
-			sparseBall(i) 	<< 0.0001,0.,0.,0.;
+			if(not (lambda1 >= lambda2 and lambda2 >= lambda3) or lambda2_idx > 2. or lambda2_idx < 0.)
+			{
+				sparseStick(i) 	<< 0.0001,0.,0.,0.;
+				sparsePlate(i) 	<< 0.0001,0.,0.,0.;
+				sparseBall(i) 	<< 0.0001,0.,0.,0.;
 			
-			//std::cerr << "Warning: eigen values not ordered ("<<eigenVa(0)<<", "<<eigenVa(1)<<", "<<eigenVa(2)<<")" << std::endl;
-			continue;
-		}
+				//std::cerr << "Warning: eigen values not ordered ("<<eigenVa(0)<<", "<<eigenVa(1)<<", "<<eigenVa(2)<<")" << std::endl;
+				continue;
+			}
 				
-		// store relevant stick, plate, ball information:
-		sparseStick(i)(0) = (lambda1 - lambda2) / norm; //
-		sparseStick(i).tail(3) = eigenVe.col(lambda1_idx); //normal information
+			// store relevant stick, plate, ball information:
+			sparseStick(i)(0) = (lambda1 - lambda2) / norm; //
+			sparseStick(i).tail(3) = eigenVe.col(lambda1_idx); //normal information
 		
-		sparsePlate(i)(0) = (lambda2 - lambda3) / norm; //
-		sparsePlate(i).tail(3) = eigenVe.col(lambda3_idx); //tangent information
+			sparsePlate(i)(0) = (lambda2 - lambda3) / norm; //
+			sparsePlate(i).tail(3) = eigenVe.col(lambda3_idx); //tangent information
 		
-		sparseBall(i)(0) = lambda3 / norm; //
-		sparseBall(i).tail(3) = eigenVe.col(lambda2_idx); //<< 0.,0.,0.; //no principal direction, but store lambda2 for convinience
-	}
+			sparseBall(i)(0) = lambda3 / norm; //
+			sparseBall(i).tail(3) = eigenVe.col(lambda2_idx); //<< 0.,0.,0.; //no principal direction, but store lambda2 for convinience
+		}
+	});
 }
 
 template <typename T>
@@ -486,24 +506,26 @@ void TensorVoting<T>::toDescriptors()
 	plates = PM::Matrix::Zero(7, nbPts);
 	balls  = PM::Matrix::Zero(1, nbPts);
 
-#pragma omp parallel for  
-	for(std::size_t i = 0; i < nbPts; i++)
+	PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
 	{
-		surfaceness(i) = sparseStick(i)(0) / k;
-		curveness(i) = sparsePlate(i)(0) / k;
-		pointness(i) = sparseBall(i)(0) / k;
+		for(std::size_t i = begin; i < end; ++i)
+		{
+			surfaceness(i) = sparseStick(i)(0) / k;
+			curveness(i) = sparsePlate(i)(0) / k;
+			pointness(i) = sparseBall(i)(0) / k;
 
-		normals.col(i) = sparseStick(i).tail(3);
-		tangents.col(i) = sparsePlate(i).tail(3);
+			normals.col(i) = sparseStick(i).tail(3);
+			tangents.col(i) = sparsePlate(i).tail(3);
 		
-		sticks.col(i) = sparseStick(i); //s + e1
+			sticks.col(i) = sparseStick(i); //s + e1
 		
-		plates(0,i) = sparsePlate(i)(0); //s
-		plates.col(i).segment(1,3) = sparseStick(i).tail(3); //e1
-		plates.col(i).tail(3) = sparseBall(i).tail(3); //e2
+			plates(0,i) = sparsePlate(i)(0); //s
+			plates.col(i).segment(1,3) = sparseStick(i).tail(3); //e1
+			plates.col(i).tail(3) = sparseBall(i).tail(3); //e2
 		
-		balls(i) = sparseBall(i)(0); //s
-	}
+			balls(i) = sparseBall(i)(0); //s
+		}
+	});
 }
 
 template <typename T>
@@ -522,5 +544,74 @@ void TensorVoting<T>::computeKnn(const DP& pts)
 	indices = IndexMatrix::Zero(k, nbPts);
 	dist = Matrix::Zero(k, nbPts);
 
-	knn->knn(pts.features, indices, dist, Index(k));
+	//every point is searched independently, so querying the tree by chunks of columns gives the same result
+	PointMatcherSupport::parallelFor(nbPts, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned)
+	{
+		const Index count(end - begin);
+		const Matrix query(pts.features.middleCols(begin, count));
+		IndexMatrix indices_(k, count);
+		Matrix dist_(k, count);
+		knn->knn(query, indices_, dist_, Index(k));
+		indices.middleCols(begin, count) = indices_;
+		dist.middleCols(begin, count) = dist_;
+	});
+}
+
+template <typename T>
+template <typename F>
+void TensorVoting<T>::accumulateVotes(const std::size_t nbPts, const F& castVotes)
+{
+	//every chunk owns the tensors of a range of points, and keeps its votes for the other ranges until the end of the round,
+	//so that the memory depends on the number of voters per round instead of the number of points
+	const std::size_t votersPerRound = 1024;
+	const std::size_t nbChunks = std::min<std::size_t>(PointMatcherSupport::getThreadCount(nbThreads), nbPts);
+	if(nbChunks == 0) return;
+	
+	std::vector<std::size_t> chunkBegins(nbChunks + 1);
+	std::size_t maxChunkSize = 0;
+	for(std::size_t chunk = 0; chunk <= nbChunks; ++chunk)
+	{
+		chunkBegins[chunk] = (nbPts * chunk) / nbChunks; //same ranges as parallelFor
+		if(chunk > 0) maxChunkSize = std::max(maxChunkSize, chunkBegins[chunk] - chunkBegins[chunk - 1]);
+	}
+	
+	//outgoing[source][target]: votes cast by the voters of source for the points of target
+	std::vector<std::vector<VoteList>> outgoing(nbChunks, std::vector<VoteList>(nbChunks));
+	
+	for(std::size_t round = 0; round < maxChunkSize; round += votersPerRound)
+	{
+		PointMatcherSupport::parallelFor(nbChunks, nbChunks, [&](const std::size_t chunk, const std::size_t, const unsigned)
+		{
+			Votes votes{tensors, chunkBegins, chunk, outgoing[chunk]};
+			const std::size_t end = std::min(chunkBegins[chunk + 1], chunkBegins[chunk] + round + votersPerRound);
+			for(std::size_t voter = chunkBegins[chunk] + round; voter < end; ++voter)
+				castVotes(voter, votes);
+		});
+		
+		if(nbChunks == 1) continue;
+		
+		//add the kept votes in a fixed order, so that the result only depends on the number of threads
+		PointMatcherSupport::parallelFor(nbChunks, nbChunks, [&](const std::size_t chunk, const std::size_t, const unsigned)
+		{
+			for(std::vector<VoteList>& sourceVotes : outgoing)
+			{
+				for(const std::pair<Index, Tensor>& vote : sourceVotes[chunk])
+					tensors(vote.first) += vote.second;
+				sourceVotes[chunk].clear();
+			}
+		});
+	}
+}
+
+template <typename T>
+void TensorVoting<T>::Votes::add(const Index votee, const Tensor& vote)
+{
+	const std::size_t i = votee;
+	if(i >= chunkBegins[chunk] and i < chunkBegins[chunk + 1])
+		tensors(votee) += vote;
+	else
+	{
+		const std::size_t owner = std::upper_bound(chunkBegins.begin(), chunkBegins.end(), i) - chunkBegins.begin() - 1;
+		outgoing[owner].emplace_back(votee, vote);
+	}
 }
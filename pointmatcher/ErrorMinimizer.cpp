@@ -35,6 +35,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "Functions.h"
+#include "StageTimer.h"
 
 ///////////////////////////////////////
 // ErrorElements
@@ -54,142 +56,210 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements():
 {
 }
 
-//! Constructor from existing data. This will align the data.
+//! Minimum number of points per thread when selecting the kept associations and gathering their points
+static const std::size_t errorElementsMinPointsPerThread(1 << 14);
+
+//! Select the associations that have a valid match and a non-zero weight, in the order of the reading points
+/*!
+	The reading points are split in chunks processed in parallel. A first
+	pass counts the kept associations of every chunk, a prefix sum of these
+	counts gives the position of the first association of every chunk, and a
+	second pass writes the associations from there. With a single match per
+	point, all of them kept, the matches and weights are copied as a whole
+	instead.
+*/
 template<typename T>
-PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches)
+PointMatcher<T>::ErrorMinimizer::KeptMatches::KeptMatches(const OutlierWeights& outlierWeights, const Matches& matches)
 {
 	typedef typename Matches::Ids Ids;
 	typedef typename Matches::Dists Dists;
 	
 	assert(matches.ids.rows() > 0);
 	assert(matches.ids.cols() > 0);
-	assert(matches.ids.cols() == requestedPts.features.cols()); //nbpts
 	assert(outlierWeights.rows() == matches.ids.rows());  // knn
 	
+	//! Kept and rejected associations of a chunk of reading points
+	struct ChunkCounts
+	{
+		int keptMatches;
+		int rejectedMatches;
+		int rejectedPoints;
+		T weightSum;
+		
+		ChunkCounts(): keptMatches(0), rejectedMatches(0), rejectedPoints(0), weightSum(0) {}
+	};
+	
 	const int knn = outlierWeights.rows();
-	const int dimFeat = requestedPts.features.rows();
-	const int dimReqDesc = requestedPts.descriptors.rows();
-	const int dimReqTime = requestedPts.times.rows();
-
-	// Count points with no weights
-	const int pointsCount = (outlierWeights.array() != 0.0).count();
+	const int readingPointsCount = matches.ids.cols();
+	const unsigned nbThreads(PointMatcherSupport::getThreadCountForSize(readingPointsCount, errorElementsMinPointsPerThread));
+	
+	// Count the associations of every chunk
+	std::vector<ChunkCounts> chunkCounts(nbThreads);
+	PointMatcherSupport::parallelFor(readingPointsCount, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned chunk)
+	{
+		ChunkCounts& counts(chunkCounts[chunk]);
+		for (int i = int(begin); i < int(end); ++i) //nb pts
+		{
+			bool matchExist = false;
+			for(int k = 0; k < knn; k++) // knn
+			{
+				if (matches.dists(k, i) == Matches::InvalidDist)
+					continue;
+				
+				if (outlierWeights(k, i) != 0.0)
+				{
+					++counts.keptMatches;
+					counts.weightSum += outlierWeights(k, i);
+					matchExist = true;
+				}
+				else
+				{
+					++counts.rejectedMatches;
+				}
+			}
+			
+			if(matchExist == false)
+				++counts.rejectedPoints;
+		}
+	});
+	
+	// Prefix sum of the counts, giving where the associations of every chunk start
+	std::vector<int> chunkOffsets(nbThreads + 1, 0);
+	this->nbRejectedMatches = 0;
+	this->nbRejectedPoints = 0;
+	this->weightedPointUsedRatio = 0;
+	for (unsigned chunk = 0; chunk < nbThreads; ++chunk)
+	{
+		chunkOffsets[chunk + 1] = chunkOffsets[chunk] + chunkCounts[chunk].keptMatches;
+		this->nbRejectedMatches += chunkCounts[chunk].rejectedMatches;
+		this->nbRejectedPoints += chunkCounts[chunk].rejectedPoints;
+		this->weightedPointUsedRatio += chunkCounts[chunk].weightSum;
+	}
+	
+	const int pointsCount = chunkOffsets[nbThreads];
 	if (pointsCount == 0)
 		throw ConvergenceError("ErrorMnimizer: no point to minimize");
-
-	Matrix keptFeat(dimFeat, pointsCount);
 	
-	Matrix keptDesc;
-	if(dimReqDesc > 0)
-		keptDesc = Matrix(dimReqDesc, pointsCount);
+	this->pointUsedRatio = T(pointsCount)/T(knn*readingPointsCount);
+	this->weightedPointUsedRatio /= T(knn*readingPointsCount);
 	
-	Int64Matrix keptTime;
-	if(dimReqTime > 0)
-		keptTime = Int64Matrix(dimReqTime, pointsCount);
-	
-	Matches keptMatches (Dists(1,pointsCount), Ids(1, pointsCount));
-	OutlierWeights keptWeights(1, pointsCount);
-
-	int j = 0;
-	int rejectedMatchCount = 0;
-	int rejectedPointCount = 0;
-	bool matchExist = false;
-	this->weightedPointUsedRatio = 0;
+	this->allReadingPointsKept = (knn == 1 && pointsCount == readingPointsCount);
+	if (this->allReadingPointsKept)
+	{
+		this->readingIds = Eigen::Matrix<int, 1, Eigen::Dynamic>::LinSpaced(readingPointsCount, 0, readingPointsCount - 1);
+		this->matches = matches;
+		this->weights = outlierWeights;
+		return;
+	}
 	
-	for (int i = 0; i < requestedPts.features.cols(); ++i) //nb pts
+	// Write the associations of every chunk
+	this->readingIds.resize(1, pointsCount);
+	this->matches = Matches(Dists(1, pointsCount), Ids(1, pointsCount));
+	this->weights.resize(1, pointsCount);
+	PointMatcherSupport::parallelFor(readingPointsCount, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned chunk)
 	{
-		matchExist = false;
-		for(int k = 0; k < knn; k++) // knn
+		int j = chunkOffsets[chunk];
+		for (int i = int(begin); i < int(end); ++i)
 		{
-			const auto matchDist = matches.dists(k, i);
-			if (matchDist == Matches::InvalidDist){
-				continue;
-			}
-
-			if (outlierWeights(k,i) != 0.0)
+			for(int k = 0; k < knn; k++)
 			{
-				if(dimReqDesc > 0)
-					keptDesc.col(j) = requestedPts.descriptors.col(i);
-
-				if(dimReqTime > 0)
-					keptTime.col(j) = requestedPts.times.col(i);
-
-				
-				keptFeat.col(j) = requestedPts.features.col(i);
-				keptMatches.ids(0, j) = matches.ids(k, i);
-				keptMatches.dists(0, j) = matchDist;
-				keptWeights(0,j) = outlierWeights(k,i);
-				++j;
-				this->weightedPointUsedRatio += outlierWeights(k,i);
-				matchExist = true;
+				const T matchDist = matches.dists(k, i);
+				if (matchDist != Matches::InvalidDist && outlierWeights(k, i) != 0.0)
+				{
+					this->readingIds(0, j) = i;
+					this->matches.ids(0, j) = matches.ids(k, i);
+					this->matches.dists(0, j) = matchDist;
+					this->weights(0, j) = outlierWeights(k, i);
+					++j;
+				}
 			}
-			else
-			{
-				rejectedMatchCount++;
-			}
-		}
-
-		if(matchExist == false)
-		{
-			rejectedPointCount++;
 		}
-	}
+		assert(j == chunkOffsets[chunk + 1]);
+	});
+}
 
-	assert(j == pointsCount);
+//! Constructor from existing data. This will align the data.
+template<typename T>
+PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches):
+	ErrorElements(requestedPts, sourcePts, KeptMatches(outlierWeights, matches))
+{
+	assert(matches.ids.cols() == requestedPts.features.cols()); //nbpts
+}
 
-	this->pointUsedRatio = T(j)/T(knn*requestedPts.features.cols());
-	this->weightedPointUsedRatio /= T(knn*requestedPts.features.cols());
-	
-	assert(dimFeat == sourcePts.features.rows());
+//! Constructor from the associations kept by the outlier filters, gathering the matched points in parallel
+/*!
+	The labels are copied once and the points are written directly in the
+	matrices of reading and reference. If all reading points are kept, in
+	order, reading is a plain copy of requestedPts.
+*/
+template<typename T>
+PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const KeptMatches& keptMatches):
+	weights(keptMatches.weights),
+	matches(keptMatches.matches),
+	nbRejectedMatches(keptMatches.nbRejectedMatches),
+	nbRejectedPoints(keptMatches.nbRejectedPoints),
+	pointUsedRatio(keptMatches.pointUsedRatio),
+	weightedPointUsedRatio(keptMatches.weightedPointUsedRatio)
+{
+	const int pointsCount = keptMatches.matches.ids.cols();
+	const int dimFeat = requestedPts.features.rows();
+	const int dimReqDesc = requestedPts.descriptors.rows();
+	const int dimReqTime = requestedPts.times.rows();
 	const int dimSourDesc = sourcePts.descriptors.rows();
 	const int dimSourTime = sourcePts.times.rows();
 	
-	Matrix associatedFeat(dimFeat, pointsCount);
+	assert(dimFeat == sourcePts.features.rows());
+	assert(!keptMatches.allReadingPointsKept || pointsCount == requestedPts.features.cols());
 	
-	Matrix associatedDesc;
-	if(dimSourDesc > 0)
-		associatedDesc = Matrix(dimSourDesc, pointsCount);
+	const bool gatherReading(!keptMatches.allReadingPointsKept);
+	if (gatherReading)
+	{
+		reading.featureLabels = requestedPts.featureLabels;
+		reading.descriptorLabels = requestedPts.descriptorLabels;
+		reading.timeLabels = requestedPts.timeLabels;
+		reading.features.resize(dimFeat, pointsCount);
+		reading.descriptors.resize(dimReqDesc, dimReqDesc > 0 ? pointsCount : 0);
+		reading.times.resize(dimReqTime, dimReqTime > 0 ? pointsCount : 0);
+	}
+	else
+	{
+		reading = requestedPts;
+	}
 	
-	Int64Matrix associatedTime;
-	if(dimSourTime> 0)
-		associatedTime = Int64Matrix(dimSourTime, pointsCount);
+	reference.featureLabels = sourcePts.featureLabels;
+	reference.descriptorLabels = sourcePts.descriptorLabels;
+	reference.timeLabels = sourcePts.timeLabels;
+	reference.features.resize(dimFeat, pointsCount);
+	reference.descriptors.resize(dimSourDesc, dimSourDesc > 0 ? pointsCount : 0);
+	reference.times.resize(dimSourTime, dimSourTime > 0 ? pointsCount : 0);
 	
 	// Fetch matched points
-	for (int i = 0; i < pointsCount; ++i)
+	PointMatcherSupport::parallelFor(pointsCount, PointMatcherSupport::getThreadCountForSize(pointsCount, errorElementsMinPointsPerThread), [&](const std::size_t begin, const std::size_t end, unsigned)
 	{
-		const int refIndex(keptMatches.ids(i));
-		associatedFeat.col(i) = sourcePts.features.block(0, refIndex, dimFeat, 1);
-		
-		if(dimSourDesc > 0)
-			associatedDesc.col(i) = sourcePts.descriptors.block(0, refIndex, dimSourDesc, 1);
-
-		if(dimSourTime> 0)
-			associatedTime.col(i) = sourcePts.times.block(0, refIndex, dimSourTime, 1);
-
-	}
-
-	// Copy final data to structure
-	this->reading = DataPoints(
-		keptFeat, 
-		requestedPts.featureLabels,
-		keptDesc,
-		requestedPts.descriptorLabels,
-		keptTime,
-		requestedPts.timeLabels
-	);
-
-	this->reference = DataPoints(
-		associatedFeat,
-		sourcePts.featureLabels,
-		associatedDesc,
-		sourcePts.descriptorLabels,
-		associatedTime,
-		sourcePts.timeLabels
-	);
-
-	this->weights = keptWeights;
-	this->matches = keptMatches;
-	this->nbRejectedMatches = rejectedMatchCount;
-	this->nbRejectedPoints = rejectedPointCount;
+		for (int i = int(begin); i < int(end); ++i)
+		{
+			if (gatherReading)
+			{
+				const int readIndex(keptMatches.readingIds(0, i));
+				reading.features.col(i) = requestedPts.features.col(readIndex);
+				
+				if(dimReqDesc > 0)
+					reading.descriptors.col(i) = requestedPts.descriptors.col(readIndex);
+				
+				if(dimReqTime > 0)
+					reading.times.col(i) = requestedPts.times.col(readIndex);
+			}
+			
+			const int refIndex(keptMatches.matches.ids(0, i));
+			reference.features.col(i) = sourcePts.features.col(refIndex);
+			
+			if(dimSourDesc > 0)
+				reference.descriptors.col(i) = sourcePts.descriptors.col(refIndex);
+			
+			if(dimSourTime > 0)
+				reference.times.col(i) = sourcePts.times.col(refIndex);
+		}
+	});
 }
 
 
@@ -219,10 +289,18 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ErrorMinimiz
 {
 	
 	// generates pairs of matching points
-	typename ErrorMinimizer::ErrorElements matchedPoints(filteredReading, filteredReference, outlierWeights, matches);
+	typename ErrorMinimizer::ErrorElements matchedPoints;
+	{
+		const StageTimer<T> timer("ErrorElements", matches.ids.cols());
+		matchedPoints = ErrorElements(filteredReading, filteredReference, outlierWeights, matches);
+	}
 	
 	// calls specific instantiation for a given ErrorMinimizer
-	TransformationParameters transform = this->compute(matchedPoints);
+	TransformationParameters transform;
+	{
+		const StageTimer<T> timer("ErrorMinimization", this->className, matchedPoints.reading.features.cols());
+		transform = this->compute(matchedPoints);
+	}
 	
 	// saves paired points for future introspection
 	this->lastErrorElements = matchedPoints;
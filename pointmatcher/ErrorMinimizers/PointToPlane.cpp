@@ -34,12 +34,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <iostream>
+#include <vector>
 
 #include "Eigen/SVD"
 
 #include "ErrorMinimizersImpl.h"
 #include "PointMatcherPrivate.h"
 #include "Functions.h"
+#include "DataPoints3D.h"
 
 using namespace Eigen;
 using namespace std;
@@ -50,6 +52,70 @@ typedef Parametrizable::Parameters Parameters;
 typedef Parametrizable::ParameterDoc ParameterDoc;
 typedef Parametrizable::ParametersDoc ParametersDoc;
 
+namespace
+{
+	//! Minimum number of matches per thread when accumulating the normal equations
+	const std::size_t normalEquationsMinPointsPerThread(1 << 14);
+	
+	//! Normal equations A x = b of a linearized point-to-plane problem with D unknowns
+	template<typename T, int D>
+	struct NormalEquations
+	{
+		typedef Eigen::Matrix<T, D, 1> Vector;
+		typedef Eigen::Matrix<T, D, D> Matrix;
+		
+		Matrix A; //!< sum of w f f^T
+		Vector b; //!< sum of -w f r
+		
+		NormalEquations():
+			A(Matrix::Zero()),
+			b(Vector::Zero())
+		{}
+		
+		//! Add the row f of a match of weight w and residual r
+		void add(const Vector& f, const T w, const T r)
+		{
+			const Vector wf(w * f);
+			A.noalias() += wf * f.transpose();
+			b.noalias() -= wf * r;
+		}
+		
+		void add(const NormalEquations& equations)
+		{
+			A += equations.A;
+			b += equations.b;
+		}
+		
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+	
+	//! Accumulate the normal equations of all matches, linearize(i, f) filling the row f of match i and returning its residual, in chunks processed in parallel and added in order
+	template<typename T, int D, typename F>
+	NormalEquations<T, D> accumulateNormalEquations(const typename PointMatcher<T>::Matrix& weights, const F& linearize)
+	{
+		typedef NormalEquations<T, D> Equations;
+		typedef std::vector<Equations, Eigen::aligned_allocator<Equations>> ChunkEquations;
+		const std::size_t count(weights.cols());
+		const unsigned nbThreads(PointMatcherSupport::getThreadCountForSize(count, normalEquationsMinPointsPerThread));
+		ChunkEquations chunkEquations(nbThreads);
+		PointMatcherSupport::parallelFor(count, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned chunk)
+		{
+			Equations& equations(chunkEquations[chunk]);
+			typename Equations::Vector f;
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const T r(linearize(int(i), f));
+				equations.add(f, weights(0, i), r);
+			}
+		});
+		
+		Equations equations;
+		for (const Equations& chunk: chunkEquations)
+			equations.add(chunk);
+		return equations;
+	}
+}
+
 template<typename T>
 PointToPlaneErrorMinimizer<T>::PointToPlaneErrorMinimizer(const Parameters& params):
 	ErrorMinimizer(name(), availableParameters(), params),
@@ -172,76 +238,80 @@ template<typename T>
 typename PointMatcher<T>::TransformationParameters PointToPlaneErrorMinimizer<T>::compute_in_place(ErrorElements& mPts)
 {
 		const int dim = mPts.reading.features.rows();
-		const int nbPts = mPts.reading.features.cols();
-
-		// Adjust if the user forces 2D minimization on XY-plane
-		int forcedDim = dim - 1;
-		if(force2D && dim == 4)
-		{
-				mPts.reading.features.conservativeResize(3, Eigen::NoChange);
-				mPts.reading.features.row(2) = Matrix::Ones(1, nbPts);
-				mPts.reference.features.conservativeResize(3, Eigen::NoChange);
-				mPts.reference.features.row(2) = Matrix::Ones(1, nbPts);
-				forcedDim = dim - 2;
-		}
-
-		// Fetch normal vectors of the reference point cloud (with adjustment if needed)
-		const BOOST_AUTO(normalRef, mPts.reference.getDescriptorViewByName("normals").topRows(forcedDim));
 
 		// Note: Normal vector must be precalculated to use this error. Use appropriate input filter.
-		assert(normalRef.rows() > 0);
+		if(!mPts.reference.descriptorExists("normals"))
+			throw typename DataPoints::InvalidField("PointToPlaneErrorMinimizer - field normals not found in the reference");
 
-		// Compute cross product of cross = cross(reading X normalRef)
-		Matrix cross;
-		Matrix matrixGamma(3,3);
-		if(!force4DOF)
+		// Accumulate A = sum(w * f * f') and b = -sum(w * f * dot(p - q, n)), with f the row of the linearized
+		// problem of each match, so that no temporary depends on the number of matches
+		Matrix A;
+		Vector b;
+		if(dim == 4 && !force2D)
 		{
-			// Compute cross product of cross = cross(reading X normalRef)
-			cross = this->crossProduct(mPts.reading.features, normalRef);
+			typedef typename DataPoints3D<T>::Vector3 Vector3;
+			if(!DataPoints3D<T>::hasDescriptor3D(mPts.reference, "normals"))
+				throw typename DataPoints::InvalidField("PointToPlaneErrorMinimizer - the normals of the reference must have 3 rows with 3D clouds");
+			const typename DataPoints3D<T>::ConstColumns readingPoints(DataPoints3D<T>::points(mPts.reading));
+			const typename DataPoints3D<T>::ConstColumns referencePoints(DataPoints3D<T>::points(mPts.reference));
+			const typename DataPoints3D<T>::ConstColumns normals(DataPoints3D<T>::descriptor(mPts.reference, "normals"));
+
+			if(!force4DOF)
+			{
+				// f = [p x n; n], x = [alpha, beta, gamma, x, y, z]
+				typedef NormalEquations<T, 6> Equations;
+				const Equations equations(accumulateNormalEquations<T, 6>(mPts.weights, [&](const int i, typename Equations::Vector& f) -> T
+				{
+					const Vector3 p(readingPoints[i]);
+					const Vector3 n(normals[i]);
+					f.template head<3>() = p.cross(n);
+					f.template tail<3>() = n;
+					return n.dot(p - referencePoints[i]);
+				}));
+				A = equations.A;
+				b = equations.b;
+			}
+			else
+			{
+				//VK: Instead for "cross" as in 3D, we need only a dot product with the matrixGamma factor for 4DOF
+				//VK: This should be published in 2020 or 2021
+				// f = [(gamma * p) . n; n], with gamma the derivative of the rotation around z, x = [gamma, x, y, z]
+				typedef NormalEquations<T, 4> Equations;
+				const Equations equations(accumulateNormalEquations<T, 4>(mPts.weights, [&](const int i, typename Equations::Vector& f) -> T
+				{
+					const Vector3 p(readingPoints[i]);
+					const Vector3 n(normals[i]);
+					f(0) = p(0) * n(1) - p(1) * n(0);
+					f.template tail<3>() = n;
+					return n.dot(p - referencePoints[i]);
+				}));
+				A = equations.A;
+				b = equations.b;
+			}
 		}
 		else
 		{
-		   	//VK: Instead for "cross" as in 3D, we need only a dot product with the matrixGamma factor for 4DOF
-		   	//VK: This should be published in 2020 or 2021
-			matrixGamma << 0,-1, 0,
-			         1, 0, 0,
-			         0, 0, 0;
-			cross = ((matrixGamma*mPts.reading.features).transpose()*normalRef).diagonal().transpose();
-		}
-
-
-		// wF = [weights*cross, weights*normals]
-		// F  = [cross, normals]
-		Matrix wF(normalRef.rows()+ cross.rows(), normalRef.cols());
-		Matrix F(normalRef.rows()+ cross.rows(), normalRef.cols());
-
-		for(int i=0; i < cross.rows(); i++)
-		{
-				wF.row(i) = mPts.weights.array() * cross.row(i).array();
-				F.row(i) = cross.row(i);
-		}
-		for(int i=0; i < normalRef.rows(); i++)
-		{
-				wF.row(i + cross.rows()) = mPts.weights.array() * normalRef.row(i).array();
-				F.row(i + cross.rows()) = normalRef.row(i);
-		}
-
-		// Unadjust covariance A = wF * F'
-		const Matrix A = wF * F.transpose();
-
-		const Matrix deltas = mPts.reading.features - mPts.reference.features;
-
-		// dot product of dot = dot(deltas, normals)
-		Matrix dotProd = Matrix::Zero(1, normalRef.cols());
-
-		for(int i=0; i<normalRef.rows(); i++)
-		{
-				dotProd += (deltas.row(i).array() * normalRef.row(i).array()).matrix();
+			// 2D, or 3D inputs with the minimization forced on the XY-plane: only x and y are used
+			// f = [pseudo-cross(p, n); n], x = [theta, x, y]
+			typedef Eigen::Matrix<T, 2, 1> Vector2;
+			const BOOST_AUTO(normalRef, mPts.reference.getDescriptorViewByName("normals"));
+			assert(normalRef.rows() >= 2);
+			const Matrix& readingPoints(mPts.reading.features);
+			const Matrix& referencePoints(mPts.reference.features);
+
+			typedef NormalEquations<T, 3> Equations;
+			const Equations equations(accumulateNormalEquations<T, 3>(mPts.weights, [&](const int i, typename Equations::Vector& f) -> T
+			{
+				const Vector2 p(readingPoints.template block<2, 1>(0, i));
+				const Vector2 n(normalRef.template block<2, 1>(0, i));
+				f(0) = p(0) * n(1) - p(1) * n(0);
+				f.template tail<2>() = n;
+				return n.dot(p - referencePoints.template block<2, 1>(0, i));
+			}));
+			A = equations.A;
+			b = equations.b;
 		}
 
-		// b = -(wF' * dot)
-		const Vector b = -(wF * dotProd.transpose());
-
 		Vector x(A.rows());
 
 		solvePossiblyUnderdeterminedLinearSystem<T>(A, b, x);
@@ -35,20 +35,222 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ErrorMinimizersImpl.h"
 #include "PointMatcherPrivate.h"
+#include "Functions.h"
+#include "StageTimer.h"
 #include "Eigen/SVD"
 
+#include <vector>
+#include <typeinfo>
+
 using namespace Eigen;
 
+//! Minimum number of reading points per thread when accumulating the weighted sums
+static const std::size_t weightedSumsMinPointsPerThread(1 << 14);
+
+namespace
+{
+	//! Weighted sums over associations of a reading point p and a reference point q of dimension D, from which the transformation is solved in closed form
+	/*!
+		The sums are accumulated in double precision, so that the weighted
+		means and cross-covariance of large clouds stay accurate in float.
+	*/
+	template<int D>
+	struct WeightedSums
+	{
+		typedef Eigen::Matrix<double, D, 1> Vector;
+		typedef Eigen::Matrix<double, D, D> Matrix;
+		
+		double weightSum; //!< sum of w
+		Vector readingSum; //!< sum of w p
+		Vector referenceSum; //!< sum of w q
+		Matrix crossSum; //!< sum of w q p^T
+		int keptMatches; //!< number of associations added
+		int rejectedMatches; //!< number of valid associations with a zero weight
+		int rejectedPoints; //!< number of reading points without any association added
+		
+		WeightedSums(const int dim):
+			weightSum(0),
+			readingSum(Vector::Zero(dim)),
+			referenceSum(Vector::Zero(dim)),
+			crossSum(Matrix::Zero(dim, dim)),
+			keptMatches(0),
+			rejectedMatches(0),
+			rejectedPoints(0)
+		{}
+		
+		template<typename P, typename Q>
+		void add(const P& p, const Q& q, const double w)
+		{
+			const Vector wp(w * p.template cast<double>());
+			const Vector dq(q.template cast<double>());
+			weightSum += w;
+			readingSum += wp;
+			referenceSum += w * dq;
+			crossSum.noalias() += dq * wp.transpose();
+			++keptMatches;
+		}
+		
+		void add(const WeightedSums& sums)
+		{
+			weightSum += sums.weightSum;
+			readingSum += sums.readingSum;
+			referenceSum += sums.referenceSum;
+			crossSum += sums.crossSum;
+			keptMatches += sums.keptMatches;
+			rejectedMatches += sums.rejectedMatches;
+			rejectedPoints += sums.rejectedPoints;
+		}
+		
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+	
+	//! Accumulate the sums of count items split in chunks processed in parallel by accumulateRange(begin, end, sums), and add the chunks in order
+	template<int D, typename F>
+	WeightedSums<D> reduceWeightedSums(const int dim, const int count, const F& accumulateRange)
+	{
+		typedef std::vector<WeightedSums<D>, Eigen::aligned_allocator<WeightedSums<D>>> ChunkSums;
+		const unsigned nbThreads(PointMatcherSupport::getThreadCountForSize(count, weightedSumsMinPointsPerThread));
+		ChunkSums chunkSums(nbThreads, WeightedSums<D>(dim));
+		PointMatcherSupport::parallelFor(count, nbThreads, [&](const std::size_t begin, const std::size_t end, const unsigned chunk)
+		{
+			accumulateRange(int(begin), int(end), chunkSums[chunk]);
+		});
+		
+		WeightedSums<D> sums(dim);
+		for (const WeightedSums<D>& chunk: chunkSums)
+			sums.add(chunk);
+		return sums;
+	}
+	
+	//! Return the rigid transformation, in homogeneous coordinates, minimizing the weighted squared distances of the associations summed in sums
+	template<typename T, int D>
+	typename PointMatcher<T>::TransformationParameters solveWeightedSums(const WeightedSums<D>& sums)
+	{
+		typedef typename WeightedSums<D>::Vector Vector;
+		typedef typename WeightedSums<D>::Matrix Matrix;
+		const int dim(sums.readingSum.rows());
+		
+		const Vector meanReading(sums.readingSum / sums.weightSum);
+		const Vector meanReference(sums.referenceSum / sums.weightSum);
+		
+		// Singular Value Decomposition of the weighted cross-covariance of the centered points
+		const Matrix m(sums.crossSum - sums.weightSum * meanReference * meanReading.transpose());
+		const JacobiSVD<Matrix> svd(m, ComputeFullU | ComputeFullV);
+		Matrix rotMatrix(svd.matrixU() * svd.matrixV().transpose());
+		// It is possible to get a reflection instead of a rotation. In this case, we
+		// take the second best solution, guaranteed to be a rotation. For more details,
+		// read the tech report: "Least-Squares Rigid Motion Using SVD", Olga Sorkine
+		// http://igl.ethz.ch/projects/ARAP/svd_rot.pdf
+		if (rotMatrix.determinant() < 0.)
+		{
+			Matrix tmpV = svd.matrixV().transpose();
+			tmpV.row(dim-1) *= -1.;
+			rotMatrix = svd.matrixU() * tmpV;
+		}
+		const Vector trVector(meanReference - rotMatrix * meanReading);
+		
+		typename PointMatcher<T>::TransformationParameters result(PointMatcher<T>::Matrix::Identity(dim+1, dim+1));
+		result.topLeftCorner(dim, dim) = rotMatrix.template cast<T>();
+		result.topRightCorner(dim, 1) = trVector.template cast<T>();
+		return result;
+	}
+}
+
 template<typename T>
-PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer() :
-PointMatcher<T>::ErrorMinimizer("PointToPointErrorMinimizer",
-																ParametersDoc(),
-																Parameters()) {}
+PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer(const Parameters& params):
+	ErrorMinimizer("PointToPointErrorMinimizer", availableParameters(), params),
+	keepErrorElements(Parametrizable::get<bool>("keepErrorElements"))
+{
+}
 
+//! Constructor for derived minimizers, which always gather the paired points to solve them with compute(const ErrorElements&)
 template<typename T>
 PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params):
-	ErrorMinimizer(className, paramsDoc, params)
+	ErrorMinimizer(className, paramsDoc, params),
+	keepErrorElements(false)
+{
+}
+
+//! Find the transformation from the weighted sums of the matched points, without gathering them in ErrorElements
+/*!
+	Only the ratios of used points are kept in lastErrorElements, not the
+	paired points. If keepErrorElements is set or if the reading has a
+	simpleSensorNoise descriptor, the paired points are gathered as by the
+	other minimizers, as getErrorElements() and getOverlap() need them.
+	They are also gathered for derived minimizers, whose compute(const ErrorElements&)
+	would otherwise be bypassed.
+*/
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches)
+{
+	if (keepErrorElements || filteredReading.descriptorExists("simpleSensorNoise") || typeid(*this) != typeid(PointToPointErrorMinimizer))
+		return ErrorMinimizer::compute(filteredReading, filteredReference, outlierWeights, matches);
+	
+	const StageTimer<T> timer("ErrorMinimization", this->className, matches.ids.cols());
+	switch (filteredReading.features.rows())
+	{
+		case 4: return computeFromMatches<3>(filteredReading, filteredReference, outlierWeights, matches);
+		case 3: return computeFromMatches<2>(filteredReading, filteredReference, outlierWeights, matches);
+		default: return computeFromMatches<Eigen::Dynamic>(filteredReading, filteredReference, outlierWeights, matches);
+	}
+}
+
+//! Accumulate the weighted sums over the associations kept by the outlier filters, in parallel, and solve the transformation from them
+template<typename T>
+template<int D>
+typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::computeFromMatches(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches)
 {
+	assert(matches.ids.rows() > 0);
+	assert(outlierWeights.rows() == matches.ids.rows());
+	
+	const int dim(filteredReading.features.rows() - 1);
+	const int knn(outlierWeights.rows());
+	const int readingPointsCount(matches.ids.cols());
+	const Matrix& readingFeatures(filteredReading.features);
+	const Matrix& referenceFeatures(filteredReference.features);
+	
+	const WeightedSums<D> sums(reduceWeightedSums<D>(dim, readingPointsCount, [&](const int begin, const int end, WeightedSums<D>& chunkSums)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			bool matchExist = false;
+			for (int k = 0; k < knn; ++k)
+			{
+				if (matches.dists(k, i) == Matches::InvalidDist)
+					continue;
+				
+				const T w(outlierWeights(k, i));
+				if (w != 0)
+				{
+					chunkSums.add(
+						readingFeatures.template block<D, 1>(0, i, dim, 1),
+						referenceFeatures.template block<D, 1>(0, matches.ids(k, i), dim, 1),
+						w
+					);
+					matchExist = true;
+				}
+				else
+				{
+					++chunkSums.rejectedMatches;
+				}
+			}
+			if (!matchExist)
+				++chunkSums.rejectedPoints;
+		}
+	}));
+	
+	if (sums.keptMatches == 0)
+		throw typename PointMatcher<T>::ConvergenceError("ErrorMnimizer: no point to minimize");
+	
+	// Keep the same statistics as ErrorElements, without the paired points
+	ErrorElements& lastElements(this->lastErrorElements);
+	lastElements = ErrorElements();
+	lastElements.nbRejectedMatches = sums.rejectedMatches;
+	lastElements.nbRejectedPoints = sums.rejectedPoints;
+	lastElements.pointUsedRatio = T(sums.keptMatches)/T(knn*readingPointsCount);
+	lastElements.weightedPointUsedRatio = T(sums.weightSum/(knn*readingPointsCount));
+	
+	return solveWeightedSums<T, D>(sums);
 }
 
 template<typename T>
@@ -58,46 +260,42 @@ typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>
 	return compute_in_place(mPts);
 }
 
+//! Find the transformation from already paired points, and remove their weighted mean from mPts
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::compute_in_place(ErrorElements& mPts) {
+	switch (mPts.reading.features.rows())
+	{
+		case 4: return computeFromErrorElements<3>(mPts);
+		case 3: return computeFromErrorElements<2>(mPts);
+		default: return computeFromErrorElements<Eigen::Dynamic>(mPts);
+	}
+}
+
+template<typename T>
+template<int D>
+typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::computeFromErrorElements(ErrorElements& mPts)
+{
 	const int dimCount(mPts.reading.features.rows());
+	const int dim(dimCount - 1);
 	//const int ptsCount(mPts.reading.features.cols()); //Both point clouds have now the same number of (matched) point
 	
-	
-	const Vector w = mPts.weights.row(0);
-	const T w_sum_inv = T(1.)/w.sum();
-	const Vector meanReading =
-		(mPts.reading.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
-	const Vector meanReference =
-		(mPts.reference.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
-	
-	
-	// Remove the mean from the point clouds
-	mPts.reading.features.topRows(dimCount-1).colwise() -= meanReading;
-	mPts.reference.features.topRows(dimCount-1).colwise() -= meanReference;
-	
-	// Singular Value Decomposition
-	const Matrix m(mPts.reference.features.topRows(dimCount-1) * w.asDiagonal()
-		       * mPts.reading.features.topRows(dimCount-1).transpose());
-	const JacobiSVD<Matrix> svd(m, ComputeThinU | ComputeThinV);
-	Matrix rotMatrix(svd.matrixU() * svd.matrixV().transpose());
-	// It is possible to get a reflection instead of a rotation. In this case, we
-	// take the second best solution, guaranteed to be a rotation. For more details,
-	// read the tech report: "Least-Squares Rigid Motion Using SVD", Olga Sorkine
-	// http://igl.ethz.ch/projects/ARAP/svd_rot.pdf
-	if (rotMatrix.determinant() < 0.)
+	const WeightedSums<D> sums(reduceWeightedSums<D>(dim, mPts.reading.features.cols(), [&](const int begin, const int end, WeightedSums<D>& chunkSums)
 	{
-		Matrix tmpV = svd.matrixV().transpose();
-		tmpV.row(dimCount-2) *= -1.;
-		rotMatrix = svd.matrixU() * tmpV;
-	}
-	const Vector trVector(meanReference - rotMatrix * meanReading);
+		for (int i = begin; i < end; ++i)
+			chunkSums.add(
+				mPts.reading.features.template block<D, 1>(0, i, dim, 1),
+				mPts.reference.features.template block<D, 1>(0, i, dim, 1),
+				mPts.weights(0, i)
+			);
+	}));
 	
-	Matrix result(Matrix::Identity(dimCount, dimCount));
-	result.topLeftCorner(dimCount-1, dimCount-1) = rotMatrix;
-	result.topRightCorner(dimCount-1, 1) = trVector;
+	// Remove the mean from the point clouds
+	const Vector meanReading((sums.readingSum / sums.weightSum).template cast<T>());
+	const Vector meanReference((sums.referenceSum / sums.weightSum).template cast<T>());
+	mPts.reading.features.topRows(dim).colwise() -= meanReading;
+	mPts.reference.features.topRows(dim).colwise() -= meanReference;
 	
-	return result;
+	return solveWeightedSums<T, D>(sums);
 }
 
 template<typename T>
@@ -123,11 +321,12 @@ T PointToPointErrorMinimizer<T>::getOverlap() const
 	// of the true overlap.
 	const int nbPoints = this->lastErrorElements.reading.features.cols();
 	const int dim = this->lastErrorElements.reading.features.rows();
-	if(nbPoints == 0)
+	if(this->lastErrorElements.pointUsedRatio < 0)
 	{
 		throw std::runtime_error("Error, last error element empty. Error minimizer needs to be called at least once before using this method.");
 	}
 	
+	// The paired points are only kept when the reading has sensor noises
 	if (!this->lastErrorElements.reading.descriptorExists("simpleSensorNoise"))
 	{
 		LOG_INFO_STREAM("PointToPointErrorMinimizer - warning, no sensor noise found. Using best estimate given outlier rejection instead.");
@@ -42,6 +42,7 @@ template<typename T>
 struct PointToPointErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 {
 	typedef PointMatcherSupport::Parametrizable Parametrizable;
+	typedef PointMatcherSupport::Parametrizable P;
 	typedef Parametrizable::Parameters Parameters;
 	typedef Parametrizable::ParametersDoc ParametersDoc;
 	
@@ -59,15 +60,30 @@ struct PointToPointErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 		return "Point-to-point error. Based on SVD decomposition. Per \\cite{Besl1992Point2Point}.";
 	}
 	
+	inline static const ParametersDoc availableParameters()
+	{
+		return {
+			{"keepErrorElements", "If set to true(1), the paired points are gathered at every iteration and kept in the error elements returned by getErrorElements(). If set to false(0), the transformation is solved from weighted sums over the matches, and the error elements only hold the ratios of used points and the numbers of rejected matches and points.", "0", "0", "1", &P::Comp<bool>}
+		};
+	}
 	
-	PointToPointErrorMinimizer();
+	const bool keepErrorElements;
+	
+	PointToPointErrorMinimizer(const Parameters& params = Parameters());
 	PointToPointErrorMinimizer(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
+	virtual TransformationParameters compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
 	virtual TransformationParameters compute(const ErrorElements& mPts);
 	TransformationParameters compute_in_place(ErrorElements& mPts);
 	virtual T getResidualError(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches) const;
 	virtual T getOverlap() const;
 	
 	static T computeResidualError(const ErrorElements& mPts);
+	
+private:
+	template<int D>
+	TransformationParameters computeFromMatches(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
+	template<int D>
+	static TransformationParameters computeFromErrorElements(ErrorElements& mPts);
 };
 
 #endif //LIBPOINTMATCHER_POINTTOPOINT_H
@@ -46,6 +46,13 @@ PointToPointWithCovErrorMinimizer<T>::PointToPointWithCovErrorMinimizer(const Pa
 {
 }
 
+//! Gather the paired points in ErrorElements, as the covariance is estimated from them
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointToPointWithCovErrorMinimizer<T>::compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches)
+{
+	return ErrorMinimizer::compute(filteredReading, filteredReference, outlierWeights, matches);
+}
+
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointToPointWithCovErrorMinimizer<T>::compute(const ErrorElements& mPts_const)
 {
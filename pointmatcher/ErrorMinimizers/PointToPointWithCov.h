@@ -72,6 +72,7 @@ struct PointToPointWithCovErrorMinimizer: public PointToPointErrorMinimizer<T>
 	Matrix covMatrix;
 	
 	PointToPointWithCovErrorMinimizer(const Parameters& params = Parameters());
+	virtual TransformationParameters compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
 	virtual TransformationParameters compute(const ErrorElements& mPts);
 	virtual Matrix getCovariance() const;
 	Matrix estimateCovariance(const ErrorElements& mPts, const TransformationParameters& transformation);
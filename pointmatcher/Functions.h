@@ -37,6 +37,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __POINTMATCHER_FUNCTIONS_H
 
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
 
 namespace PointMatcherSupport
 {
@@ -59,7 +64,77 @@ namespace PointMatcherSupport
 		return v;
 	}
 
+	//! Return the number of threads to use for a requested count, 0 meaning as many as hardware threads
+	static inline unsigned getThreadCount(const unsigned nbThreads)
+	{
+		if (nbThreads != 0)
+			return nbThreads;
+		return std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	//! Return the number of threads to use for count items when each thread should get at least minCountPerThread of them, as many as hardware threads at most
+	static inline unsigned getThreadCountForSize(const std::size_t count, const std::size_t minCountPerThread)
+	{
+		return unsigned(std::max<std::size_t>(1, std::min<std::size_t>(getThreadCount(0), count / minCountPerThread)));
+	}
 
+	//! Split [0, count) into at most getThreadCount(nbThreads) contiguous chunks and call f(begin, end, chunk) on each, in parallel
+	/**
+		The chunk index is smaller than getThreadCount(nbThreads), so it can be used to address
+		per-thread storage. The first chunk is processed by the calling thread, and exceptions
+		thrown by f are forwarded to the caller.
+	*/
+	template<typename F>
+	static inline void parallelFor(const std::size_t count, const unsigned nbThreads, const F& f)
+	{
+		const std::size_t chunkCount(std::min<std::size_t>(getThreadCount(nbThreads), count));
+		if (chunkCount <= 1)
+		{
+			if (count > 0)
+				f(std::size_t(0), count, 0u);
+			return;
+		}
+		
+		std::vector<std::future<void>> futures;
+		futures.reserve(chunkCount - 1);
+		for (std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+		{
+			const std::size_t begin((count * chunk) / chunkCount);
+			const std::size_t end((count * (chunk + 1)) / chunkCount);
+			futures.push_back(std::async(std::launch::async, [&f, begin, end, chunk](){ f(begin, end, unsigned(chunk)); }));
+		}
+		f(std::size_t(0), count / chunkCount, 0u);
+		
+		for(auto& future : futures) future.get();
+	}
+
+	//! Call f(index, thread) for every index of [0, count) on getThreadCount(nbThreads) threads, each taking the next index when it is done with the previous one
+	/**
+		Unlike parallelFor, the work is not split beforehand, so that threads that get short tasks
+		take more of them; this suits tasks whose durations vary a lot. Indices are taken in
+		increasing order. The thread index is smaller than getThreadCount(nbThreads), the calling
+		thread being thread 0. Exceptions thrown by f stop the distribution of indices and are
+		forwarded to the caller.
+	*/
+	template<typename F>
+	static inline void parallelForEach(const std::size_t count, const unsigned nbThreads, const F& f)
+	{
+		std::atomic<std::size_t> next(0);
+		parallelFor(std::min<std::size_t>(getThreadCount(nbThreads), count), nbThreads, [&](std::size_t, std::size_t, unsigned thread)
+		{
+			try
+			{
+				for (std::size_t index = next++; index < count; index = next++)
+					f(index, thread);
+			}
+			catch (...)
+			{
+				// let the other threads stop after their current index
+				next = count;
+				throw;
+			}
+		});
+	}
 
 } // PointMatcherSupport
 
@@ -36,6 +36,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
 #include "Timer.h"
+#include "StageTimer.h"
 
 #include "LoggerImpl.h"
 #include "TransformationsImpl.h"
@@ -60,6 +61,12 @@ InvalidModuleType::InvalidModuleType(const std::string& reason):
 	runtime_error(reason)
 {}
 
+//! Construct a coarse level without filters
+template<typename T>
+PointMatcher<T>::ICPChainBase::PyramidLevel::PyramidLevel():
+	maxIterationCount(10)
+{}
+
 //! Protected contstructor, to prevent the creation of this object
 template<typename T>
 PointMatcher<T>::ICPChainBase::ICPChainBase():
@@ -87,6 +94,55 @@ void PointMatcher<T>::ICPChainBase::cleanup()
 	errorMinimizer.reset();
 	transformationCheckers.clear();
 	inspector.reset();
+	pyramidLevels.clear();
+}
+
+//! Return new instances of modules, created by registrar from their names and parameters
+template<typename R, typename Modules>
+static Modules cloneModules(const R& registrar, const Modules& modules)
+{
+	Modules clones;
+	for (const auto& module: modules)
+		clones.push_back(registrar.create(module->className, module->parameters));
+	return clones;
+}
+
+//! Set the modules of chain to new instances of the modules of this one, created from their names and parameters, except the transformations and the inspector
+/*!
+	The modules of chain thus have the configuration of these ones, but
+	not the state they keep between calls or iterations. They must all be
+	registered in PointMatcher.
+*/
+template<typename T>
+void PointMatcher<T>::ICPChainBase::cloneModulesInto(ICPChainBase& chain) const
+{
+	const PointMatcher & pm = PointMatcher::get();
+	
+	chain.cleanup();
+	// Transformations are constant, so they can be shared
+	chain.transformations = transformations;
+	chain.readingDataPointsFilters = cloneModules(pm.REG(DataPointsFilter), readingDataPointsFilters);
+	chain.readingDataPointsFilters.fusePredicates = readingDataPointsFilters.fusePredicates;
+	chain.readingStepDataPointsFilters = cloneModules(pm.REG(DataPointsFilter), readingStepDataPointsFilters);
+	chain.readingStepDataPointsFilters.fusePredicates = readingStepDataPointsFilters.fusePredicates;
+	chain.referenceDataPointsFilters = cloneModules(pm.REG(DataPointsFilter), referenceDataPointsFilters);
+	chain.referenceDataPointsFilters.fusePredicates = referenceDataPointsFilters.fusePredicates;
+	if (matcher)
+		chain.matcher = pm.REG(Matcher).create(matcher->className, matcher->parameters);
+	chain.outlierFilters = cloneModules(pm.REG(OutlierFilter), outlierFilters);
+	if (errorMinimizer)
+		chain.errorMinimizer = pm.REG(ErrorMinimizer).create(errorMinimizer->className, errorMinimizer->parameters);
+	chain.transformationCheckers = cloneModules(pm.REG(TransformationChecker), transformationCheckers);
+	for (const PyramidLevel& level: pyramidLevels)
+	{
+		PyramidLevel clone;
+		clone.readingDataPointsFilters = cloneModules(pm.REG(DataPointsFilter), level.readingDataPointsFilters);
+		clone.readingDataPointsFilters.fusePredicates = level.readingDataPointsFilters.fusePredicates;
+		clone.referenceDataPointsFilters = cloneModules(pm.REG(DataPointsFilter), level.referenceDataPointsFilters);
+		clone.referenceDataPointsFilters.fusePredicates = level.referenceDataPointsFilters.fusePredicates;
+		clone.maxIterationCount = level.maxIterationCount;
+		chain.pyramidLevels.push_back(clone);
+	}
 }
 
 //! Hook to load addition subclass-specific content from the YAML file
@@ -149,6 +205,7 @@ void PointMatcher<T>::ICPChainBase::loadFromYaml(std::istream& in)
 	
 	usedModuleTypes.insert(createModulesFromRegistrar("transformationCheckers", doc, pm.REG(TransformationChecker), transformationCheckers));
 	usedModuleTypes.insert(createModuleFromRegistrar("inspector", doc, pm.REG(Inspector),inspector));
+	usedModuleTypes.insert(createPyramidLevelsFromYAML("pyramid", doc));
 	
 	
 	// FIXME: this line cause segfault when there is an error in the yaml file...
@@ -221,6 +278,48 @@ const std::string& PointMatcher<T>::ICPChainBase::createModuleFromRegistrar(cons
 	return regName;
 }
 
+//! Instantiate the coarse levels if they are in the YAML file
+/*!
+	The YAML entry is a list of levels, from the coarsest to the finest.
+	Every level may contain readingDataPointsFilters and
+	referenceDataPointsFilters, applied after the filters of the chain, as
+	well as maxIterationCount.
+*/
+template<typename T>
+const std::string& PointMatcher<T>::ICPChainBase::createPyramidLevelsFromYAML(const std::string& regName, const YAML::Node& doc)
+{
+	const YAML::Node *reg = doc.FindValue(regName);
+	if (reg)
+	{
+		const PointMatcher & pm = PointMatcher::get();
+		for(YAML::Iterator levelIt = reg->begin(); levelIt != reg->end(); ++levelIt)
+		{
+			const YAML::Node& levelNode(*levelIt);
+			PyramidLevel level;
+			typedef set<string> StringSet;
+			StringSet usedLevelEntries;
+			usedLevelEntries.insert(createModulesFromRegistrar("readingDataPointsFilters", levelNode, pm.REG(DataPointsFilter), level.readingDataPointsFilters));
+			usedLevelEntries.insert(createModulesFromRegistrar("referenceDataPointsFilters", levelNode, pm.REG(DataPointsFilter), level.referenceDataPointsFilters));
+			usedLevelEntries.insert("maxIterationCount");
+			const YAML::Node *maxIterationCount = levelNode.FindValue("maxIterationCount");
+			if (maxIterationCount)
+				*maxIterationCount >> level.maxIterationCount;
+			
+			for(YAML::Iterator entryIt = levelNode.begin(); entryIt != levelNode.end(); ++entryIt)
+			{
+				string entry;
+				entryIt.first() >> entry;
+				if (usedLevelEntries.find(entry) == usedLevelEntries.end())
+					throw InvalidModuleType(
+						(boost::format("Entry %1% does not exist in a level of %2%") % entry % regName).str()
+					);
+			}
+			pyramidLevels.push_back(level);
+		}
+	}
+	return regName;
+}
+
 template<typename T>
 std::string PointMatcher<T>::ICPChainBase::nodeVal(const std::string& regName, const PointMatcherSupport::YAML::Node& doc)
 {
@@ -277,21 +376,159 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	
 	this->inspector->init();
 	
+	// The reference is indexed by the matcher of the chain
+	PreparedReference prepared;
+	prepared.matcher = this->matcher;
+	filterReference(referenceIn, prepared);
+	this->prefilteredReferencePtsCount = prepared.reference.features.cols();
+	
+	return computeWithTransformedReference(readingIn, prepared.reference, prepared.T_refIn_refMean, T_refIn_dataIn, prepared.levels, prepared.matcher.get());
+	
+}
+
+//! Filter, center and index referenceIn once, so that many readings can be registered against it with compute()
+/*!
+	The returned reference has its own matcher, of the same type and
+	parameters as the one of the chain, so that it stays valid if the chain
+	is used with other references or configured again.
+*/
+template<typename T>
+std::shared_ptr<const typename PointMatcher<T>::ICP::PreparedReference> PointMatcher<T>::ICP::prepareReference(const DataPoints& referenceIn)
+{
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	
+	std::shared_ptr<PreparedReference> prepared(std::make_shared<PreparedReference>());
+	prepared->matcher = PointMatcher<T>::get().REG(Matcher).create(this->matcher->className, this->matcher->parameters);
+	filterReference(referenceIn, *prepared);
+	return prepared;
+}
+
+//! Filter, center and index referenceIn like prepareReference(), without modifying this object
+/*!
+	Several threads can call this function at once on the same object. The
+	reference filters run on new instances of the modules of the chain, and
+	the statistics of the preparation are not reported to the inspector.
+*/
+template<typename T>
+std::shared_ptr<const typename PointMatcher<T>::ICP::PreparedReference> PointMatcher<T>::ICP::prepareReferenceConcurrently(const DataPoints& referenceIn) const
+{
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before running ICP");
+	
+	ICP icp;
+	this->cloneModulesInto(icp);
+	icp.inspector = std::make_shared<typename InspectorsImpl<T>::NullInspector>();
+	return icp.prepareReference(referenceIn);
+}
+
+//! Perform ICP from initial guess against a reference returned by prepareReference() and return optimised transformation matrix
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute(
+	const DataPoints& readingIn,
+	const PreparedReference& reference,
+	const TransformationParameters& T_refIn_dataIn)
+{
+	if (!this->errorMinimizer)
+		throw runtime_error("You must setup an error minimizer before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	if (reference.levels.size() != this->pyramidLevels.size())
+		throw runtime_error("The reference was prepared with a different number of pyramid levels than the chain has");
+	
+	this->inspector->init();
+	
+	this->inspector->addStat("ReferenceInPointCount", reference.referenceInPointCount);
+	this->inspector->addStat("ReferencePointCount", reference.reference.features.cols());
+	this->prefilteredReferencePtsCount = reference.reference.features.cols();
+	
+	return computeWithTransformedReference(readingIn, reference.reference, reference.T_refIn_refMean, T_refIn_dataIn, reference.levels, reference.matcher.get());
+}
+
+//! Inspector keeping the last value of every statistics, used to return them from ICP::computeConcurrently()
+template<typename T>
+struct StatsRecorderInspector: public PointMatcher<T>::Inspector
+{
+	typedef typename PointMatcher<T>::Inspector Inspector;
+	
+	std::map<std::string, double>& stats; //!< statistics by name
+	
+	StatsRecorderInspector(std::map<std::string, double>& stats):
+		Inspector("StatsRecorderInspector", typename Inspector::ParametersDoc(), typename Inspector::Parameters()),
+		stats(stats)
+	{}
+	
+	virtual void addStat(const std::string& name, double data)
+	{
+		stats[name] = data;
+	}
+};
+
+//! Perform ICP from initial guess against a reference returned by prepareReference(), without modifying this object
+/*!
+	Several threads can call this function at once on the same object and
+	the same reference. The registration runs on new instances of the
+	modules of the chain, created from their names and parameters, so that
+	the state they keep between iterations is private to the call. The
+	matchers of reference are shared and must thus allow concurrent
+	queries. Instead of being added to the inspector of the chain, the
+	statistics are returned with the result. PointCountTouched is left out,
+	as the visits of concurrent calls add up in the shared matchers.
+*/
+template<typename T>
+typename PointMatcher<T>::ICP::Result PointMatcher<T>::ICP::computeConcurrently(
+	const DataPoints& readingIn,
+	const PreparedReference& reference,
+	const TransformationParameters& T_refIn_dataIn) const
+{
+	if (!reference.matcher->allowsConcurrentQueries())
+		throw runtime_error((boost::format("%1% does not allow concurrent queries") % reference.matcher->className).str());
+	
+	Result result;
+	
+	ICP icp;
+	this->cloneModulesInto(icp);
+	icp.inspector = std::make_shared<StatsRecorderInspector<T> >(result.stats);
+	
+	result.transformation = icp.compute(readingIn, reference, T_refIn_dataIn);
+	result.readingFiltered = icp.readingFiltered;
+	result.maxNumIterationsReached = icp.maxNumIterationsReached;
+	result.pointUsedRatio = icp.errorMinimizer->getPointUsedRatio();
+	result.weightedPointUsedRatio = icp.errorMinimizer->getWeightedPointUsedRatio();
+	result.stats.erase("PointCountTouched");
+	
+	return result;
+}
+
+//! Apply the reference filters to referenceIn, center the result on its mean, build the coarse levels and index them all with the matchers of prepared
+template<typename T>
+void PointMatcher<T>::ICP::filterReference(const DataPoints& referenceIn, PreparedReference& prepared)
+{
+	const typename StageTimer<T>::Scope timingScope(this->inspector.get());
 	timer t; // Print how long take the algo
 	const int dim(referenceIn.features.rows());
 	
 	// Apply reference filters
 	// reference is express in frame <refIn>
-	DataPoints reference(referenceIn);
+	DataPoints& reference(prepared.reference);
+	reference = referenceIn;
 	this->referenceDataPointsFilters.init();
-	this->referenceDataPointsFilters.apply(reference);
+	{
+		const StageTimer<T> stageTimer("ReferenceDataPointsFilters", referenceIn.features.cols());
+		this->referenceDataPointsFilters.apply(reference);
+	}
 	
 	// Create intermediate frame at the center of mass of reference pts cloud
 	//  this help to solve for rotations
 	const int nbPtsReference = reference.features.cols();
 	const Vector meanReference = reference.features.rowwise().sum() / nbPtsReference;
-	TransformationParameters T_refIn_refMean(Matrix::Identity(dim, dim));
-	T_refIn_refMean.block(0,dim-1, dim-1, 1) = meanReference.head(dim-1);
+	prepared.T_refIn_refMean = Matrix::Identity(dim, dim);
+	prepared.T_refIn_refMean.block(0,dim-1, dim-1, 1) = meanReference.head(dim-1);
+	
+	// Build the coarse levels once, from the filtered reference
+	prepared.levels = createReferenceLevels(reference, meanReference);
 	
 	// Reajust reference position: 
 	// from here reference is express in frame <refMean>
@@ -299,26 +536,61 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	reference.features.topRows(dim-1).colwise() -= meanReference.head(dim-1);
 	
 	// Init matcher with reference points center on its mean
-	this->matcher->init(reference);
+	{
+		const StageTimer<T> stageTimer("MatcherInit", prepared.matcher->className, reference.features.cols());
+		prepared.matcher->init(reference);
+	}
+	prepared.referenceInPointCount = referenceIn.features.cols();
 	
 	// statistics on last step
 	this->inspector->addStat("ReferencePreprocessingDuration", t.elapsed());
 	this->inspector->addStat("ReferenceInPointCount", referenceIn.features.cols());
 	this->inspector->addStat("ReferencePointCount", reference.features.cols());
 	LOG_INFO_STREAM("PointMatcher::icp - reference pre-processing took " << t.elapsed() << " [s]");
-	this->prefilteredReferencePtsCount = reference.features.cols();
-	
-	return computeWithTransformedReference(readingIn, reference, T_refIn_refMean, T_refIn_dataIn);
+}
+
+//! Filter reference, expressed in frame <refIn>, with the filters of every coarse level, and express the results in frame <refMean>
+template<typename T>
+typename PointMatcher<T>::ICP::ReferenceLevels PointMatcher<T>::ICP::createReferenceLevels(const DataPoints& reference, const Vector& meanReference)
+{
+	const int dim(reference.features.rows());
 	
+	ReferenceLevels referenceLevels;
+	referenceLevels.reserve(this->pyramidLevels.size());
+	for (size_t l = 0; l < this->pyramidLevels.size(); ++l)
+	{
+		timer t;
+		
+		// The cloud is shared by the copies of the level, so that it outlives this scope and stays where the matcher indexed it
+		const std::shared_ptr<DataPoints> levelReference(std::make_shared<DataPoints>(reference));
+		this->pyramidLevels[l].referenceDataPointsFilters.init();
+		this->pyramidLevels[l].referenceDataPointsFilters.apply(*levelReference);
+		levelReference->features.topRows(dim-1).colwise() -= meanReference.head(dim-1);
+		
+		ReferenceLevel level;
+		level.reference = levelReference;
+		if (levelReference->features.cols() > 0)
+		{
+			level.matcher = PointMatcher<T>::get().REG(Matcher).create(this->matcher->className, this->matcher->parameters);
+			level.matcher->init(*levelReference);
+		}
+		
+		this->inspector->addStat((boost::format("PyramidLevel%1%ReferencePointCount") % l).str(), levelReference->features.cols());
+		this->inspector->addStat((boost::format("PyramidLevel%1%ReferencePreprocessingDuration") % l).str(), t.elapsed());
+		referenceLevels.push_back(level);
+	}
+	return referenceLevels;
 }
 
-//! Perferm ICP using an already-transformed reference and with an already-initialized matcher
+//! Perferm ICP using an already-transformed reference and with an already-initialized matcher, referenceMatcher or if null the one of the chain
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::computeWithTransformedReference(
 	const DataPoints& readingIn, 
 	const DataPoints& reference, 
 	const TransformationParameters& T_refIn_refMean,
-	const TransformationParameters& T_refIn_dataIn)
+	const TransformationParameters& T_refIn_dataIn,
+	const ReferenceLevels& referenceLevels,
+	Matcher* referenceMatcher)
 {
 	const int dim(reference.features.rows());
 
@@ -330,6 +602,7 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 											  "Where N is the number of rows in the read/reference scans.");
 	}
 
+	const typename StageTimer<T>::Scope timingScope(this->inspector.get());
 	timer t; // Print how long take the algo
 	
 	// Apply readings filters
@@ -337,7 +610,10 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	DataPoints reading(readingIn);
 	//const int nbPtsReading = reading.features.cols();
 	this->readingDataPointsFilters.init();
-	this->readingDataPointsFilters.apply(reading);
+	{
+		const StageTimer<T> stageTimer("ReadingDataPointsFilters", readingIn.features.cols());
+		this->readingDataPointsFilters.apply(reading);
+	}
 	readingFiltered = reading;
 
 	// Reajust reading position: 
@@ -353,10 +629,6 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	// the frame <refMean> is equivalent to the frame <iter(0)>
 	TransformationParameters T_iter = Matrix::Identity(dim, dim);
 	
-	bool iterate(true);
-	this->maxNumIterationsReached = false;
-	this->transformationCheckers.init(T_iter, iterate);
-
 	size_t iterationCount(0);
 	
 	// statistics on last step
@@ -367,24 +639,109 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	this->prefilteredReadingPtsCount = reading.features.cols();
 	t.restart();
 	
-	// iterations
-	while (iterate)
+	// The transformation checkers are initialized once for all levels, so that their bounds apply to the whole registration
+	bool iterate(true);
+	this->transformationCheckers.init(T_iter, iterate);
+	
+	// Coarse levels, each one starting from the transformation found by the previous one
+	for (size_t l = 0; l < referenceLevels.size(); ++l)
 	{
-		DataPoints stepReading(reading);
+		timer levelTimer;
 		
-		//-----------------------------
-		// Apply step filter
-		this->readingStepDataPointsFilters.apply(stepReading);
+		DataPoints levelReading(readingFiltered);
+		this->pyramidLevels[l].readingDataPointsFilters.init();
+		this->pyramidLevels[l].readingDataPointsFilters.apply(levelReading);
+		this->transformations.apply(levelReading, T_refMean_dataIn);
 		
-		//-----------------------------
-		// Transform Readings
-		this->transformations.apply(stepReading, T_iter);
+		const size_t levelFirstIteration(iterationCount);
+		if (levelReading.features.cols() > 0 && referenceLevels[l].matcher)
+		{
+			runIterations(levelReading, *referenceLevels[l].reference, referenceLevels[l].matcher.get(), this->pyramidLevels[l].maxIterationCount, T_iter, iterationCount);
+			referenceLevels[l].matcher->resetVisitCount();
+		}
+		else
+		{
+			LOG_WARNING_STREAM("PointMatcher::icp - skipping pyramid level " << l << " as its filters removed all points");
+		}
+		
+		this->inspector->addStat((boost::format("PyramidLevel%1%ReadingPointCount") % l).str(), levelReading.features.cols());
+		this->inspector->addStat((boost::format("PyramidLevel%1%IterationsCount") % l).str(), iterationCount - levelFirstIteration);
+		this->inspector->addStat((boost::format("PyramidLevel%1%Duration") % l).str(), levelTimer.elapsed());
+	}
+	
+	this->maxNumIterationsReached = runIterations(reading, reference, referenceMatcher, std::numeric_limits<unsigned>::max(), T_iter, iterationCount);
+	
+	Matcher& usedMatcher(referenceMatcher ? *referenceMatcher : *this->matcher);
+	this->inspector->addStat("IterationsCount", iterationCount);
+	this->inspector->addStat("PointCountTouched", usedMatcher.getVisitCount());
+	usedMatcher.resetVisitCount();
+	usedMatcher.addStats(*this->inspector);
+	this->inspector->addStat("OverlapRatio", this->errorMinimizer->getWeightedPointUsedRatio());
+	this->inspector->addStat("ConvergenceDuration", t.elapsed());
+	this->inspector->finish(iterationCount);
+	
+	LOG_INFO_STREAM("PointMatcher::icp - " << iterationCount << " iterations took " << t.elapsed() << " [s]");
+	
+	// Move transformation back to original coordinate (without center of mass)
+	// T_iter is equivalent to: T_iter(i+1)_iter(0)
+	// the frame <iter(0)> equals <refMean>
+	// so we have: 
+	//   T_iter(i+1)_dataIn = T_iter(i+1)_iter(0) * T_refMean_dataIn
+	//   T_iter(i+1)_dataIn = T_iter(i+1)_iter(0) * T_iter(0)_dataIn
+	// T_refIn_refMean remove the temperary frame added during initialization
+	return (T_refIn_refMean * T_iter * T_refMean_dataIn);
+}
+
+//! Iterate from T_iter until the transformation checkers stop, for maxIterationCount iterations at most, and return whether the maximum number of iterations of the checkers was reached
+/*!
+	The transformation checkers must have been initialized by the caller,
+	once per registration. Matching uses levelMatcher, or findClosests()
+	if it is null.
+*/
+template<typename T>
+bool PointMatcher<T>::ICP::runIterations(const DataPoints& reading, const DataPoints& reference, Matcher* levelMatcher, const unsigned maxIterationCount, TransformationParameters& T_iter, size_t& iterationCount)
+{
+	bool iterate(true);
+	bool maxNumIterationsReached(false);
+	
+	// Reading in frame <iter(i)>, kept outside of the loop so that its
+	// memory is reused from one iteration to the next
+	DataPoints stepReading;
+	
+	// iterations
+	unsigned levelIterationCount(0);
+	while (iterate && levelIterationCount < maxIterationCount)
+	{
+		const typename StageTimer<T>::IterationScope iterationScope(iterationCount);
+		
+		if (this->readingStepDataPointsFilters.empty())
+		{
+			//-----------------------------
+			// Transform Readings, without copying them first
+			const StageTimer<T> stageTimer("Transformation", reading.features.cols());
+			this->transformations.apply(reading, stepReading, T_iter);
+		}
+		else
+		{
+			stepReading = reading;
+			
+			//-----------------------------
+			// Apply step filter
+			this->readingStepDataPointsFilters.apply(stepReading);
+			
+			//-----------------------------
+			// Transform Readings
+			const StageTimer<T> stageTimer("Transformation", stepReading.features.cols());
+			this->transformations.apply(stepReading, T_iter);
+		}
 		
 		//-----------------------------
 		// Match to closest point in Reference
-		const Matches matches(
-			this->matcher->findClosests(stepReading)
-		);
+		Matches matches;
+		{
+			const StageTimer<T> stageTimer("Matcher", (levelMatcher ? levelMatcher : this->matcher.get())->className, stepReading.features.cols());
+			matches = levelMatcher ? levelMatcher->findClosests(stepReading) : this->findClosests(stepReading);
+		}
 		
 		//-----------------------------
 		// Detect outliers
@@ -418,34 +775,27 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 		// in test
 		try
 		{
+			const StageTimer<T> stageTimer("TransformationCheckers", stepReading.features.cols());
 			this->transformationCheckers.check(T_iter, iterate);
 		}
 		catch(const typename TransformationCheckersImpl<T>::CounterTransformationChecker::MaxNumIterationsReached &)
 		{
 			iterate = false;
-			this->maxNumIterationsReached = true;
+			maxNumIterationsReached = true;
 		}
 	
 		++iterationCount;
+		++levelIterationCount;
 	}
 	
-	this->inspector->addStat("IterationsCount", iterationCount);
-	this->inspector->addStat("PointCountTouched", this->matcher->getVisitCount());
-	this->matcher->resetVisitCount();
-	this->inspector->addStat("OverlapRatio", this->errorMinimizer->getWeightedPointUsedRatio());
-	this->inspector->addStat("ConvergenceDuration", t.elapsed());
-	this->inspector->finish(iterationCount);
-	
-	LOG_INFO_STREAM("PointMatcher::icp - " << iterationCount << " iterations took " << t.elapsed() << " [s]");
-	
-	// Move transformation back to original coordinate (without center of mass)
-	// T_iter is equivalent to: T_iter(i+1)_iter(0)
-	// the frame <iter(0)> equals <refMean>
-	// so we have: 
-	//   T_iter(i+1)_dataIn = T_iter(i+1)_iter(0) * T_refMean_dataIn
-	//   T_iter(i+1)_dataIn = T_iter(i+1)_iter(0) * T_iter(0)_dataIn
-	// T_refIn_refMean remove the temperary frame added during initialization
-	return (T_refIn_refMean * T_iter * T_refMean_dataIn);
+	return maxNumIterationsReached;
+}
+
+//! Find the closest points of stepReading in the reference, using the matcher
+template<typename T>
+typename PointMatcher<T>::Matches PointMatcher<T>::ICP::findClosests(const DataPoints& stepReading)
+{
+	return this->matcher->findClosests(stepReading);
 }
 
 template struct PointMatcher<float>::ICP;
@@ -456,7 +806,7 @@ template struct PointMatcher<double>::ICP;
 template<typename T>
 bool PointMatcher<T>::ICPSequence::hasMap() const
 {
-	return (mapPointCloud.features.cols() != 0);
+	return (mapPointCloud->features.cols() != 0);
 }
 
 //! Set the map using inputCloud
@@ -482,38 +832,202 @@ bool PointMatcher<T>::ICPSequence::setMap(const DataPoints& inputCloud)
 	
 	this->inspector->addStat("MapPointCount", inputCloud.features.cols());
 	
-	// Set map
-	mapPointCloud = inputCloud;
+	// Set map, in a new cloud as the previous one may still be indexed by a segment
+	mapPointCloud = std::make_shared<DataPoints>(inputCloud);
 
 	// Create intermediate frame at the center of mass of reference pts cloud
 	//  this help to solve for rotations
-	const Vector meanMap = mapPointCloud.features.rowwise().sum() / ptCount;
+	const Vector meanMap = mapPointCloud->features.rowwise().sum() / ptCount;
 	T_refIn_refMean = Matrix::Identity(dim, dim);
 	T_refIn_refMean.block(0,dim-1, dim-1, 1) = meanMap.head(dim-1);
 	
 	// Reajust reference position (only translations): 
 	// from here reference is express in frame <refMean>
 	// Shortcut to do T_refIn_refMean.inverse() * reference
-	mapPointCloud.features.topRows(dim-1).colwise() -= meanMap.head(dim-1);
+	mapPointCloud->features.topRows(dim-1).colwise() -= meanMap.head(dim-1);
 
 	// Apply reference filters
 	this->referenceDataPointsFilters.init();
-	this->referenceDataPointsFilters.apply(mapPointCloud);
+	this->referenceDataPointsFilters.apply(*mapPointCloud);
 	
-	this->matcher->init(mapPointCloud);
+	mapSegments.clear();
+	this->matcher->init(*mapPointCloud);
 	
 	this->inspector->addStat("SetMapDuration", t.elapsed());
 	
 	return true;
 }
 
+//! Add inputCloud, expressed in frame <cloud>, to the map, T_refIn_dataIn being the transformation from <cloud> to the global frame
+/*!
+	The reference filters are applied to the added points only. Instead of
+	indexing the whole map again, the points of the map indexed by the
+	matcher of the chain become the first segment, which keeps this
+	matcher, and the added points get their own matcher. The most recent
+	segments are merged when the older one is less than twice as large as
+	the newer one, but never with the first segment, so that the cost of
+	a merge only depends on the points added since the map was set. There
+	are thus O(log(n)) segments, and every added point is indexed again
+	O(log(n)) times. If there is no map yet, this is equivalent to setMap()
+	with the transformed cloud.
+*/
+template<typename T>
+bool PointMatcher<T>::ICPSequence::addToMap(const DataPoints& inputCloud, const TransformationParameters& T_refIn_dataIn)
+{
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	
+	if (!hasMap())
+	{
+		DataPoints cloud(inputCloud);
+		this->transformations.apply(cloud, T_refIn_dataIn);
+		return setMap(cloud);
+	}
+	
+	timer t; // Print how long take the algo
+	
+	if (inputCloud.features.cols() == 0)
+	{
+		LOG_WARNING_STREAM("Ignoring attempt to add an empty cloud to the map");
+		return false;
+	}
+	
+	// Express the cloud in frame <refMean>
+	DataPoints cloud(inputCloud);
+	const TransformationParameters T_refMean_dataIn = T_refIn_refMean.inverse() * T_refIn_dataIn;
+	this->transformations.apply(cloud, T_refMean_dataIn);
+	
+	this->referenceDataPointsFilters.init();
+	this->referenceDataPointsFilters.apply(cloud);
+	
+	if (cloud.features.cols() == 0)
+	{
+		LOG_WARNING_STREAM("Ignoring attempt to add a cloud to the map whose points were all removed by the reference filters");
+		return false;
+	}
+	
+	const int begin(mapPointCloud->features.cols());
+	if (mapSegments.empty())
+	{
+		// The cloud indexed by the matcher of the chain becomes the first segment, without being copied
+		// nor indexed again, and the map continues in a new cloud, so that the indexed points stay in place
+		MapSegment base;
+		base.begin = 0;
+		base.count = begin;
+		base.cloud = mapPointCloud;
+		base.matcher = this->matcher;
+		mapPointCloud = std::make_shared<DataPoints>(*base.cloud);
+		
+		// the matcher only reads the features of the points
+		base.cloud->descriptors = Matrix();
+		base.cloud->descriptorLabels.clear();
+		base.cloud->times = Int64Matrix();
+		base.cloud->timeLabels.clear();
+		mapSegments.push_back(base);
+	}
+	mapPointCloud->concatenate(cloud);
+	mapSegments.push_back(createMapSegment(begin, cloud.features.cols()));
+	mergeMapSegments();
+	
+	this->inspector->addStat("MapPointCount", mapPointCloud->features.cols());
+	this->inspector->addStat("MapSegmentCount", mapSegments.size());
+	this->inspector->addStat("AddToMapDuration", t.elapsed());
+	
+	return true;
+}
+
+//! Remove the points of the map within the axis-aligned box [boxMin, boxMax], expressed in the global frame, and return their number
+/*!
+	Only the matchers of the segments that lost points are initialized again.
+	If the map was not extended with addToMap(), the whole map is indexed again.
+*/
+template<typename T>
+unsigned PointMatcher<T>::ICPSequence::removeFromMap(const Vector& boxMin, const Vector& boxMax)
+{
+	if (!hasMap())
+		return 0;
+	
+	const int dim(mapPointCloud->features.rows());
+	if (boxMin.size() != dim-1 || boxMax.size() != dim-1)
+		throw runtime_error("The corners of the box must have the dimension of the map points, without the homogeneous coordinate.");
+	
+	timer t; // Print how long take the algo
+	
+	// Express the box in frame <refMean>
+	const Vector meanMap(T_refIn_refMean.block(0,dim-1, dim-1, 1));
+	const Vector internalMin(boxMin - meanMap);
+	const Vector internalMax(boxMax - meanMap);
+	
+	const int ptCount(mapPointCloud->features.cols());
+	typename DataPointsFilter::KeepMask keep(ptCount);
+	for (int i = 0; i < ptCount; ++i)
+	{
+		const auto point(mapPointCloud->features.col(i).head(dim-1).array());
+		keep(i) = !((point >= internalMin.array()).all() && (point <= internalMax.array()).all());
+	}
+	
+	const int keptCount(keep.count());
+	if (keptCount == ptCount)
+		return 0;
+	if (keptCount == 0)
+	{
+		clearMap();
+		return ptCount;
+	}
+	
+	DataPointsFilter::compact(*mapPointCloud, keep);
+	
+	if (mapSegments.empty())
+	{
+		this->matcher->init(*mapPointCloud);
+	}
+	else
+	{
+		// Segments keep the indices of their own points, so untouched ones are only shifted
+		std::vector<MapSegment> segments;
+		int begin(0);
+		for (MapSegment segment: mapSegments)
+		{
+			const int count(keep.segment(segment.begin, segment.count).count());
+			if (count == segment.count)
+			{
+				segment.begin = begin;
+				segments.push_back(segment);
+			}
+			else if (count > 0)
+			{
+				segments.push_back(createMapSegment(begin, count));
+			}
+			begin += count;
+		}
+		mapSegments.swap(segments);
+	}
+	
+	this->inspector->addStat("MapPointCount", keptCount);
+	this->inspector->addStat("RemoveFromMapDuration", t.elapsed());
+	
+	return ptCount - keptCount;
+}
+
 //! Clear the map (reset to same state as after the object is created)
 template<typename T>
 void PointMatcher<T>::ICPSequence::clearMap()
 {
-	const int dim(mapPointCloud.features.rows());
+	const int dim(mapPointCloud->features.rows());
 	T_refIn_refMean = Matrix::Identity(dim, dim);
-	mapPointCloud = DataPoints();
+	mapPointCloud = std::make_shared<DataPoints>();
+	mapSegments.clear();
+}
+
+//! Return the number of segments of the map, each with its own matcher, or 1 if the matcher of the chain indexes the whole map
+template<typename T>
+unsigned PointMatcher<T>::ICPSequence::getMapSegmentCount() const
+{
+	if (!hasMap())
+		return 0;
+	return mapSegments.empty() ? 1 : mapSegments.size();
 }
 
 template<typename T>
@@ -521,9 +1035,10 @@ void PointMatcher<T>::ICPSequence::setDefault()
 {
 	ICPChainBase::setDefault();
 	
-	if(mapPointCloud.getNbPoints() > 0)
+	mapSegments.clear();
+	if(mapPointCloud->getNbPoints() > 0)
 	{
-		this->matcher->init(mapPointCloud);
+		this->matcher->init(*mapPointCloud);
 	}
 }
 
@@ -532,9 +1047,10 @@ void PointMatcher<T>::ICPSequence::loadFromYaml(std::istream& in)
 {
 	ICPChainBase::loadFromYaml(in);
 	
-	if(mapPointCloud.getNbPoints() > 0)
+	mapSegments.clear();
+	if(mapPointCloud->getNbPoints() > 0)
 	{
-		this->matcher->init(mapPointCloud);
+		this->matcher->init(*mapPointCloud);
 	}
 }
 
@@ -542,10 +1058,10 @@ void PointMatcher<T>::ICPSequence::loadFromYaml(std::istream& in)
 template<typename T>
 const typename PointMatcher<T>::DataPoints PointMatcher<T>::ICPSequence::getPrefilteredMap() const
 {
-	DataPoints globalMap(mapPointCloud);
+	DataPoints globalMap(*mapPointCloud);
 	if(this->hasMap())
 	{
-		const int dim(mapPointCloud.features.rows());
+		const int dim(mapPointCloud->features.rows());
 		const Vector meanMapNonHomo(T_refIn_refMean.block(0,dim-1, dim-1, 1));
 		globalMap.features.topRows(dim-1).colwise() += meanMapNonHomo;
 	}
@@ -563,7 +1079,7 @@ const typename PointMatcher<T>::DataPoints PointMatcher<T>::ICPSequence::getMap(
 template<typename T>
 const typename PointMatcher<T>::DataPoints& PointMatcher<T>::ICPSequence::getPrefilteredInternalMap() const
 {
-	return mapPointCloud;
+	return *mapPointCloud;
 }
 
 //! Return the map, in internal coordinates (fast). Deprecated in favor of getPrefilteredInternalMap().
@@ -603,9 +1119,97 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICPSequence:
 		return Matrix::Identity(dim, dim);
 	}
 	
+	if (!this->pyramidLevels.empty())
+		LOG_WARNING_STREAM("PointMatcher::ICPSequence - ignoring the " << this->pyramidLevels.size() << " pyramid levels of the chain, registering against the map directly");
+	
 	this->inspector->init();
 	
-	return this->computeWithTransformedReference(cloudIn, mapPointCloud, T_refIn_refMean, T_refIn_dataIn);
+	return this->computeWithTransformedReference(cloudIn, *mapPointCloud, T_refIn_refMean, T_refIn_dataIn);
+}
+
+//! Find the closest points of stepReading in the map, merging the neighbors found in every segment
+template<typename T>
+typename PointMatcher<T>::Matches PointMatcher<T>::ICPSequence::findClosests(const DataPoints& stepReading)
+{
+	if (mapSegments.empty())
+		return ICP::findClosests(stepReading);
+	
+	std::vector<Matches> segmentMatches;
+	segmentMatches.reserve(mapSegments.size());
+	for (const auto& segment: mapSegments)
+	{
+		segmentMatches.push_back(segment.matcher->findClosests(stepReading));
+		if (segment.matcher != this->matcher)
+		{
+			this->matcher->visitCounter += segment.matcher->getVisitCount();
+			segment.matcher->resetVisitCount();
+		}
+	}
+	
+	const int knn(segmentMatches[0].ids.rows());
+	const int readingCount(stepReading.features.cols());
+	Matches matches(knn, readingCount);
+	
+	std::vector<std::pair<T, int> > candidates;
+	for (int i = 0; i < readingCount; ++i)
+	{
+		candidates.clear();
+		for (size_t s = 0; s < mapSegments.size(); ++s)
+		{
+			for (int k = 0; k < knn; ++k)
+			{
+				const int id(segmentMatches[s].ids(k, i));
+				if (id != Matches::InvalidId)
+					candidates.push_back(std::make_pair(segmentMatches[s].dists(k, i), mapSegments[s].begin + id));
+			}
+		}
+		
+		const int validCount(std::min<int>(knn, candidates.size()));
+		std::partial_sort(candidates.begin(), candidates.begin() + validCount, candidates.end());
+		for (int k = 0; k < validCount; ++k)
+		{
+			matches.dists(k, i) = candidates[k].first;
+			matches.ids(k, i) = candidates[k].second;
+		}
+		for (int k = validCount; k < knn; ++k)
+		{
+			matches.dists(k, i) = Matches::InvalidDist;
+			matches.ids(k, i) = Matches::InvalidId;
+		}
+	}
+	
+	return matches;
+}
+
+//! Create a segment indexing the count points of the map starting at begin
+template<typename T>
+typename PointMatcher<T>::ICPSequence::MapSegment PointMatcher<T>::ICPSequence::createMapSegment(const int begin, const int count) const
+{
+	MapSegment segment;
+	segment.begin = begin;
+	segment.count = count;
+	segment.cloud = std::make_shared<DataPoints>(mapPointCloud->features.middleCols(begin, count), mapPointCloud->featureLabels);
+	segment.matcher = PointMatcher<T>::get().REG(Matcher).create(this->matcher->className, this->matcher->parameters);
+	segment.matcher->init(*segment.cloud);
+	return segment;
+}
+
+//! Merge the most recent segments while the older one is less than twice as large as the newer one, leaving the first segment as is
+template<typename T>
+void PointMatcher<T>::ICPSequence::mergeMapSegments()
+{
+	while (mapSegments.size() > 2)
+	{
+		const MapSegment& newer(mapSegments[mapSegments.size() - 1]);
+		const MapSegment& older(mapSegments[mapSegments.size() - 2]);
+		if (older.count >= 2 * newer.count)
+			break;
+		
+		const int begin(older.begin);
+		const int count(older.count + newer.count);
+		mapSegments.pop_back();
+		mapSegments.back() = createMapSegment(begin, count);
+	}
 }
 
 template struct PointMatcher<float>::ICPSequence;
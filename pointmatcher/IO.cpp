@@ -44,12 +44,17 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <fstream>
 #include <stdexcept>
 #include <ctype.h>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 #include "boost/algorithm/string.hpp"
 #include "boost/filesystem.hpp"
 #include "boost/filesystem/path.hpp"
 #include "boost/filesystem/operations.hpp"
 #include "boost/lexical_cast.hpp"
 #include "boost/foreach.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
 
 #ifdef WIN32
 #define strtok_r strtok_s
@@ -384,8 +389,10 @@ typename PointMatcher<T>::DataPoints PointMatcher<T>::DataPoints::load(const std
 		return PointMatcherIO<T>::loadPLY(fileName);
 	else if (boost::iequals(ext, ".pcd"))
 		return PointMatcherIO<T>::loadPCD(fileName);
+	else if (boost::iequals(ext, ".pmd"))
+		return PointMatcherIO<T>::loadPMD(fileName);
 	else
-		throw runtime_error("loadAnyFormat(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\" or \".csv\"");
+		throw runtime_error("loadAnyFormat(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".csv\", \".ply\", \".pcd\" or \".pmd\"");
 }
 
 template
@@ -813,17 +820,20 @@ void PointMatcher<T>::DataPoints::save(const std::string& fileName, bool binary)
 	if (boost::iequals(ext, ".vtk"))
 		return PointMatcherIO<T>::saveVTK(*this, fileName, binary);
 
+	if (boost::iequals(ext, ".ply"))
+		return PointMatcherIO<T>::savePLY(*this, fileName, binary);
+	if (boost::iequals(ext, ".pcd"))
+		return PointMatcherIO<T>::savePCD(*this, fileName, binary);
+	if (boost::iequals(ext, ".pmd"))
+		return PointMatcherIO<T>::savePMD(*this, fileName);
+
 	if (binary)
-		throw runtime_error("save(): Binary writing is not supported together with extension \"" + ext + "\". Currently binary writing is only supported with \".vtk\".");
+		throw runtime_error("save(): Binary writing is not supported together with extension \"" + ext + "\". Currently binary writing is only supported with \".vtk\", \".ply\" and \".pcd\".");
 
 	if (boost::iequals(ext, ".csv"))
 		return PointMatcherIO<T>::saveCSV(*this, fileName);
-	else if (boost::iequals(ext, ".ply"))
-		return PointMatcherIO<T>::savePLY(*this, fileName);
-	else if (boost::iequals(ext, ".pcd"))
-		return PointMatcherIO<T>::savePCD(*this, fileName);
 	else
-		throw runtime_error("save(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".ply\", \".pcd\" or \".csv\"");
+		throw runtime_error("save(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".ply\", \".pcd\", \".pmd\" or \".csv\"");
 }
 
 template
@@ -1275,18 +1285,234 @@ void PointMatcherIO<float>::saveVTK(const PointMatcherIO<float>::DataPoints& dat
 template
 void PointMatcherIO<double>::saveVTK(const PointMatcher<double>::DataPoints& data, const std::string& fileName, bool binary);
 
+namespace
+{
+	//! Scalar types of the values stored in binary PLY and PCD files
+	enum BinaryScalarType
+	{
+		BINARY_INT8,
+		BINARY_UINT8,
+		BINARY_INT16,
+		BINARY_UINT16,
+		BINARY_INT32,
+		BINARY_UINT32,
+		BINARY_INT64,
+		BINARY_UINT64,
+		BINARY_FLOAT32,
+		BINARY_FLOAT64
+	};
+
+	//! Return the scalar type of a PLY type name
+	BinaryScalarType getPLYScalarType(const std::string& type)
+	{
+		if (type == "char" || type == "int8")
+			return BINARY_INT8;
+		if (type == "uchar" || type == "uint8")
+			return BINARY_UINT8;
+		if (type == "short" || type == "int16")
+			return BINARY_INT16;
+		if (type == "ushort" || type == "uint16")
+			return BINARY_UINT16;
+		if (type == "int" || type == "int32")
+			return BINARY_INT32;
+		if (type == "uint" || type == "uint32")
+			return BINARY_UINT32;
+		if (type == "float" || type == "float32")
+			return BINARY_FLOAT32;
+		if (type == "double" || type == "float64")
+			return BINARY_FLOAT64;
+		throw runtime_error(string("PLY parse error: property type ") + type + string(" is invalid"));
+	}
+
+	//! Return the scalar type of a PCD field, given its TYPE and SIZE
+	BinaryScalarType getPCDScalarType(const char type, const unsigned size)
+	{
+		if (type == 'I' && size == 1)
+			return BINARY_INT8;
+		if (type == 'U' && size == 1)
+			return BINARY_UINT8;
+		if (type == 'I' && size == 2)
+			return BINARY_INT16;
+		if (type == 'U' && size == 2)
+			return BINARY_UINT16;
+		if (type == 'I' && size == 4)
+			return BINARY_INT32;
+		if (type == 'U' && size == 4)
+			return BINARY_UINT32;
+		if (type == 'I' && size == 8)
+			return BINARY_INT64;
+		if (type == 'U' && size == 8)
+			return BINARY_UINT64;
+		if (type == 'F' && size == 4)
+			return BINARY_FLOAT32;
+		if (type == 'F' && size == 8)
+			return BINARY_FLOAT64;
+		stringstream ss;
+		ss << "PCD Parse Error: unsupported combination of TYPE " << type << " and SIZE " << size;
+		throw runtime_error(ss.str());
+	}
+
+	//! Return the size in bytes of a binary scalar type
+	size_t getScalarSize(const BinaryScalarType type)
+	{
+		switch (type)
+		{
+			case BINARY_INT8: case BINARY_UINT8: return 1;
+			case BINARY_INT16: case BINARY_UINT16: return 2;
+			case BINARY_INT32: case BINARY_UINT32: case BINARY_FLOAT32: return 4;
+			case BINARY_INT64: case BINARY_UINT64: case BINARY_FLOAT64: return 8;
+		}
+		return 0;
+	}
+
+	template<typename S>
+	inline S decodeScalar(const char* data, const bool swap)
+	{
+		ConverterToAndFromBytes<S> converter;
+		memcpy(converter.bytes, data, sizeof(S));
+		if (swap)
+			converter.swapBytes();
+		return converter.v;
+	}
+
+	//! Decode a binary scalar of a given type stored at data, swapping its bytes if the file endianness differs from the platform one
+	template<typename T>
+	inline T decodeScalar(const char* data, const BinaryScalarType type, const bool swap)
+	{
+		switch (type)
+		{
+			case BINARY_INT8: return T(decodeScalar<int8_t>(data, swap));
+			case BINARY_UINT8: return T(decodeScalar<uint8_t>(data, swap));
+			case BINARY_INT16: return T(decodeScalar<int16_t>(data, swap));
+			case BINARY_UINT16: return T(decodeScalar<uint16_t>(data, swap));
+			case BINARY_INT32: return T(decodeScalar<int32_t>(data, swap));
+			case BINARY_UINT32: return T(decodeScalar<uint32_t>(data, swap));
+			case BINARY_INT64: return T(decodeScalar<int64_t>(data, swap));
+			case BINARY_UINT64: return T(decodeScalar<uint64_t>(data, swap));
+			case BINARY_FLOAT32: return T(decodeScalar<float>(data, swap));
+			case BINARY_FLOAT64: return T(decodeScalar<double>(data, swap));
+		}
+		return T(0);
+	}
+
+	//! Read a binary scalar from a stream, format naming the file format in the error messages
+	template<typename T>
+	inline T readScalar(std::istream& is, const BinaryScalarType type, const bool swap, const std::string& format)
+	{
+		char data[8];
+		if (!is.read(data, getScalarSize(type)))
+			throw runtime_error(format + " parse error: reached end of file while reading binary data");
+		return decodeScalar<T>(data, type, swap);
+	}
+
+	//! Skip a binary PLY property, reading the number of elements of list properties
+	inline void skipPLYProperty(std::istream& is, const bool isList, const BinaryScalarType idxType, const BinaryScalarType type, const bool swap)
+	{
+		size_t count(1);
+		if (isList)
+			count = readScalar<uint64_t>(is, idxType, swap, "PLY");
+		if (!is.ignore(count * getScalarSize(type)))
+			throw runtime_error("PLY parse error: reached end of file while reading binary data");
+	}
+
+	//! Decompress a LZF buffer, as used in binary_compressed PCD files, and return the size of the decompressed data
+	size_t lzfDecompress(const char* input, const size_t inputSize, char* output, const size_t outputSize)
+	{
+		const unsigned char* in = reinterpret_cast<const unsigned char*>(input);
+		const unsigned char* const inEnd = in + inputSize;
+		unsigned char* const outBegin = reinterpret_cast<unsigned char*>(output);
+		unsigned char* out = outBegin;
+		unsigned char* const outEnd = outBegin + outputSize;
+
+		while (in < inEnd)
+		{
+			size_t ctrl = *in++;
+			if (ctrl < (1 << 5))
+			{
+				// literal run of ctrl+1 bytes
+				++ctrl;
+				if (out + ctrl > outEnd || in + ctrl > inEnd)
+					throw runtime_error("PCD Parse Error: corrupted LZF data");
+				memcpy(out, in, ctrl);
+				out += ctrl;
+				in += ctrl;
+			}
+			else
+			{
+				// back reference
+				size_t length = ctrl >> 5;
+				if (length == 7)
+				{
+					if (in >= inEnd)
+						throw runtime_error("PCD Parse Error: corrupted LZF data");
+					length += *in++;
+				}
+				length += 2;
+				if (in >= inEnd)
+					throw runtime_error("PCD Parse Error: corrupted LZF data");
+				const size_t distance = ((ctrl & 0x1f) << 8) + *in++ + 1;
+				if (distance > size_t(out - outBegin) || out + length > outEnd)
+					throw runtime_error("PCD Parse Error: corrupted LZF data");
+				// copy byte per byte, since the reference may overlap with the output
+				const unsigned char* ref = out - distance;
+				for (size_t i = 0; i < length; ++i)
+					*out++ = *ref++;
+			}
+		}
+
+		return out - outBegin;
+	}
+}
+
+namespace
+{
+	//! Assemble the matrices of a loaded point cloud, adding the padding feature if it is missing
+	template<typename T>
+	typename PointMatcher<T>::DataPoints assembleDataPoints(
+		const typename PointMatcher<T>::Matrix& features, const typename PointMatcher<T>::DataPoints::Labels& featureLabels,
+		const typename PointMatcher<T>::Matrix& descriptors, const typename PointMatcher<T>::DataPoints::Labels& descriptorLabels,
+		const typename PointMatcher<T>::Int64Matrix& times, const typename PointMatcher<T>::DataPoints::Labels& timeLabels)
+	{
+		typedef typename PointMatcher<T>::DataPoints DataPoints;
+		typedef typename PointMatcher<T>::Matrix Matrix;
+
+		DataPoints loadedPoints(features, featureLabels);
+
+		if (descriptors.rows() > 0)
+		{
+			loadedPoints.descriptors = descriptors;
+			loadedPoints.descriptorLabels = descriptorLabels;
+		}
+
+		if(times.rows() > 0)
+		{
+			loadedPoints.times = times;
+			loadedPoints.timeLabels = timeLabels;
+		}
+
+		// Ensure homogeous coordinates
+		if(!loadedPoints.featureExists("pad"))
+		{
+			loadedPoints.addFeature("pad", Matrix::Ones(1,features.cols()));
+		}
+
+		return loadedPoints;
+	}
+}
+
 //! @brief Load polygon file format (ply) file
 //! @param fileName a string containing the path and the file name
 //!
 //! Note: that the PLY does not define a standard for point clouds
-//! Warning: Binary PLY files are not supported, only ASCII
+//! Both ASCII and binary (little and big endian) PLY files are supported
 //! Only PLY files with elements named "vertex" are supported
 //! "vertex" should have 2 or 3 properties names "x", "y", "z" to define features.
+//! List properties of binary files are skipped.
 //!
 template<typename T>
 typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(const std::string& fileName)
 {
-	ifstream ifs(fileName.c_str());
+	ifstream ifs(fileName.c_str(), std::ios::binary);
 	if (!ifs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 	return loadPLY(ifs);
@@ -1301,6 +1527,20 @@ PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPLY(const string&
 //! @see loadPLY()
 template <typename T>
 typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream& is)
+{
+	const PLYHeader header(readPLYHeader(is));
+
+	Matrix features(header.featureLabels.totalDim(), header.nbPoints);
+	Matrix descriptors(header.descriptorLabels.totalDim(), header.nbPoints);
+	Int64Matrix times(header.timeLabels.totalDim(), header.nbPoints);
+	readPLYVertices(is, header, features, descriptors, times, header.nbPoints);
+
+	return assembleDataPoints<T>(features, header.featureLabels, descriptors, header.descriptorLabels, times, header.timeLabels);
+}
+
+//! @brief Parse the header of a PLY file, and position the stream on the first vertex
+template <typename T>
+typename PointMatcherIO<T>::PLYHeader PointMatcherIO<T>::readPLYHeader(std::istream& is)
 {
 	class Elements : public vector<PLYElement*>{
 	 public:
@@ -1316,9 +1556,7 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	Steps:
 	1- PARSE PLY HEADER
 	2- ASSIGN PLY PROPERTIES TO DATAPOINTS ROWS
-	3- Reserve memory for a DataPoints
-	4- Parse PLY vertex to appropriate DataPoints cols and rows 
-	5- Assemble final DataPoints
+	3- Skip binary elements stored before the vertices
 
 	PLY organisation:
 
@@ -1336,6 +1574,10 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	// 1- PARSE PLY HEADER
 	bool format_defined = false;
 	bool header_processed = false;
+	bool binary = false;
+	bool swapBytes = false;
+	// elements preceding the vertex element, that must be skipped in binary files
+	vector<pair<unsigned, PLYProperties> > leadingElements;
 
 	Elements elements;
 	PLYElementF element_f; // factory
@@ -1379,8 +1621,9 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 			if (format_str != "ascii" && format_str != "binary_little_endian" && format_str != "binary_big_endian")
 				throw runtime_error(string("PLY parse error: format <") + format_str + string("> is not supported"));
 
-			if (format_str == "binary_little_endian" || format_str == "binary_big_endian")
-				throw runtime_error(string("PLY parse error: binary PLY files are not supported"));
+			binary = (format_str != "ascii");
+			swapBytes = binary && ((format_str == "binary_big_endian") != isBigEndian);
+
 			if (version_str != "1.0")
 			{
 				throw runtime_error(string("PLY parse error: version <") + version_str + string("> of ply is not supported"));
@@ -1427,23 +1670,43 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 			{
 				LOG_WARNING_STREAM("PLY parse warning: element " << elem_name << " not supported. Skipping.");
 				skip_props = true;
+				if (binary && elements.empty())
+					leadingElements.push_back(make_pair(elem_num, PLYProperties()));
 			}
 
 			elem_offset += elem_num;
 		}
 		else if (keyword == "property")
 		{
-			if (current_element == NULL)
+			if (current_element == NULL && !(binary && skip_props))
 			{
 				throw runtime_error("PLY parse error: property listed without defining an element");
 			}
 
-			if (skip_props)
-				continue;
-
 			string next, prop_type, prop_name;
 			stringstream >> next;
 
+			if (skip_props)
+			{
+				// binary data of elements preceding the vertex must be skipped, so their layout is kept
+				if (binary && elements.empty())
+				{
+					PLYProperties& props = leadingElements.back().second;
+					if (next == "list")
+					{
+						string prop_idx_type;
+						stringstream >> prop_idx_type >> prop_type >> prop_name;
+						props.push_back(PLYProperty(prop_idx_type, prop_type, prop_name, props.size()));
+					}
+					else
+					{
+						stringstream >> prop_name;
+						props.push_back(PLYProperty(next, prop_name, props.size()));
+					}
+				}
+				continue;
+			}
+
 			// PLY list property
 			if (next == "list")
 			{
@@ -1512,7 +1775,7 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 		for(it_PLYProp it=vertex->properties.begin(); it!=vertex->properties.end(); ++it)
 		{
 
-			if(supLabel.externalName == it->name)
+			if(supLabel.externalName == it->name && !(binary && it->is_list))
 			{
 				it->pmType = supLabel.type;
 
@@ -1547,7 +1810,11 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	// loop through the remaining UNSUPPORTED labels and assigned them to a single descriptor row
 	for(it_PLYProp it=vertex->properties.begin(); it!=vertex->properties.end(); ++it)
 	{
-		if(it->pmType == UNSUPPORTED)
+		if(binary && it->is_list)
+		{
+			LOG_WARNING_STREAM("PLY parse warning: list property " << it->name << " not supported. Skipping.");
+		}
+		else if(it->pmType == UNSUPPORTED)
 		{
 			it->pmType = DESCRIPTOR; // force descriptor
 			it->pmRowID = rowIdDescriptors;
@@ -1557,105 +1824,193 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	}
 
 	///////////////////////////
-	// 3- RESERVE DATAPOINTS MEMORY
-
-	const unsigned int featDim = featLabelGen.getLabels().totalDim();
-	const unsigned int descDim = descLabelGen.getLabels().totalDim();
-	const unsigned int timeDim = timeLabelGen.getLabels().totalDim();
-	const unsigned int nbPoints = vertex->num;
-
-	Matrix features = Matrix(featDim, nbPoints);
-	Matrix descriptors = Matrix(descDim, nbPoints);
-	Int64Matrix times = Int64Matrix(timeDim, nbPoints);
-
-
-	///////////////////////////
-	// 4- PARSE PLY DATA (vertex)
-	const int nbProp = vertex->total_props;
-	const int nbValues = nbPoints*nbProp;
-	int propID = 0;
-	int col = 0;
-	for(int i=0; i<nbValues; i++)
+	// 3- SKIP ELEMENTS STORED BEFORE THE VERTICES
+	if(binary)
 	{
-		T value;
-		if(!(is >> value))
-		{
-			throw runtime_error(
-			(boost::format("PLY parse error: expected %1% values (%2% points with %3% properties) but only found %4% values.") % nbValues % nbPoints % nbProp % i).str());
-		}
-		else
+		for(size_t e = 0; e < leadingElements.size(); ++e)
 		{
-			const int row = vertex->properties[propID].pmRowID;
-			const PMPropTypes type = vertex->properties[propID].pmType;
-			
-			// rescale color from [0,254] to [0, 1[
-			// FIXME: do we need that?
-			if (vertex->properties[propID].name == "red" || vertex->properties[propID].name == "green" || vertex->properties[propID].name == "blue" || vertex->properties[propID].name == "alpha") {
-				value /= 255.0;
+			const PLYProperties& props = leadingElements[e].second;
+			for(unsigned n = 0; n < leadingElements[e].first; ++n)
+			{
+				for(size_t p = 0; p < props.size(); ++p)
+				{
+					const bool isList(props[p].is_list);
+					skipPLYProperty(is, isList, getPLYScalarType(isList ? props[p].idx_type : props[p].type), getPLYScalarType(props[p].type), swapBytes);
+				}
 			}
+		}
+	}
 
-			switch (type)
+	PLYHeader header;
+	header.vertexProperties = vertex->properties;
+	header.nbPoints = vertex->num;
+	header.binary = binary;
+	header.swapBytes = swapBytes;
+	header.featureLabels = featLabelGen.getLabels();
+	header.descriptorLabels = descLabelGen.getLabels();
+	header.timeLabels = timeLabelGen.getLabels();
+	return header;
+}
+
+//! @brief Parse the next count vertices of a PLY file into the first columns of the matrices
+//! @see readPLYHeader()
+template <typename T>
+void PointMatcherIO<T>::readPLYVertices(std::istream& is, const PLYHeader& header, Matrix& features, Matrix& descriptors, Int64Matrix& times, const unsigned count)
+{
+	const PLYProperties& properties = header.vertexProperties;
+	const int nbProp = properties.size();
+	if(header.binary)
+	{
+		const bool swapBytes = header.swapBytes;
+
+		// decoding information for every vertex property
+		vector<BinaryScalarType> types(nbProp), idxTypes(nbProp, BINARY_UINT8);
+		vector<T*> destinations(nbProp, NULL);
+		vector<Eigen::Index> destinationStrides(nbProp, 0);
+		vector<int64_t*> timeDestinations(nbProp, NULL);
+		vector<bool> isColor(nbProp, false);
+		bool hasList = false;
+		size_t vertexSize = 0;
+		for(int p = 0; p < nbProp; ++p)
+		{
+			const PLYProperty& prop = properties[p];
+			types[p] = getPLYScalarType(prop.type);
+			vertexSize += getScalarSize(types[p]);
+			if(prop.is_list)
+			{
+				idxTypes[p] = getPLYScalarType(prop.idx_type);
+				hasList = true;
+				continue;
+			}
+			isColor[p] = prop.name == "red" || prop.name == "green" || prop.name == "blue" || prop.name == "alpha";
+			switch (prop.pmType)
 			{
 				case FEATURE:
-					features(row, col) = value;
+					destinations[p] = features.data() + prop.pmRowID;
+					destinationStrides[p] = features.rows();
 					break;
 				case DESCRIPTOR:
-					descriptors(row, col) = value;
+					destinations[p] = descriptors.data() + prop.pmRowID;
+					destinationStrides[p] = descriptors.rows();
 					break;
 				case TIME:
-					times(row, col) = value;
+					timeDestinations[p] = times.data() + prop.pmRowID;
+					destinationStrides[p] = times.rows();
 					break;
 				case UNSUPPORTED:
 					throw runtime_error("Implementation error in loadPLY(). This should not throw.");
 					break;
 			}
+		}
 
-			++propID;
+		// store the value of property p of the vertex col
+		const auto store = [&](const int p, const Eigen::Index col, T value)
+		{
+			if(isColor[p])
+				value /= 255.0;
+			if(destinations[p])
+				destinations[p][col * destinationStrides[p]] = value;
+			else
+				timeDestinations[p][col * destinationStrides[p]] = value;
+		};
 
-			if(propID >= nbProp)
+		if(!hasList)
+		{
+			// fixed-size vertices are decoded by blocks
+			const unsigned blockSize = 65536;
+			vector<char> buffer(size_t(min(count, blockSize)) * vertexSize);
+			for(unsigned begin = 0; begin < count; begin += blockSize)
 			{
-				propID = 0;
-				++col;
+				const unsigned end = min(count, begin + blockSize);
+				if(!is.read(buffer.data(), size_t(end - begin) * vertexSize))
+				{
+					throw runtime_error(
+					(boost::format("PLY parse error: expected %1% points of %2% bytes but the file ended before point %3%.") % count % vertexSize % (begin + is.gcount() / vertexSize)).str());
+				}
+				const char* data = buffer.data();
+				for(unsigned i = begin; i < end; ++i)
+				{
+					for(int p = 0; p < nbProp; ++p)
+					{
+						store(p, i, decodeScalar<T>(data, types[p], swapBytes));
+						data += getScalarSize(types[p]);
+					}
+				}
+			}
+		}
+		else
+		{
+			for(unsigned i = 0; i < count; ++i)
+			{
+				for(int p = 0; p < nbProp; ++p)
+				{
+					if(properties[p].is_list)
+						skipPLYProperty(is, true, idxTypes[p], types[p], swapBytes);
+					else
+						store(p, i, readScalar<T>(is, types[p], swapBytes, "PLY"));
+				}
 			}
 		}
 	}
-
-
-
-	///////////////////////////
-	// 5- ASSEMBLE FINAL DATAPOINTS
-	
-	DataPoints loadedPoints(features, featLabelGen.getLabels());
-
-	if (descriptors.rows() > 0)
-	{
-		loadedPoints.descriptors = descriptors;
-		loadedPoints.descriptorLabels = descLabelGen.getLabels();
-	}
-
-	if(times.rows() > 0)
+	else
 	{
-		loadedPoints.times = times;
-		loadedPoints.timeLabels = timeLabelGen.getLabels();	
-	}
+		const int nbValues = count*nbProp;
+		int propID = 0;
+		int col = 0;
+		for(int i=0; i<nbValues; i++)
+		{
+			T value;
+			if(!(is >> value))
+			{
+				throw runtime_error(
+				(boost::format("PLY parse error: expected %1% values (%2% points with %3% properties) but only found %4% values.") % nbValues % count % nbProp % i).str());
+			}
+			else
+			{
+				const int row = properties[propID].pmRowID;
+				const PMPropTypes type = properties[propID].pmType;
+			
+				// rescale color from [0,254] to [0, 1[
+				// FIXME: do we need that?
+				if (properties[propID].name == "red" || properties[propID].name == "green" || properties[propID].name == "blue" || properties[propID].name == "alpha") {
+					value /= 255.0;
+				}
 
-	// Ensure homogeous coordinates
-	if(!loadedPoints.featureExists("pad"))
-	{
-		loadedPoints.addFeature("pad", Matrix::Ones(1,features.cols()));
-	}
+				switch (type)
+				{
+					case FEATURE:
+						features(row, col) = value;
+						break;
+					case DESCRIPTOR:
+						descriptors(row, col) = value;
+						break;
+					case TIME:
+						times(row, col) = value;
+						break;
+					case UNSUPPORTED:
+						throw runtime_error("Implementation error in loadPLY(). This should not throw.");
+						break;
+				}
 
-	return loadedPoints;
+				++propID;
 
+				if(propID >= nbProp)
+				{
+					propID = 0;
+					++col;
+				}
+			}
+		}
+	}
 }
 
 template<typename T>
 void PointMatcherIO<T>::savePLY(const DataPoints& data,
-		const std::string& fileName)
+		const std::string& fileName, bool binary)
 {
 	//typedef typename DataPoints::Labels Labels;
 
-	ofstream ofs(fileName.c_str());
+	ofstream ofs(fileName.c_str(), std::ios::binary);
 	if (!ofs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 
@@ -1670,11 +2025,18 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 		return;
 	}
 
-	ofs << "ply\n" <<"format ascii 1.0\n";
+	// binary files store the native scalar type, in the platform endianness
+	const string propType(binary && sizeof(T) == sizeof(double) ? "double" : "float");
+
+	ofs << "ply\n";
+	if (binary)
+		ofs << "format " << (isBigEndian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n";
+	else
+		ofs << "format ascii 1.0\n";
 	ofs << "element vertex " << pointCount << "\n";
 	for (int f=0; f <(featCount-1); f++)
 	{
-		ofs << "property float " << data.featureLabels[f].text << "\n";
+		ofs << "property " << propType << " " << data.featureLabels[f].text << "\n";
 	}
 
 	for (size_t i = 0; i < data.descriptorLabels.size(); i++)
@@ -1683,12 +2045,35 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 		for (size_t s = 0; s < lab.span; s++)
 
 		{
-			ofs << "property float " << getColLabel(lab,s) << "\n";
+			ofs << "property " << propType << " " << getColLabel(lab,s) << "\n";
 		}
 	}
 
 	ofs << "end_header\n";
 
+	bool datawithColor = data.descriptorExists("color");
+	int colorStartingRow = data.getDescriptorStartingRow("color");
+	int colorEndRow = colorStartingRow + data.getDescriptorDimension("color");
+
+	if (binary)
+	{
+		// write points by blocks of interleaved features and descriptors
+		const int vertexDim(featCount - 1 + descRows);
+		const int blockSize(65536);
+		Matrix block(vertexDim, min(pointCount, blockSize));
+		for (int begin = 0; begin < pointCount; begin += blockSize)
+		{
+			const int count(min(pointCount - begin, blockSize));
+			block.topLeftCorner(featCount - 1, count) = data.features.block(0, begin, featCount - 1, count);
+			block.bottomLeftCorner(descRows, count) = data.descriptors.middleCols(begin, count);
+			if (datawithColor)
+				block.block(featCount - 1 + colorStartingRow, 0, colorEndRow - colorStartingRow, count) *= 255.0;
+			ofs.write(reinterpret_cast<const char*>(block.data()), sizeof(T) * vertexDim * count);
+		}
+		ofs.close();
+		return;
+	}
+
 	// write points
 	for (int p = 0; p < pointCount; ++p)
 	{
@@ -1699,9 +2084,6 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 				ofs << " ";
 		}
 
-		bool datawithColor = data.descriptorExists("color");
-		int colorStartingRow = data.getDescriptorStartingRow("color");
-		int colorEndRow = colorStartingRow + data.getDescriptorDimension("color");
 		for (int d = 0; d < descRows; ++d)
 		{
 			if (datawithColor && d >= colorStartingRow && d < colorEndRow) {
@@ -1719,9 +2101,9 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 }
 
 template
-void PointMatcherIO<float>::savePLY(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<float>::savePLY(const DataPoints& data, const std::string& fileName, bool binary);
 template
-void PointMatcherIO<double>::savePLY(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<double>::savePLY(const DataPoints& data, const std::string& fileName, bool binary);
 
 //! @(brief) Regular PLY property constructor
 template<typename T>
@@ -1823,7 +2205,10 @@ template<typename T>
 bool PointMatcherIO<T>::plyPropTypeValid(const std::string& type) {
 	return (type == "char" || type == "uchar" || type == "short"
 			|| type == "ushort" || type == "int" || type == "uint"
-			|| type == "float" || type == "double");
+			|| type == "float" || type == "double"
+			|| type == "int8" || type == "uint8" || type == "int16"
+			|| type == "uint16" || type == "int32" || type == "uint32"
+			|| type == "float32" || type == "float64");
 }
 
 
@@ -1845,7 +2230,7 @@ bool PointMatcherIO<T>::PLYProperty::operator==(const PLYProperty& rhs) const
 //! @param fileName a string containing the path and the file name
 template<typename T>
 typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(const string& fileName) {
-	ifstream ifs(fileName.c_str());
+	ifstream ifs(fileName.c_str(), std::ios::binary);
 	if (!ifs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 	return loadPCD(ifs);
@@ -1862,15 +2247,27 @@ PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPCD(const string&
 //! @see loadPCD()
 template<typename T>
 typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream& is) {
+	PCDState state(readPCDHeader(is));
+	const unsigned int nbPoints = state.header.nbPoints;
+
+	Matrix features(state.featureLabels.totalDim(), nbPoints);
+	Matrix descriptors(state.descriptorLabels.totalDim(), nbPoints);
+	Int64Matrix times(state.timeLabels.totalDim(), nbPoints);
+	readPCDPoints(is, state, features, descriptors, times, nbPoints);
+
+	return assembleDataPoints<T>(features, state.featureLabels, descriptors, state.descriptorLabels, times, state.timeLabels);
+}
+
+//! @brief Parse the header of a PCD file, and position the stream on the first point
+template<typename T>
+typename PointMatcherIO<T>::PCDState PointMatcherIO<T>::readPCDHeader(std::istream& is) {
 
 
 	/*
 	Steps:
 	1- PARSE PCD HEADER
 	2- ASSIGN PCD PROPERTIES TO DATAPOINTS ROWS
-	3- Reserve memory for a DataPoints
-	4- Parse PCD XXX to appropriate DataPoints cols and rows 
-	5- Assemble final DataPoints
+	3- Decompress binary_compressed data
 
 	PCD organisation:
 
@@ -1884,7 +2281,7 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 	HEIGHT h
 	VIEWPOINT 0 0 0 1 0 0 0
 	POINTS size (should be w*h)
-	DATA ascii or binary
+	DATA ascii, binary or binary_compressed
 	data1 data2 data3 ...
 	data1 data2 data3 ...
 	...
@@ -2042,19 +2439,15 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 		{
 			header.dataType= tokens[1];
 			
-			if (header.dataType == "ascii")
+			if (header.dataType == "ascii" || header.dataType == "binary" || header.dataType == "binary_compressed")
 			{
 				// DATA is the last element of the header, we exit the loop
 				break;
 			}
-			else if(header.dataType == "binary")
-			{
-				throw runtime_error("PCD Implementation Error: the option for DATA binary is not implemented yet");
-			}
 			else
 			{
 				stringstream ss;
-				ss << "PCD Parse Error: the value in the element DATA (" << tokens[1] << ") must be ascii or binary";
+				ss << "PCD Parse Error: the value in the element DATA (" << tokens[1] << ") must be ascii, binary or binary_compressed";
 				throw runtime_error(ss.str());
 			}
 
@@ -2133,11 +2526,14 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 		}
 	}
 	
+	const bool binary = header.dataType != "ascii";
+
 	// loop through the remaining UNSUPPORTED labels and assigned them to a single descriptor row
 	for(size_t i=0; i < header.properties.size(); i++)
 	{
 		const PCDproperty prop = header.properties[i];
-		if(prop.pmType == UNSUPPORTED)
+		// fields named "_" are padding bytes in binary files
+		if(prop.pmType == UNSUPPORTED && !(binary && prop.field == "_"))
 		{
 			header.properties[i].pmType = DESCRIPTOR; // force descriptor
 			header.properties[i].pmRowID = rowIdDescriptors;
@@ -2148,115 +2544,207 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 
 
 	///////////////////////////
-	// 3- RESERVE DATAPOINTS MEMORY
-
-	const unsigned int featDim = featLabelGen.getLabels().totalDim();
-	const unsigned int descDim = descLabelGen.getLabels().totalDim();
-	const unsigned int timeDim = timeLabelGen.getLabels().totalDim();
-	const unsigned int totalDim = featDim + descDim + timeDim;
-	const unsigned int nbPoints = header.nbPoints;
+	// 3- DECOMPRESS BINARY_COMPRESSED DATA
 
-	Matrix features = Matrix(featDim, nbPoints);
-	Matrix descriptors = Matrix(descDim, nbPoints);
-	Int64Matrix times = Int64Matrix(timeDim, nbPoints);
-
-
-	///////////////////////////
-	// 4- PARSE PCD DATA
+	PCDState state;
+	state.header = header;
+	state.featureLabels = featLabelGen.getLabels();
+	state.descriptorLabels = descLabelGen.getLabels();
+	state.timeLabels = timeLabelGen.getLabels();
+	state.lineNum = lineNum;
+	state.nextPoint = 0;
 
-	size_t col = 0; // point count
-	while (safeGetLine(is, line))
+	if (header.dataType == "binary_compressed")
 	{
+		size_t pointSize = 0;
+		for(size_t i=0; i<header.properties.size(); i++)
+			pointSize += size_t(header.properties[i].size) * header.properties[i].count;
 
-		// get rid of white spaces before/after
-		boost::trim (line);
-
-		// ignore comments or empty line
-		if (line.substr(0,1) == "#" || line == "")
+		// the LZF compressed data holds the fields one after the other, so it is decompressed at once
+		// like the data, the sizes are little endian
+		const uint32_t compressedSize = readScalar<uint32_t>(is, BINARY_UINT32, isBigEndian, "PCD");
+		const uint32_t uncompressedSize = readScalar<uint32_t>(is, BINARY_UINT32, isBigEndian, "PCD");
+		if(uncompressedSize != size_t(header.nbPoints) * pointSize)
 		{
-			lineNum++;
-			continue;
+			stringstream ss;
+			ss << "PCD Parse Error: the uncompressed data size (" << uncompressedSize << ") does not match the specified number of points (" << header.nbPoints << ")";
+			throw runtime_error(ss.str());
 		}
 
-		vector<string> tokens;
-		boost::split(tokens, line, boost::is_any_of("\t\r "), boost::token_compress_on);
+		vector<char> compressed(compressedSize);
+		if(!is.read(compressed.data(), compressedSize))
+			throw runtime_error("PCD Parse Error: the compressed data is truncated");
+		state.uncompressed.resize(uncompressedSize);
+		if(lzfDecompress(compressed.data(), compressedSize, state.uncompressed.data(), uncompressedSize) != uncompressedSize)
+			throw runtime_error("PCD Parse Error: the decompressed data is truncated");
+	}
 
+	return state;
+}
 
-		if (tokens.size() != totalDim)
-			throw runtime_error(string("PCD Parse Error: number of data columns does not match number of fields at line: ") + boost::lexical_cast<string>(lineNum));
+//! @brief Parse the next count points of a PCD file into the first columns of the matrices
+//! @see readPCDHeader()
+template<typename T>
+void PointMatcherIO<T>::readPCDPoints(std::istream& is, PCDState& state, Matrix& features, Matrix& descriptors, Int64Matrix& times, const unsigned count) {
+	const PCDheader& header = state.header;
+	const unsigned int nbPoints = header.nbPoints;
+	if (state.nextPoint + count > nbPoints)
+		throw runtime_error("PCD Implementation Error: reading more points than specified in the header");
 
-		unsigned int fileCol = 0;
-		for(size_t i=0; i<header.properties.size(); i++)
-		{
-			const unsigned int count = header.properties[i].count;
-			const unsigned int row = header.properties[i].pmRowID;
-			const PMPropTypes type = header.properties[i].pmType;
+	size_t col = 0; // point count
+	if (header.dataType != "ascii")
+	{
+		// decoding information for every field
+		const size_t nbProp = header.properties.size();
+		vector<BinaryScalarType> types(nbProp);
+		vector<size_t> offsets(nbProp);
+		size_t pointSize = 0;
+		for(size_t i=0; i<nbProp; i++)
+		{
+			const PCDproperty& prop = header.properties[i];
+			if(prop.pmType == UNSUPPORTED)
+				types[i] = BINARY_UINT8;
+			else
+				types[i] = getPCDScalarType(prop.type, prop.size);
+			offsets[i] = pointSize;
+			pointSize += size_t(prop.size) * prop.count;
+		}
 
+		// binary data is little endian, as written by PCL
+		const bool swapBytes = isBigEndian;
 
-			for(size_t j=0; j<count; j++)
+		// store the values of field i of a point, the j-th value being at data + j*step
+		const auto store = [&](const size_t i, const size_t point, const char* data, const size_t step)
+		{
+			const PCDproperty& prop = header.properties[i];
+			for(size_t j=0; j<prop.count; j++, data += step)
 			{
-				switch (type)
+				switch (prop.pmType)
 				{
 					case FEATURE:
-						features(row+j, col) = boost::lexical_cast<T>(tokens[fileCol]);
+						features(prop.pmRowID+j, point) = decodeScalar<T>(data, types[i], swapBytes);
 						break;
 					case DESCRIPTOR:
-						descriptors(row+j, col) = boost::lexical_cast<T>(tokens[fileCol]);
+						descriptors(prop.pmRowID+j, point) = decodeScalar<T>(data, types[i], swapBytes);
 						break;
 					case TIME:
-						times(row+j, col) = boost::lexical_cast<std::int64_t>(tokens[fileCol]);
+						times(prop.pmRowID+j, point) = decodeScalar<std::int64_t>(data, types[i], swapBytes);
 						break;
 					case UNSUPPORTED:
-						throw runtime_error("Implementation error in loadPCD(). This should not throw.");
-						break;
+						// padding
+						return;
 				}
-
-				fileCol++;
 			}
+		};
 
+		if (header.dataType == "binary")
+		{
+			// points are stored one after the other, we decode them by blocks
+			const size_t blockSize = 65536;
+			vector<char> buffer(min<size_t>(count, blockSize) * pointSize);
+			for(size_t begin = 0; begin < count; begin += blockSize)
+			{
+				const size_t end = min<size_t>(count, begin + blockSize);
+				if(!is.read(buffer.data(), (end - begin) * pointSize))
+				{
+					stringstream ss;
+					ss << "PCD Parse Error: the number of points in the file (" << state.nextPoint + begin + is.gcount() / pointSize << ") is less than the specified number of points (" << nbPoints << ")";
+					throw runtime_error(ss.str());
+				}
+				for(col = begin; col < end; col++)
+				{
+					const char* point = buffer.data() + (col - begin) * pointSize;
+					for(size_t i=0; i<nbProp; i++)
+						store(i, col, point + offsets[i], header.properties[i].size);
+				}
+			}
+		}
+		else
+		{
+			// fields are stored one after the other in the decompressed data
+			size_t fieldBegin = 0;
+			for(size_t i=0; i<nbProp; i++)
+			{
+				const size_t fieldSize = size_t(header.properties[i].size) * header.properties[i].count;
+				for(col = 0; col < count; col++)
+					store(i, col, state.uncompressed.data() + fieldBegin + (state.nextPoint + col) * fieldSize, header.properties[i].size);
+				fieldBegin += fieldSize * nbPoints;
+			}
 		}
-
-		col++;
-		lineNum++;
 	}
-
-	if (col != nbPoints)
+	else
 	{
-		stringstream ss;
-		ss << "PCD Parse Error: the number of points in the file (" << col << ") is less than the specified number of points (" << nbPoints << ")";
-		throw runtime_error(ss.str());
-	}
+		const unsigned int totalDim = state.featureLabels.totalDim() + state.descriptorLabels.totalDim() + state.timeLabels.totalDim();
+		string line;
+		while (col < count && safeGetLine(is, line))
+		{
 
-	///////////////////////////
-	// 5- ASSEMBLE FINAL DATAPOINTS
-	
-	DataPoints loadedPoints(features, featLabelGen.getLabels());
+			// get rid of white spaces before/after
+			boost::trim (line);
 
-	if (descriptors.rows() > 0)
-	{
-		loadedPoints.descriptors = descriptors;
-		loadedPoints.descriptorLabels = descLabelGen.getLabels();
-	}
+			// ignore comments or empty line
+			if (line.substr(0,1) == "#" || line == "")
+			{
+				state.lineNum++;
+				continue;
+			}
 
-	if(times.rows() > 0)
-	{
-		loadedPoints.times = times;
-		loadedPoints.timeLabels = timeLabelGen.getLabels();	
+			vector<string> tokens;
+			boost::split(tokens, line, boost::is_any_of("\t\r "), boost::token_compress_on);
+
+
+			if (tokens.size() != totalDim)
+				throw runtime_error(string("PCD Parse Error: number of data columns does not match number of fields at line: ") + boost::lexical_cast<string>(state.lineNum));
+
+			unsigned int fileCol = 0;
+			for(size_t i=0; i<header.properties.size(); i++)
+			{
+				const unsigned int fieldCount = header.properties[i].count;
+				const unsigned int row = header.properties[i].pmRowID;
+				const PMPropTypes type = header.properties[i].pmType;
+
+
+				for(size_t j=0; j<fieldCount; j++)
+				{
+					switch (type)
+					{
+						case FEATURE:
+							features(row+j, col) = boost::lexical_cast<T>(tokens[fileCol]);
+							break;
+						case DESCRIPTOR:
+							descriptors(row+j, col) = boost::lexical_cast<T>(tokens[fileCol]);
+							break;
+						case TIME:
+							times(row+j, col) = boost::lexical_cast<std::int64_t>(tokens[fileCol]);
+							break;
+						case UNSUPPORTED:
+							throw runtime_error("Implementation error in loadPCD(). This should not throw.");
+							break;
+					}
+
+					fileCol++;
+				}
+
+			}
+
+			col++;
+			state.lineNum++;
+		}
 	}
 
-	// Ensure homogeous coordinates
-	if(!loadedPoints.featureExists("pad"))
+	if (col != count)
 	{
-		loadedPoints.addFeature("pad", Matrix::Ones(1,features.cols()));
+		stringstream ss;
+		ss << "PCD Parse Error: the number of points in the file (" << state.nextPoint + col << ") is less than the specified number of points (" << nbPoints << ")";
+		throw runtime_error(ss.str());
 	}
-
-	return loadedPoints;
+	state.nextPoint += count;
 }
 
 template<typename T>
 void PointMatcherIO<T>::savePCD(const DataPoints& data,
-		const std::string& fileName) {
-	ofstream ofs(fileName.c_str());
+		const std::string& fileName, bool binary) {
+	ofstream ofs(fileName.c_str(), std::ios::binary);
 	if (!ofs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 
@@ -2290,10 +2778,12 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 		ofs << "\n";
 	}
 
+	// binary files store the native scalar type, in little endian
+	const int size(binary ? sizeof(T) : 4);
 	ofs << "SIZE";
 	for (int i =0; i < featCount - 1 + descCount; i++)
 	{
-		ofs << " 4"; // for float
+		ofs << " " << size;
 	}
 	ofs << "\n";
 
@@ -2321,6 +2811,32 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 	ofs << "WIDTH " << pointCount << "\n";
 	ofs << "HEIGHT 1\n";
 	ofs << "POINTS " << pointCount << "\n";
+
+	if (binary)
+	{
+		ofs << "DATA binary\n";
+
+		// write points by blocks of interleaved features and descriptors
+		const int pointDim(featCount - 1 + descRows);
+		const int blockSize(65536);
+		Matrix block(pointDim, min(pointCount, blockSize));
+		for (int begin = 0; begin < pointCount; begin += blockSize)
+		{
+			const int count(min(pointCount - begin, blockSize));
+			block.topLeftCorner(featCount - 1, count) = data.features.block(0, begin, featCount - 1, count);
+			block.bottomLeftCorner(descRows, count) = data.descriptors.middleCols(begin, count);
+			if (isBigEndian)
+			{
+				char* bytes(reinterpret_cast<char*>(block.data()));
+				for (int i = 0; i < pointDim * count; ++i)
+					std::reverse(bytes + i * sizeof(T), bytes + (i + 1) * sizeof(T));
+			}
+			ofs.write(reinterpret_cast<const char*>(block.data()), sizeof(T) * pointDim * count);
+		}
+		ofs.close();
+		return;
+	}
+
 	ofs << "DATA ascii\n";
 
 	// write points
@@ -2345,9 +2861,430 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 }
 
 template
-void PointMatcherIO<float>::savePCD(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<float>::savePCD(const DataPoints& data, const std::string& fileName, bool binary);
 template
-void PointMatcherIO<double>::savePCD(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<double>::savePCD(const DataPoints& data, const std::string& fileName, bool binary);
+
+
+
+namespace
+{
+	//! Magic string starting every PMD file
+	const char pmdMagic[6] = {'P', 'M', 'D', 'A', 'T', 'A'};
+	//! Version of the PMD format
+	const uint8_t pmdVersion = 1;
+	//! Written in the platform endianness, to detect files written on platforms with another one
+	const uint32_t pmdEndiannessMarker = 0x01020304;
+	//! Alignment of the data buffers in the file
+	const uint64_t pmdAlignment = 64;
+
+	//! Bounds-checked reader over the header of a mapped PMD file
+	struct PMDHeaderReader
+	{
+		const char* data;
+		size_t size;
+		size_t pos;
+
+		PMDHeaderReader(const char* data, const size_t size): data(data), size(size), pos(0) {}
+
+		void read(void* value, const size_t valueSize)
+		{
+			if (pos + valueSize > size)
+				throw runtime_error("PMD parse error: truncated header");
+			memcpy(value, data + pos, valueSize);
+			pos += valueSize;
+		}
+
+		template<typename S>
+		S read()
+		{
+			S value;
+			read(&value, sizeof(S));
+			return value;
+		}
+
+		//! Read a string stored after its length, checking the length before allocating the string
+		string readString()
+		{
+			const uint32_t length = read<uint32_t>();
+			if (length > size - pos)
+				throw runtime_error("PMD parse error: truncated header");
+			const string text(data + pos, length);
+			pos += length;
+			return text;
+		}
+	};
+
+	//! Return the size of a buffer of rows by cols scalars of scalarSize bytes, checking that it does not overflow
+	size_t getPMDBufferSize(const size_t rows, const size_t cols, const size_t scalarSize)
+	{
+		const size_t maxSize = numeric_limits<size_t>::max();
+		if (rows != 0 && cols > maxSize / rows)
+			throw runtime_error("PMD parse error: buffer size overflow");
+		const size_t count = rows * cols;
+		if (count != 0 && scalarSize > maxSize / count)
+			throw runtime_error("PMD parse error: buffer size overflow");
+		return count * scalarSize;
+	}
+}
+
+template<typename T>
+struct PointMatcherIO<T>::MappedDataPoints::Mapping
+{
+	boost::interprocess::file_mapping file;
+	boost::interprocess::mapped_region region;
+};
+
+//! @brief Map a native binary point cloud (pmd) file in memory
+//! @param fileName a string containing the path and the file name
+template<typename T>
+PointMatcherIO<T>::MappedDataPoints::MappedDataPoints(const std::string& fileName):
+	mapping(new Mapping),
+	featuresData(nullptr),
+	descriptorsData(nullptr),
+	timesData(nullptr),
+	nbPoints(0)
+{
+	try
+	{
+		mapping->file = boost::interprocess::file_mapping(fileName.c_str(), boost::interprocess::read_only);
+		mapping->region = boost::interprocess::mapped_region(mapping->file, boost::interprocess::read_only);
+	}
+	catch (const boost::interprocess::interprocess_exception& e)
+	{
+		throw runtime_error(string("Cannot open file ") + fileName + string(": ") + e.what());
+	}
+	const char* data = static_cast<const char*>(mapping->region.get_address());
+	const size_t size = mapping->region.get_size();
+
+	PMDHeaderReader reader(data, size);
+	char magic[sizeof(pmdMagic)];
+	reader.read(magic, sizeof(magic));
+	if (memcmp(magic, pmdMagic, sizeof(pmdMagic)) != 0)
+		throw runtime_error("PMD parse error: wrong magic header in file " + fileName);
+	if (reader.read<uint8_t>() != pmdVersion)
+		throw runtime_error("PMD parse error: unsupported version in file " + fileName);
+	const uint8_t scalarSize = reader.read<uint8_t>();
+	if (scalarSize != sizeof(T))
+		throw runtime_error((boost::format("PMD parse error: the file stores scalars of %1% bytes, it cannot be mapped with scalars of %2% bytes") % unsigned(scalarSize) % sizeof(T)).str());
+	if (reader.read<uint32_t>() != pmdEndiannessMarker)
+		throw runtime_error("PMD parse error: the file was written on a platform with a different endianness");
+
+	const uint64_t pointCount = reader.read<uint64_t>();
+	if (pointCount > numeric_limits<unsigned>::max())
+		throw runtime_error("PMD parse error: too many points");
+	nbPoints = pointCount;
+	const uint64_t featuresOffset = reader.read<uint64_t>();
+	const uint64_t descriptorsOffset = reader.read<uint64_t>();
+	const uint64_t timesOffset = reader.read<uint64_t>();
+
+	Labels* labels[3] = {&featureLabels, &descriptorLabels, &timeLabels};
+	for (int i = 0; i < 3; ++i)
+	{
+		const uint32_t labelCount = reader.read<uint32_t>();
+		for (uint32_t j = 0; j < labelCount; ++j)
+		{
+			const string text(reader.readString());
+			const uint64_t span = reader.read<uint64_t>();
+			labels[i]->push_back(Label(text, span));
+		}
+	}
 
+	// check that the buffers lie in the file
+	const uint64_t offsets[3] = {featuresOffset, descriptorsOffset, timesOffset};
+	const uint64_t sizes[3] = {
+		getPMDBufferSize(featureLabels.totalDim(), pointCount, sizeof(T)),
+		getPMDBufferSize(descriptorLabels.totalDim(), pointCount, sizeof(T)),
+		getPMDBufferSize(timeLabels.totalDim(), pointCount, sizeof(std::int64_t))
+	};
+	for (int i = 0; i < 3; ++i)
+	{
+		if (offsets[i] < reader.pos || offsets[i] > size || sizes[i] > size - offsets[i])
+			throw runtime_error("PMD parse error: truncated data in file " + fileName);
+	}
 
+	featuresData = reinterpret_cast<const T*>(data + featuresOffset);
+	descriptorsData = reinterpret_cast<const T*>(data + descriptorsOffset);
+	timesData = reinterpret_cast<const std::int64_t*>(data + timesOffset);
+}
 
+template<typename T>
+typename PointMatcherIO<T>::MappedDataPoints::ConstMatrixMap PointMatcherIO<T>::MappedDataPoints::features() const
+{
+	return ConstMatrixMap(featuresData, featureLabels.totalDim(), nbPoints);
+}
+
+template<typename T>
+typename PointMatcherIO<T>::MappedDataPoints::ConstMatrixMap PointMatcherIO<T>::MappedDataPoints::descriptors() const
+{
+	return ConstMatrixMap(descriptorsData, descriptorLabels.totalDim(), nbPoints);
+}
+
+template<typename T>
+typename PointMatcherIO<T>::MappedDataPoints::ConstInt64MatrixMap PointMatcherIO<T>::MappedDataPoints::times() const
+{
+	return ConstInt64MatrixMap(timesData, timeLabels.totalDim(), nbPoints);
+}
+
+template<typename T>
+unsigned PointMatcherIO<T>::MappedDataPoints::getNbPoints() const
+{
+	return nbPoints;
+}
+
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::MappedDataPoints::toDataPoints() const
+{
+	return DataPoints(features(), featureLabels, descriptors(), descriptorLabels, times(), timeLabels);
+}
+
+template
+class PointMatcherIO<float>::MappedDataPoints;
+template
+class PointMatcherIO<double>::MappedDataPoints;
+
+//! @brief Load a native binary point cloud (pmd) file
+//! @param fileName a string containing the path and the file name
+//!
+//! The file is mapped in memory and its buffers are copied in the returned DataPoints.
+//! Use MappedDataPoints to access the data without copy.
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPMD(const std::string& fileName)
+{
+	return MappedDataPoints(fileName).toDataPoints();
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPMD(const std::string& fileName);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPMD(const std::string& fileName);
+
+template<typename T>
+void PointMatcherIO<T>::savePMD(const DataPoints& data, const std::string& fileName)
+{
+	ofstream ofs(fileName.c_str(), std::ios::binary);
+	if (!ofs.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+
+	std::string header(pmdMagic, sizeof(pmdMagic));
+	const auto append = [&header](const void* value, const size_t size)
+	{
+		header.append(static_cast<const char*>(value), size);
+	};
+	const uint8_t scalarSize = sizeof(T);
+	const uint64_t pointCount = data.getNbPoints();
+	append(&pmdVersion, sizeof(pmdVersion));
+	append(&scalarSize, sizeof(scalarSize));
+	append(&pmdEndiannessMarker, sizeof(pmdEndiannessMarker));
+	append(&pointCount, sizeof(pointCount));
+
+	// offsets are filled once the labels are written
+	const size_t offsetsPos = header.size();
+	header.append(3 * sizeof(uint64_t), '\0');
+
+	const Labels* labels[3] = {&data.featureLabels, &data.descriptorLabels, &data.timeLabels};
+	for (int i = 0; i < 3; ++i)
+	{
+		const uint32_t labelCount = labels[i]->size();
+		append(&labelCount, sizeof(labelCount));
+		for (uint32_t j = 0; j < labelCount; ++j)
+		{
+			const Label& label = (*labels[i])[j];
+			const uint32_t textSize = label.text.size();
+			const uint64_t span = label.span;
+			append(&textSize, sizeof(textSize));
+			header.append(label.text);
+			append(&span, sizeof(span));
+		}
+	}
+
+	// buffers start on aligned offsets
+	const auto align = [](const uint64_t offset) { return (offset + pmdAlignment - 1) / pmdAlignment * pmdAlignment; };
+	const uint64_t sizes[3] = {
+		uint64_t(data.features.size()) * sizeof(T),
+		uint64_t(data.descriptors.size()) * sizeof(T),
+		uint64_t(data.times.size()) * sizeof(std::int64_t)
+	};
+	const char* buffers[3] = {
+		reinterpret_cast<const char*>(data.features.data()),
+		reinterpret_cast<const char*>(data.descriptors.data()),
+		reinterpret_cast<const char*>(data.times.data())
+	};
+	uint64_t offsets[3];
+	offsets[0] = align(header.size());
+	offsets[1] = align(offsets[0] + sizes[0]);
+	offsets[2] = align(offsets[1] + sizes[1]);
+	memcpy(&header[offsetsPos], offsets, sizeof(offsets));
+
+	ofs.write(header.data(), header.size());
+	uint64_t pos = header.size();
+	for (int i = 0; i < 3; ++i)
+	{
+		const std::string padding(offsets[i] - pos, '\0');
+		ofs.write(padding.data(), padding.size());
+		ofs.write(buffers[i], sizes[i]);
+		pos = offsets[i] + sizes[i];
+	}
+
+	if (!ofs.good())
+		throw runtime_error(string("Cannot write file ") + fileName);
+	ofs.close();
+}
+
+template
+void PointMatcherIO<float>::savePMD(const DataPoints& data, const std::string& fileName);
+template
+void PointMatcherIO<double>::savePMD(const DataPoints& data, const std::string& fileName);
+
+
+//! @brief Open a point cloud file to read it by chunks of at most chunkSize points
+//! @param fileName a string containing the path and the file name, with a .ply, .pcd or .pmd extension
+//! @param chunkSize the maximum number of points in a chunk
+template<typename T>
+PointMatcherIO<T>::DataPointsChunkReader::DataPointsChunkReader(const std::string& fileName, const unsigned chunkSize):
+	chunkSize(chunkSize),
+	nbPoints(0),
+	nextPoint(0)
+{
+	if (chunkSize == 0)
+		throw runtime_error("DataPointsChunkReader: chunk size must be strictly positive");
+
+	const boost::filesystem::path path(fileName);
+	const string& ext(boost::filesystem::extension(path));
+	if (boost::iequals(ext, ".pmd"))
+	{
+		format = PMD;
+		mapped.reset(new MappedDataPoints(fileName));
+		nbPoints = mapped->getNbPoints();
+		return;
+	}
+	else if (boost::iequals(ext, ".ply"))
+		format = PLY;
+	else if (boost::iequals(ext, ".pcd"))
+		format = PCD;
+	else
+		throw runtime_error("DataPointsChunkReader: Unsupported extension \"" + ext + "\" for file \"" + fileName + "\", streaming only supports \".ply\", \".pcd\" and \".pmd\"");
+
+	stream.reset(new ifstream(fileName.c_str(), std::ios::binary));
+	if (!stream->good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+
+	if (format == PLY)
+	{
+		plyHeader = readPLYHeader(*stream);
+		nbPoints = plyHeader.nbPoints;
+	}
+	else
+	{
+		pcdState = readPCDHeader(*stream);
+		nbPoints = pcdState.header.nbPoints;
+	}
+}
+
+//! @brief Read the next chunk of points
+//! @param chunk the DataPoints receiving the points, with the labels of the file
+//! @return false if all points of the file were already read, chunk being left untouched
+template<typename T>
+bool PointMatcherIO<T>::DataPointsChunkReader::read(DataPoints& chunk)
+{
+	if (nextPoint >= nbPoints)
+		return false;
+
+	const unsigned count = std::min(chunkSize, nbPoints - nextPoint);
+	if (format == PMD)
+	{
+		chunk = DataPoints(
+			mapped->features().middleCols(nextPoint, count), mapped->featureLabels,
+			mapped->descriptors().middleCols(nextPoint, count), mapped->descriptorLabels,
+			mapped->times().middleCols(nextPoint, count), mapped->timeLabels
+		);
+	}
+	else if (format == PLY)
+	{
+		Matrix features(plyHeader.featureLabels.totalDim(), count);
+		Matrix descriptors(plyHeader.descriptorLabels.totalDim(), count);
+		Int64Matrix times(plyHeader.timeLabels.totalDim(), count);
+		readPLYVertices(*stream, plyHeader, features, descriptors, times, count);
+		chunk = assembleDataPoints<T>(features, plyHeader.featureLabels, descriptors, plyHeader.descriptorLabels, times, plyHeader.timeLabels);
+	}
+	else
+	{
+		Matrix features(pcdState.featureLabels.totalDim(), count);
+		Matrix descriptors(pcdState.descriptorLabels.totalDim(), count);
+		Int64Matrix times(pcdState.timeLabels.totalDim(), count);
+		readPCDPoints(*stream, pcdState, features, descriptors, times, count);
+		chunk = assembleDataPoints<T>(features, pcdState.featureLabels, descriptors, pcdState.descriptorLabels, times, pcdState.timeLabels);
+	}
+	nextPoint += count;
+	return true;
+}
+
+template<typename T>
+unsigned PointMatcherIO<T>::DataPointsChunkReader::getNbPoints() const
+{
+	return nbPoints;
+}
+
+template
+class PointMatcherIO<float>::DataPointsChunkReader;
+template
+class PointMatcherIO<double>::DataPointsChunkReader;
+
+//! @brief Load a point cloud by chunks, filtering every chunk before reading the next one
+//! @param fileName a string containing the path and the file name, with a .ply, .pcd or .pmd extension
+//! @param filters the filters to apply, they must all process the points independently of each other
+//! @param chunkSize the maximum number of points read at once
+//!
+//! Only the filtered points are kept in memory, which allows to decimate clouds larger than memory.
+//! For deterministic filters, the result is the same as loading the whole cloud and applying the filters.
+//! Random filters draw independently in every chunk, so their result is only statistically equivalent.
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadFiltered(const std::string& fileName, typename PointMatcher<T>::DataPointsFilters& filters, const unsigned chunkSize)
+{
+	for (typename PointMatcher<T>::DataPointsFiltersIt it = filters.begin(); it != filters.end(); ++it)
+	{
+		if (!(*it)->isChunkSafe())
+			throw runtime_error("loadFiltered(): filter " + (*it)->className + " depends on neighboring points and cannot be applied by chunks");
+	}
+	filters.init();
+
+	DataPointsChunkReader reader(fileName, chunkSize);
+	vector<DataPoints> chunks;
+	DataPoints chunk;
+	size_t nbPoints = 0;
+	while (reader.read(chunk))
+	{
+		for (typename PointMatcher<T>::DataPointsFiltersIt it = filters.begin(); it != filters.end() && chunk.getNbPoints() > 0; ++it)
+			(*it)->inPlaceFilter(chunk);
+		if (chunk.getNbPoints() == 0)
+			continue;
+		nbPoints += chunk.getNbPoints();
+		// the filtered chunk is moved rather than copied, the reader assigns a new one
+		chunks.push_back(std::move(chunk));
+	}
+
+	if (chunks.empty())
+		return DataPoints();
+
+	DataPoints cloud(chunks[0].createSimilarEmpty(nbPoints));
+	size_t col = 0;
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		DataPoints& c(chunks[i]);
+		const unsigned n = c.getNbPoints();
+		cloud.features.middleCols(col, n) = c.features;
+		if (cloud.descriptors.rows() > 0)
+			cloud.descriptors.middleCols(col, n) = c.descriptors;
+		if (cloud.times.rows() > 0)
+			cloud.times.middleCols(col, n) = c.times;
+		col += n;
+		// release every chunk once copied
+		c = DataPoints();
+	}
+	return cloud;
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadFiltered(const std::string& fileName, PointMatcher<float>::DataPointsFilters& filters, const unsigned chunkSize);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadFiltered(const std::string& fileName, PointMatcher<double>::DataPointsFilters& filters, const unsigned chunkSize);
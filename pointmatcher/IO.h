@@ -218,13 +218,53 @@ struct PointMatcherIO
 	static DataPoints loadPLY(const std::string& fileName);
 	static DataPoints loadPLY(std::istream& is);
 
-	static void savePLY(const DataPoints& data, const std::string& fileName); //!< save datapoints to PLY point cloud format
+	static void savePLY(const DataPoints& data, const std::string& fileName, bool binary = false); //!< save datapoints to PLY point cloud format, in ASCII or in the platform binary format
 
 	// PCD
 	static DataPoints loadPCD(const std::string& fileName);
 	static DataPoints loadPCD(std::istream& is);
 
-	static void savePCD(const DataPoints& data, const std::string& fileName); //!< save datapoints to PCD point cloud format
+	static void savePCD(const DataPoints& data, const std::string& fileName, bool binary = false); //!< save datapoints to PCD point cloud format, in ASCII or binary
+
+	// PMD
+	static DataPoints loadPMD(const std::string& fileName);
+
+	static void savePMD(const DataPoints& data, const std::string& fileName); //!< save datapoints to the native binary point cloud format
+
+	//! Read-only view on a point cloud stored in the native binary format (PMD), mapped in memory
+	/**
+		A PMD file holds the labels of a DataPoints followed by the raw column-major buffers of its
+		features, descriptors and times. The file is mapped in memory, and the matrices are exposed
+		as Eigen maps on the mapping without any parsing or copy. The mapping is released when the
+		last copy of this object is destroyed.
+	*/
+	class MappedDataPoints
+	{
+	public:
+		typedef Eigen::Map<const Matrix> ConstMatrixMap; //!< alias
+		typedef Eigen::Map<const Int64Matrix> ConstInt64MatrixMap; //!< alias
+
+		MappedDataPoints(const std::string& fileName);
+
+		ConstMatrixMap features() const; //!< features, as stored in the file
+		ConstMatrixMap descriptors() const; //!< descriptors, as stored in the file
+		ConstInt64MatrixMap times() const; //!< times, as stored in the file
+		unsigned getNbPoints() const; //!< number of points
+
+		DataPoints toDataPoints() const; //!< copy the mapped cloud into a DataPoints
+
+		Labels featureLabels; //!< labels of the features
+		Labels descriptorLabels; //!< labels of the descriptors
+		Labels timeLabels; //!< labels of the times
+
+	private:
+		struct Mapping;
+		std::shared_ptr<Mapping> mapping; //!< memory mapping of the file
+		const T* featuresData; //!< start of the features in the mapping
+		const T* descriptorsData; //!< start of the descriptors in the mapping
+		const std::int64_t* timesData; //!< start of the times in the mapping
+		unsigned nbPoints; //!< number of points
+	};
 
 	//! Information to exploit a reading from a file using this library. Fields might be left blank if unused.
 	struct FileInfo
@@ -360,6 +400,23 @@ struct PointMatcherIO
 		static PLYElement* createElement(const std::string& elem_name, const int elem_num, const unsigned offset); //!< factory function, build element defined by name with elem_num elements
 	};
 
+	//! Information parsed from the header of a PLY file, required to read its vertices
+	struct PLYHeader
+	{
+		PLYProperties vertexProperties; //!< properties of the vertex element, assigned to DataPoints rows
+		unsigned nbPoints; //!< number of vertices
+		bool binary; //!< whether the data is binary
+		bool swapBytes; //!< whether the endianness of the binary data differs from the platform one
+		Labels featureLabels; //!< labels of the features
+		Labels descriptorLabels; //!< labels of the descriptors
+		Labels timeLabels; //!< labels of the times
+	};
+
+	//! Parse the header of a PLY file, and position the stream on the first vertex
+	static PLYHeader readPLYHeader(std::istream& is);
+	//! Parse the next count vertices of a PLY file, into the first columns of the matrices
+	static void readPLYVertices(std::istream& is, const PLYHeader& header, Matrix& features, Matrix& descriptors, Int64Matrix& times, const unsigned count);
+
 	//! Information for a PCD property
 	struct PCDproperty
 	{
@@ -393,7 +450,7 @@ struct PointMatcherIO
 		unsigned int height; //!< height of sensor matrix
 		Eigen::Matrix<T, 7, 1> viewPoint;  //!< not used
 		unsigned int nbPoints; //!< number of points, same as width*height
-		std::string dataType; //!< ascii or binary
+		std::string dataType; //!< ascii, binary or binary_compressed
 
 		PCDheader()
 		{
@@ -405,6 +462,52 @@ struct PointMatcherIO
 			dataType = "-";
 		};
 	};
+
+	//! Information parsed from the header of a PCD file, and position of the reading in the data
+	struct PCDState
+	{
+		PCDheader header; //!< header, with the properties assigned to DataPoints rows
+		Labels featureLabels; //!< labels of the features
+		Labels descriptorLabels; //!< labels of the descriptors
+		Labels timeLabels; //!< labels of the times
+		size_t lineNum; //!< current line in ASCII files
+		unsigned nextPoint; //!< index of the next point to read
+		std::vector<char> uncompressed; //!< decompressed data of binary_compressed files
+	};
+
+	//! Parse the header of a PCD file, and position the stream on the first point
+	static PCDState readPCDHeader(std::istream& is);
+	//! Parse the next count points of a PCD file, into the first columns of the matrices
+	static void readPCDPoints(std::istream& is, PCDState& state, Matrix& features, Matrix& descriptors, Int64Matrix& times, const unsigned count);
+
+	//! Reader of a point cloud file by chunks of points, to process clouds larger than memory
+	/**
+		Only PLY, PCD and PMD files can be read by chunks. Every chunk has the labels of the
+		full cloud, and the chunks cover the points of the file in order.
+	*/
+	class DataPointsChunkReader
+	{
+	public:
+		DataPointsChunkReader(const std::string& fileName, const unsigned chunkSize = 1000000);
+
+		bool read(DataPoints& chunk); //!< read the next chunk, return false if all points were already read
+		unsigned getNbPoints() const; //!< number of points in the file
+
+	private:
+		enum Format { PLY, PCD, PMD };
+
+		Format format; //!< format of the file
+		std::shared_ptr<std::istream> stream; //!< stream on the file, for PLY and PCD
+		PLYHeader plyHeader; //!< header, for PLY
+		PCDState pcdState; //!< header and reading state, for PCD
+		std::shared_ptr<MappedDataPoints> mapped; //!< mapping of the file, for PMD
+		unsigned chunkSize; //!< maximum number of points in a chunk
+		unsigned nbPoints; //!< number of points in the file
+		unsigned nextPoint; //!< index of the next point to read
+	};
+
+	//! Load a point cloud by chunks, applying filters to every chunk, all filters must be chunk safe
+	static DataPoints loadFiltered(const std::string& fileName, typename PointMatcher<T>::DataPointsFilters& filters, const unsigned chunkSize = 1000000);
 };
 
 
@@ -37,4 +37,26 @@ std::istream & safeGetLine( std::istream& is, std::string & t)
    }
 }
 
+std::string jsonString(const std::string& str)
+{
+	std::string quoted("\"");
+	for (const char c: str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			quoted += '\\';
+			quoted += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[7];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", int(c));
+			quoted += escaped;
+		}
+		else
+			quoted += c;
+	}
+	return quoted + '"';
+}
+
 }// namespace PointMatcherSupport
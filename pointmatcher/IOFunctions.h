@@ -157,6 +157,9 @@ std::istream & readVtkData(std::string dataType, bool readBinary, MatrixRef into
 //! Replaces getline for handling windows style CR/LF line endings
 std::istream & safeGetLine( std::istream& is, std::string & t);
 
+//! Return str quoted and escaped as a JSON string
+std::string jsonString(const std::string& str);
+
 
 } // PointMatcherSupport
 
@@ -74,6 +74,20 @@ template<typename T>
 void PointMatcher<T>::Inspector::dumpStatsHeader(std::ostream& stream)
 {}
 
+// timings of the stages
+
+//! Return whether this inspector records the timings of the stages, which are not measured otherwise
+template<typename T>
+bool PointMatcher<T>::Inspector::recordsTimings() const
+{
+	return false;
+}
+
+//! Add the timing of a stage, only called if recordsTimings() returns true
+template<typename T>
+void PointMatcher<T>::Inspector::addTiming(const StageTiming& timing)
+{}
+
 // data statistics 
 
 //! Dump the state of a given iteration
@@ -43,6 +43,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <boost/format.hpp>
 #include <boost/type_traits/is_same.hpp>
 
 using namespace std;
@@ -788,3 +791,161 @@ void InspectorsImpl<T>::VTKFileInspector::closeStream(std::ostream* stream)
 
 template struct InspectorsImpl<float>::VTKFileInspector;
 template struct InspectorsImpl<double>::VTKFileInspector;
+
+//-----------------------------------
+// Profiling inspector
+
+namespace
+{
+	//! Return the nearest-rank percentile of the values, which are reordered
+	double percentile(std::vector<double>& values, const double ratio)
+	{
+		const size_t rank(std::max<size_t>(1, size_t(std::ceil(ratio * values.size()))));
+		const auto nth(values.begin() + (rank - 1));
+		std::nth_element(values.begin(), nth, values.end());
+		return *nth;
+	}
+}
+
+template<typename T>
+InspectorsImpl<T>::ProfilingInspector::ProfilingInspector(const Parameters& params):
+	Inspector("ProfilingInspector", ProfilingInspector::availableParameters(), params),
+	ringSize(Parametrizable::get<unsigned>("ringSize")),
+	traceFileName(Parametrizable::get<string>("traceFileName")),
+	traceFormat(Parametrizable::get<string>("traceFormat")),
+	bDumpSummaryOnExit(Parametrizable::get<bool>("dumpSummaryOnExit")),
+	registrationCount(0),
+	traceStarted(false)
+{
+	if (traceFormat != "jsonl" && traceFormat != "chrome")
+		throw Parametrizable::InvalidParameter("ProfilingInspector: Error, traceFormat must be jsonl or chrome, not " + traceFormat);
+	
+	if (!traceFileName.empty())
+	{
+		traceStream.reset(new ofstream(traceFileName.c_str()));
+		if (traceStream->fail())
+			throw std::runtime_error("Couldn't open the file \"" + traceFileName + "\". Check if directory exist.");
+		if (traceFormat == "chrome")
+			*traceStream << "[\n";
+	}
+}
+
+template<typename T>
+InspectorsImpl<T>::ProfilingInspector::~ProfilingInspector()
+{
+	if (traceStream && traceFormat == "chrome")
+		*traceStream << "\n]\n";
+	if (bDumpSummaryOnExit)
+		dumpStats(std::cerr);
+}
+
+//! Count the registrations, the timings recorded afterwards belong to a new one
+template<typename T>
+void InspectorsImpl<T>::ProfilingInspector::init()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	++registrationCount;
+}
+
+template<typename T>
+bool InspectorsImpl<T>::ProfilingInspector::recordsTimings() const
+{
+	return true;
+}
+
+template<typename T>
+void InspectorsImpl<T>::ProfilingInspector::addTiming(const StageTiming& timing)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	Ring& ring(rings[StageKey(timing.stage, timing.module)]);
+	if (ring.durations.size() < ringSize)
+		ring.durations.push_back(timing.duration);
+	else
+		ring.durations[ring.next] = timing.duration;
+	ring.next = (ring.next + 1) % ringSize;
+	++ring.count;
+	ring.totalDuration += timing.duration;
+	ring.totalPointCount += timing.pointCount;
+	
+	if (traceStream)
+		writeTrace(timing);
+}
+
+//! Write timing to the trace file, the mutex must be held
+template<typename T>
+void InspectorsImpl<T>::ProfilingInspector::writeTrace(const StageTiming& timing)
+{
+	const auto threadIt(threadIds.insert(std::make_pair(std::this_thread::get_id(), unsigned(threadIds.size()))).first);
+	ostream& stream(*traceStream);
+	const std::streamsize precision(stream.precision(std::numeric_limits<double>::digits10));
+	if (traceFormat == "chrome")
+	{
+		const std::string name(timing.module.empty() ? timing.stage : timing.module);
+		if (traceStarted)
+			stream << ",\n";
+		stream << "{\"name\":" << jsonString(name) << ",\"cat\":" << jsonString(timing.stage) << ",\"ph\":\"X\"";
+		stream << ",\"ts\":" << timing.startTime * 1e6 << ",\"dur\":" << timing.duration * 1e6;
+		stream << ",\"pid\":0,\"tid\":" << threadIt->second;
+		stream << ",\"args\":{\"registration\":" << registrationCount << ",\"iteration\":" << timing.iteration << ",\"points\":" << timing.pointCount << "}}";
+	}
+	else
+	{
+		stream << "{\"registration\":" << registrationCount << ",\"iteration\":" << timing.iteration;
+		stream << ",\"stage\":" << jsonString(timing.stage) << ",\"module\":" << jsonString(timing.module);
+		stream << ",\"start\":" << timing.startTime << ",\"duration\":" << timing.duration;
+		stream << ",\"points\":" << timing.pointCount << ",\"thread\":" << threadIt->second << "}\n";
+	}
+	stream.precision(precision);
+	traceStarted = true;
+}
+
+//! Return the summary of every stage and module recorded, sorted by stage and module
+template<typename T>
+typename InspectorsImpl<T>::ProfilingInspector::StageSummaries InspectorsImpl<T>::ProfilingInspector::getSummaries() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	StageSummaries summaries;
+	summaries.reserve(rings.size());
+	for (const auto& entry: rings)
+	{
+		const Ring& ring(entry.second);
+		std::vector<double> durations(ring.durations);
+		StageSummary summary;
+		summary.stage = entry.first.first;
+		summary.module = entry.first.second;
+		summary.count = ring.count;
+		summary.totalDuration = ring.totalDuration;
+		summary.p50 = percentile(durations, 0.5);
+		summary.p95 = percentile(durations, 0.95);
+		summary.p99 = percentile(durations, 0.99);
+		summary.meanPointCount = ring.totalPointCount / ring.count;
+		summaries.push_back(summary);
+	}
+	return summaries;
+}
+
+//! Forget the timings recorded so far
+template<typename T>
+void InspectorsImpl<T>::ProfilingInspector::reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	rings.clear();
+}
+
+//! Dump the summary of every stage and module, one JSON object per line
+template<typename T>
+void InspectorsImpl<T>::ProfilingInspector::dumpStats(std::ostream& stream)
+{
+	for (const StageSummary& summary: getSummaries())
+	{
+		stream << "{\"stage\":" << jsonString(summary.stage) << ",\"module\":" << jsonString(summary.module);
+		stream << ",\"count\":" << summary.count << ",\"total\":" << summary.totalDuration;
+		stream << ",\"p50\":" << summary.p50 << ",\"p95\":" << summary.p95 << ",\"p99\":" << summary.p99;
+		stream << ",\"meanPoints\":" << summary.meanPointCount << "}\n";
+	}
+}
+
+template struct InspectorsImpl<float>::ProfilingInspector;
+template struct InspectorsImpl<double>::ProfilingInspector;
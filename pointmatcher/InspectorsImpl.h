@@ -39,6 +39,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PointMatcher.h"
 #include "Histogram.h"
 
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 template<typename T>
 struct InspectorsImpl
 {
@@ -49,6 +54,7 @@ struct InspectorsImpl
 	typedef Parametrizable::ParametersDoc ParametersDoc;
 	
 	typedef typename PointMatcher<T>::Inspector Inspector;
+	typedef typename Inspector::StageTiming StageTiming;
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
 	typedef typename PointMatcher<T>::Matches Matches;
 	typedef typename PointMatcher<T>::OutlierWeights OutlierWeights;
@@ -191,6 +197,76 @@ struct InspectorsImpl
 		virtual void init();
 		virtual void finish(const size_t iterationCount);
 	};
+
+	struct ProfilingInspector: public Inspector
+	{
+		inline static const std::string description()
+		{
+			return "Record the wall time and the point count of every stage and module of the registrations, per iteration. The last durations of every stage are kept in a ring buffer, from which percentiles are computed. The timings can also be written as JSON lines or as a Chrome trace, viewable in chrome://tracing or Perfetto.";
+		}
+		inline static const ParametersDoc availableParameters()
+		{
+			return {
+				{"ringSize", "number of durations kept per stage and module to compute the percentiles", "1024", "1", "2147483647", &P::Comp<unsigned>},
+				{"traceFileName", "file the timings are written to as they are recorded (if empty, disabled)", ""},
+				{"traceFormat", "format of the trace file, jsonl for one JSON object per line or chrome for the Chrome trace event format", "jsonl"},
+				{"dumpSummaryOnExit", "dump the summary of the timings to stderr on exit", "0"}
+			};
+		}
+		
+		const unsigned ringSize;
+		const std::string traceFileName;
+		const std::string traceFormat;
+		const bool bDumpSummaryOnExit;
+		
+		//! Summary of the timings of a stage and module, durations are in seconds
+		struct StageSummary
+		{
+			std::string stage; //!< name of the stage
+			std::string module; //!< class name of the module, empty for whole chains
+			size_t count; //!< number of timings recorded
+			double totalDuration; //!< sum of all durations recorded
+			double p50; //!< median of the durations in the ring buffer
+			double p95; //!< 95th percentile of the durations in the ring buffer
+			double p99; //!< 99th percentile of the durations in the ring buffer
+			double meanPointCount; //!< mean number of points given to the stage
+		};
+		typedef std::vector<StageSummary> StageSummaries;
+		
+	protected:
+		//! Last durations of a stage and module, and running totals
+		struct Ring
+		{
+			std::vector<double> durations;
+			size_t next = 0;
+			size_t count = 0;
+			double totalDuration = 0;
+			double totalPointCount = 0;
+		};
+		typedef std::pair<std::string, std::string> StageKey;
+		typedef std::map<StageKey, Ring> Rings;
+		
+		mutable std::mutex mutex;
+		Rings rings;
+		std::map<std::thread::id, unsigned> threadIds;
+		size_t registrationCount;
+		std::unique_ptr<std::ofstream> traceStream;
+		bool traceStarted;
+		
+		void writeTrace(const StageTiming& timing);
+		
+	public:
+		ProfilingInspector(const Parameters& params = Parameters());
+		virtual ~ProfilingInspector();
+		
+		virtual void init();
+		virtual bool recordsTimings() const;
+		virtual void addTiming(const StageTiming& timing);
+		virtual void dumpStats(std::ostream& stream);
+		
+		StageSummaries getSummaries() const;
+		void reset();
+	};
 }; // InspectorsImpl
 
 #endif // __POINTMATCHER_INSPECTORS_H
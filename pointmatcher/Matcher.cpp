@@ -72,5 +72,18 @@ unsigned long PointMatcher<T>::Matcher::getVisitCount() const
 	return visitCounter;
 }
 
+//! Add matcher-specific statistics collected since the last call to the inspector, and reset them
+template<typename T>
+void PointMatcher<T>::Matcher::addStats(Inspector& inspector)
+{
+}
+
+//! Return whether findClosests() can be called from several threads at once, which requires it not to keep state between calls
+template<typename T>
+bool PointMatcher<T>::Matcher::allowsConcurrentQueries() const
+{
+	return true;
+}
+
 template struct PointMatcher<float>::Matcher;
 template struct PointMatcher<double>::Matcher;
@@ -35,6 +35,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "MatchersImpl.h"
 #include "PointMatcherPrivate.h"
+#include "Functions.h"
+
+#include <limits>
+
+using namespace PointMatcherSupport;
 
 // NullMatcher
 template<typename T>
@@ -63,9 +68,10 @@ MatchersImpl<T>::KDTreeMatcher::KDTreeMatcher(const Parameters& params):
 	knn(Parametrizable::get<int>("knn")),
 	epsilon(Parametrizable::get<T>("epsilon")),
 	searchType(NNSearchType(Parametrizable::get<int>("searchType"))),
-	maxDist(Parametrizable::get<T>("maxDist"))
+	maxDist(Parametrizable::get<T>("maxDist")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
-	LOG_INFO_STREAM("* KDTreeMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << " and maxDist=" << maxDist);
+	LOG_INFO_STREAM("* KDTreeMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << ", maxDist=" << maxDist << " and nbThreads=" << nbThreads);
 }
 
 template<typename T>
@@ -95,7 +101,27 @@ typename PointMatcher<T>::Matches MatchersImpl<T>::KDTreeMatcher::findClosests(
 	
 	static_assert(NNS::InvalidIndex == Matches::InvalidId, "");
 	static_assert(NNS::InvalidValue == Matches::InvalidDist, "");
-	this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+	if (getThreadCount(nbThreads) <= 1)
+	{
+		this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+		return matches;
+	}
+
+	// Every point is searched independently, so querying the tree by chunks
+	// of columns gives the same result as a single query
+	std::vector<unsigned long> visitCounts(getThreadCount(nbThreads), 0);
+	parallelFor(pointsCount, nbThreads, [&](const size_t begin, const size_t end, const unsigned chunk)
+	{
+		const int count(end - begin);
+		const Matrix query(filteredReading.features.middleCols(begin, count));
+		typename Matches::Dists dists(knn, count);
+		typename Matches::Ids ids(knn, count);
+		visitCounts[chunk] = featureNNS->knn(query, ids, dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+		matches.dists.middleCols(begin, count) = dists;
+		matches.ids.middleCols(begin, count) = ids;
+	});
+	for (const unsigned long visitCount : visitCounts)
+		this->visitCounter += visitCount;
 
 	return matches;
 }
@@ -110,9 +136,10 @@ MatchersImpl<T>::KDTreeVarDistMatcher::KDTreeVarDistMatcher(const Parameters& pa
 	knn(Parametrizable::get<int>("knn")),
 	epsilon(Parametrizable::get<T>("epsilon")),
 	searchType(NNSearchType(Parametrizable::get<int>("searchType"))),
-	maxDistField(Parametrizable::getParamValueString("maxDistField"))
+	maxDistField(Parametrizable::getParamValueString("maxDistField")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
-	LOG_INFO_STREAM("* KDTreeVarDsitMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << " and maxDistField=" << maxDistField);
+	LOG_INFO_STREAM("* KDTreeVarDsitMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << ", maxDistField=" << maxDistField << " and nbThreads=" << nbThreads);
 }
 
 template<typename T>
@@ -144,10 +171,218 @@ typename PointMatcher<T>::Matches MatchersImpl<T>::KDTreeVarDistMatcher::findClo
 	
 	static_assert(NNS::InvalidIndex == Matches::InvalidId, "");
 	static_assert(NNS::InvalidValue == Matches::InvalidDist, "");
-	this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, maxDists.transpose(), knn, epsilon, NNS::ALLOW_SELF_MATCH);
+	if (getThreadCount(nbThreads) <= 1)
+	{
+		this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, maxDists.transpose(), knn, epsilon, NNS::ALLOW_SELF_MATCH);
+		return matches;
+	}
+
+	std::vector<unsigned long> visitCounts(getThreadCount(nbThreads), 0);
+	parallelFor(pointsCount, nbThreads, [&](const size_t begin, const size_t end, const unsigned chunk)
+	{
+		const int count(end - begin);
+		const Matrix query(filteredReading.features.middleCols(begin, count));
+		const Vector queryMaxDists(maxDists.middleCols(begin, count).transpose());
+		typename Matches::Dists dists(knn, count);
+		typename Matches::Ids ids(knn, count);
+		visitCounts[chunk] = featureNNS->knn(query, ids, dists, queryMaxDists, knn, epsilon, NNS::ALLOW_SELF_MATCH);
+		matches.dists.middleCols(begin, count) = dists;
+		matches.ids.middleCols(begin, count) = ids;
+	});
+	for (const unsigned long visitCount : visitCounts)
+		this->visitCounter += visitCount;
 
 	return matches;
 }
 
 template struct MatchersImpl<float>::KDTreeVarDistMatcher;
 template struct MatchersImpl<double>::KDTreeVarDistMatcher;
+
+// WarmStartKDTreeMatcher
+template<typename T>
+MatchersImpl<T>::WarmStartKDTreeMatcher::WarmStartKDTreeMatcher(const Parameters& params):
+	Matcher("WarmStartKDTreeMatcher", WarmStartKDTreeMatcher::availableParameters(), params),
+	knn(Parametrizable::get<int>("knn")),
+	epsilon(Parametrizable::get<T>("epsilon")),
+	searchType(NNSearchType(Parametrizable::get<int>("searchType"))),
+	maxDist(Parametrizable::get<T>("maxDist")),
+	neighborhoodSize(Parametrizable::get<int>("neighborhoodSize")),
+	hitCount(0),
+	missCount(0)
+{
+	LOG_INFO_STREAM("* WarmStartKDTreeMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << ", maxDist=" << maxDist << " and neighborhoodSize=" << neighborhoodSize);
+}
+
+template<typename T>
+MatchersImpl<T>::WarmStartKDTreeMatcher::~WarmStartKDTreeMatcher()
+{
+
+}
+
+template<typename T>
+void MatchersImpl<T>::WarmStartKDTreeMatcher::init(
+	const DataPoints& filteredReference)
+{
+	// build and populate NNS
+	featureNNS.reset( NNS::create(filteredReference.features, filteredReference.features.rows() - 1, searchType, NNS::TOUCH_STATISTICS));
+	
+	// previous matches were relative to another reference
+	lastReading.resize(0, 0);
+	lastMatches = Matches();
+	
+	// neighborhood of every reference point, the point itself being part of it
+	const int referenceCount(filteredReference.features.cols());
+	const int count(std::min(neighborhoodSize + 1, referenceCount));
+	if (neighborhoodSize == 0 || referenceCount == 0)
+	{
+		referenceNeighbors.resize(0, 0);
+		referenceNeighborhoodRadii.resize(0);
+		return;
+	}
+	
+	Matrix dists(count, referenceCount);
+	referenceNeighbors.resize(count, referenceCount);
+	featureNNS->knn(filteredReference.features, referenceNeighbors, dists, count, 0, NNS::ALLOW_SELF_MATCH);
+	
+	// every point outside of the neighborhood is at least at that radius
+	if (count == referenceCount)
+		referenceNeighborhoodRadii = Vector::Constant(referenceCount, std::numeric_limits<T>::infinity());
+	else
+		referenceNeighborhoodRadii = dists.row(count - 1).transpose().cwiseSqrt();
+}
+
+//! Try to find the neighbors of point i among its previous matches and their neighborhoods, return false if they might be elsewhere
+template<typename T>
+bool MatchersImpl<T>::WarmStartKDTreeMatcher::findFromLastMatches(
+	const DataPoints& filteredReading,
+	const int i,
+	std::vector<std::pair<T, int> >& candidates,
+	Matches& matches) const
+{
+	if (lastMatches.ids(knn - 1, i) == Matches::InvalidId)
+		return false;
+	
+	const int dim(lastReading.rows());
+	const Matrix& reference(featureNNS->cloud);
+	const auto point(filteredReading.features.col(i).head(dim));
+	
+	// Lower bound on the distance between the point and any reference point
+	// that is not a candidate. In an exact search, reference points that
+	// were not matched were farther than the last match.
+	T bound(-std::numeric_limits<T>::infinity());
+	if (epsilon == 0)
+		bound = std::sqrt(lastMatches.dists(knn - 1, i)) - (point - lastReading.col(i)).norm();
+	
+	candidates.clear();
+	for (int j = 0; j < knn; ++j)
+	{
+		const int id(lastMatches.ids(j, i));
+		const T dist2((reference.col(id).head(dim) - point).squaredNorm());
+		candidates.push_back(std::make_pair(dist2, id));
+		if (neighborhoodSize > 0)
+		{
+			// reference points outside of the neighborhood of id are farther from it than its radius
+			bound = std::max(bound, referenceNeighborhoodRadii(id) - std::sqrt(dist2));
+			for (int k = 0; k < referenceNeighbors.rows(); ++k)
+			{
+				const int neighbor(referenceNeighbors(k, id));
+				candidates.push_back(std::make_pair((reference.col(neighbor).head(dim) - point).squaredNorm(), neighbor));
+			}
+		}
+	}
+	if (bound <= 0)
+		return false;
+	
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	
+	const T lastDist2(candidates[knn - 1].first);
+	if (!(lastDist2 < bound * bound) || lastDist2 > maxDist * maxDist)
+		return false;
+	
+	for (int j = 0; j < knn; ++j)
+	{
+		matches.dists(j, i) = candidates[j].first;
+		matches.ids(j, i) = candidates[j].second;
+	}
+	return true;
+}
+
+template<typename T>
+typename PointMatcher<T>::Matches MatchersImpl<T>::WarmStartKDTreeMatcher::findClosests(
+	const DataPoints& filteredReading)
+{
+	const int pointsCount(filteredReading.features.cols());
+	const int dim(filteredReading.features.rows() - 1);
+	Matches matches(
+		typename Matches::Dists(knn, pointsCount),
+		typename Matches::Ids(knn, pointsCount)
+	);
+	
+	// Resolve as many points as possible from the previous call
+	std::vector<int> missed;
+	if (lastMatches.ids.cols() == pointsCount && lastReading.rows() == dim)
+	{
+		std::vector<std::pair<T, int> > candidates;
+		for (int i = 0; i < pointsCount; ++i)
+		{
+			if (!findFromLastMatches(filteredReading, i, candidates, matches))
+				missed.push_back(i);
+		}
+	}
+	else
+	{
+		missed.resize(pointsCount);
+		for (int i = 0; i < pointsCount; ++i)
+			missed[i] = i;
+	}
+	hitCount += pointsCount - missed.size();
+	missCount += missed.size();
+	
+	// Query the kd-tree for the remaining ones
+	static_assert(NNS::InvalidIndex == Matches::InvalidId, "");
+	static_assert(NNS::InvalidValue == Matches::InvalidDist, "");
+	if (int(missed.size()) == pointsCount)
+	{
+		this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+	}
+	else if (!missed.empty())
+	{
+		const int missedCount(missed.size());
+		Matrix query(filteredReading.features.rows(), missedCount);
+		for (int j = 0; j < missedCount; ++j)
+			query.col(j) = filteredReading.features.col(missed[j]);
+		typename Matches::Dists dists(knn, missedCount);
+		typename Matches::Ids ids(knn, missedCount);
+		this->visitCounter += featureNNS->knn(query, ids, dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+		for (int j = 0; j < missedCount; ++j)
+		{
+			matches.dists.col(missed[j]) = dists.col(j);
+			matches.ids.col(missed[j]) = ids.col(j);
+		}
+	}
+	
+	lastReading = filteredReading.features.topRows(dim);
+	lastMatches = matches;
+	
+	return matches;
+}
+
+template<typename T>
+void MatchersImpl<T>::WarmStartKDTreeMatcher::addStats(Inspector& inspector)
+{
+	inspector.addStat("WarmStartHitCount", hitCount);
+	inspector.addStat("WarmStartMissCount", missCount);
+	hitCount = 0;
+	missCount = 0;
+}
+
+//! This matcher starts from the matches of its previous call, so its calls must be sequential
+template<typename T>
+bool MatchersImpl<T>::WarmStartKDTreeMatcher::allowsConcurrentQueries() const
+{
+	return false;
+}
+
+template struct MatchersImpl<float>::WarmStartKDTreeMatcher;
+template struct MatchersImpl<double>::WarmStartKDTreeMatcher;
@@ -55,6 +55,8 @@ struct MatchersImpl
 	typedef typename Nabo::NearestNeighbourSearch<T> NNS;
 	typedef typename NNS::SearchType NNSearchType;
 	
+	typedef typename PointMatcher<T>::Vector Vector;
+	typedef typename PointMatcher<T>::Matrix Matrix;
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
 	typedef typename PointMatcher<T>::Matcher Matcher;
 	typedef typename PointMatcher<T>::Matches Matches;
@@ -83,7 +85,8 @@ struct MatchersImpl
 				{"knn", "number of nearest neighbors to consider it the reference", "1", "1", "2147483647", &P::Comp<unsigned>},
 				{"epsilon", "approximation to use for the nearest-neighbor search", "0", "0", "inf", &P::Comp<T>},
 				{"searchType", "Nabo search type. 0: brute force, check distance to every point in the data (very slow), 1: kd-tree with linear heap, good for small knn (~up to 30) and 2: kd-tree with tree heap, good for large knn (~from 30)", "1", "0", "2", &P::Comp<unsigned>},
-				{"maxDist", "maximum distance to consider for neighbors", "inf", "0", "inf", &P::Comp<T>}
+				{"maxDist", "maximum distance to consider for neighbors", "inf", "0", "inf", &P::Comp<T>},
+				{"nbThreads", "number of threads querying the kd-tree in parallel, 0 uses all hardware threads", "1", "0", "65535", &P::Comp<unsigned>}
 			};
 		}
 		
@@ -91,6 +94,7 @@ struct MatchersImpl
 		const T epsilon;
 		const NNSearchType searchType;
 		const T maxDist;
+		const unsigned nbThreads;
 
 	protected:
 		std::shared_ptr<NNS> featureNNS;
@@ -114,7 +118,8 @@ struct MatchersImpl
 				{"knn", "number of nearest neighbors to consider it the reference", "1", "1", "2147483647", &P::Comp<unsigned>},
 				{"epsilon", "approximation to use for the nearest-neighbor search", "0", "0", "inf", &P::Comp<T>},
 				{"searchType", "Nabo search type. 0: brute force, check distance to every point in the data (very slow), 1: kd-tree with linear heap, good for small knn (~up to 30) and 2: kd-tree with tree heap, good for large knn (~from 30)", "1", "0", "2", &P::Comp<unsigned>},
-				{"maxDistField", "descriptor field name used to set a maximum distance to consider for neighbors per point", "maxSearchDist"}
+				{"maxDistField", "descriptor field name used to set a maximum distance to consider for neighbors per point", "maxSearchDist"},
+				{"nbThreads", "number of threads querying the kd-tree in parallel, 0 uses all hardware threads", "1", "0", "65535", &P::Comp<unsigned>}
 			};
 		}
 		
@@ -122,6 +127,7 @@ struct MatchersImpl
 		const T epsilon;
 		const NNSearchType searchType;
 		const std::string maxDistField;
+		const unsigned nbThreads;
 
 	protected:
 		std::shared_ptr<NNS> featureNNS;
@@ -133,6 +139,51 @@ struct MatchersImpl
 		virtual Matches findClosests(const DataPoints& filteredReading);
 	};
 
+	struct WarmStartKDTreeMatcher: public Matcher
+	{
+		typedef typename PointMatcher<T>::Inspector Inspector;
+		
+		inline static const std::string description()
+		{
+			return "This matcher matches a point from the reading to its closest neighbors in the reference, reusing the matches of its previous call. For every point, the previous neighbors and their own neighbors in the reference are checked first. The kd-tree is only queried when the displacement of the point since the previous call does not guarantee that these candidates still contain the closest neighbors, so the result is the same as the one of KDTreeMatcher. This is efficient when the reading moves little between calls, for instance in the last iterations of ICP. The number of points resolved without and with a kd-tree query are reported to the inspector as WarmStartHitCount and WarmStartMissCount.";
+		}
+		inline static const ParametersDoc availableParameters()
+		{
+			return {
+				{"knn", "number of nearest neighbors to consider it the reference", "1", "1", "2147483647", &P::Comp<unsigned>},
+				{"epsilon", "approximation to use for the nearest-neighbor search", "0", "0", "inf", &P::Comp<T>},
+				{"searchType", "Nabo search type. 0: brute force, check distance to every point in the data (very slow), 1: kd-tree with linear heap, good for small knn (~up to 30) and 2: kd-tree with tree heap, good for large knn (~from 30)", "1", "0", "2", &P::Comp<unsigned>},
+				{"maxDist", "maximum distance to consider for neighbors", "inf", "0", "inf", &P::Comp<T>},
+				{"neighborhoodSize", "number of neighbors of every reference point checked in addition to the previous matches, 0 only checks the previous matches", "4", "0", "2147483647", &P::Comp<unsigned>}
+			};
+		}
+		
+		const int knn;
+		const T epsilon;
+		const NNSearchType searchType;
+		const T maxDist;
+		const int neighborhoodSize;
+
+	protected:
+		std::shared_ptr<NNS> featureNNS;
+		typename PointMatcher<T>::IntMatrix referenceNeighbors; //!< neighborhoodSize closest neighbors of every reference point
+		Vector referenceNeighborhoodRadii; //!< distance from every reference point to its farthest neighbor in referenceNeighbors
+		Matrix lastReading; //!< position of the reading points during the previous call
+		Matches lastMatches; //!< result of the previous call
+		unsigned long hitCount; //!< number of points resolved from the previous matches
+		unsigned long missCount; //!< number of points that required a kd-tree query
+
+		bool findFromLastMatches(const DataPoints& filteredReading, const int i, std::vector<std::pair<T, int> >& candidates, Matches& matches) const;
+
+	public:
+		WarmStartKDTreeMatcher(const Parameters& params = Parameters());
+		virtual ~WarmStartKDTreeMatcher();
+		virtual void init(const DataPoints& filteredReference);
+		virtual Matches findClosests(const DataPoints& filteredReading);
+		virtual void addStats(Inspector& inspector);
+		virtual bool allowsConcurrentQueries() const;
+	};
+
 }; // MatchersImpl
 
 #endif // __POINTMATCHER_MATCHERS_H
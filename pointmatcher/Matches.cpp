@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "MatchesStatistics.h"
 
 using namespace std;
 
@@ -60,65 +61,17 @@ PointMatcher<T>::Matches::Matches(const int knn, const int pointsCount):
 template<typename T>
 T PointMatcher<T>::Matches::getDistsQuantile(const T quantile) const
 {
-	// build array
-	vector<T> values;
-	values.reserve(dists.rows() * dists.cols());
-	for (int x = 0; x < dists.cols(); ++x)
-	{
-		for (int y = 0; y < dists.rows(); ++y)
-		{
-			if (dists(y, x) != numeric_limits<T>::infinity())
-			{
-				values.push_back(dists(y, x));
-			}
-		}
-	}
-	if (values.empty())
-		throw ConvergenceError("No matches available for computing distance quantiles");
-
-	if (quantile < 0.0 || quantile > 1.0)
-		throw ConvergenceError("Distance quantile of matches must lie in the range [0,1]");
-
-	// get quantile
-	if (quantile == 1.0)
-		return *max_element(values.begin(), values.end());
-	nth_element(values.begin(), values.begin() + (values.size() * quantile), values.end());
-	return values[values.size() * quantile];
+	return MatchesStatistics<T>(*this).quantile(quantile);
 }
 
 //! Calculate the Median of Absolute Deviation(MAD), which is median(|x-median(x)|), a kind of robust standard deviation
 template<typename T>
 T PointMatcher<T>::Matches::getMedianAbsDeviation() const
 {
-	vector<T> values;
-	values.reserve(dists.rows() * dists.cols());
-	const long cols = dists.cols();
-	const long rows = dists.rows();
-	for (int x = 0; x < cols; ++x)
-	{
-		for (int y = 0; y < rows; ++y)
-		{
-			if (dists(y, x) != numeric_limits<T>::infinity())
-			{
-				values.push_back(dists(y, x));
-			}
-		}
-	}
-	if (values.size() == 0)
+	MatchesStatistics<T> statistics(*this);
+	if (statistics.empty())
 		throw ConvergenceError("[getMedianAbsDeviation] no outlier to filter");
-
-	nth_element(values.begin(), values.begin() + (values.size() / 2), values.end());
-	const T median =  values[values.size() / 2];
-
-	// Compute absolute deviation
-	const unsigned size = values.size();
-	for (unsigned i = 0; i < size; ++i)
-	{
-		values[i] = fabs(values[i] - median);
-	}
-	// Median of the absolute deviation
-	nth_element(values.begin(), values.begin() + (values.size() / 2), values.end());
-	return values[values.size() / 2];
+	return statistics.medianAbsDeviation();
 }
 
 template<typename T>
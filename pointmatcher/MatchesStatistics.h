@@ -0,0 +1,291 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#ifndef __POINTMATCHER_MATCHESSTATISTICS_H
+#define __POINTMATCHER_MATCHESSTATISTICS_H
+
+#include "PointMatcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//! Order statistics of the distances of matches, gathered once and shared by the queries of one caller
+/*!
+	An outlier filter may need several quantiles, the median of absolute
+	deviation or the sums of the smallest distances of its matches. This
+	gathers the finite squared distances once for these queries. Every
+	filter builds its own statistics, as the filters of a chain receive the
+	matches separately and may ask for different precisions and for zero
+	distances to be kept or not. In exact mode, the distances are kept in a
+	vector that queries order in place, so that later queries reuse the
+	ordering of earlier ones. In approximate mode, they are counted and
+	summed in a logarithmic histogram, whose bins are wide enough that their
+	representative value is within relativeError of all the distances they
+	hold, relatively. Memory then depends on the range of the distances and
+	not on their number. The histogram is only used when it has fewer bins
+	than there are distances, otherwise the exact mode is used instead.
+*/
+template<typename T>
+struct MatchesStatistics
+{
+	typedef typename PointMatcher<T>::Matches Matches; //!< alias
+	typedef typename PointMatcher<T>::ConvergenceError ConvergenceError; //!< alias
+	
+	//! Gather the finite distances of matches, only the positive ones if positiveOnly, in a histogram of given relativeError if it is larger than 0
+	MatchesStatistics(const Matches& matches, const T relativeError = 0, const bool positiveOnly = false):
+		count(0),
+		maxValue(0),
+		approximate(false),
+		sortedCount(0)
+	{
+		const T* const begin(matches.dists.data());
+		const T* const end(begin + matches.dists.size());
+		
+		// first pass: count the distances and find their range
+		std::size_t zeroCount(0);
+		T minPositive(std::numeric_limits<T>::max());
+		for (const T* it = begin; it != end; ++it)
+		{
+			const T dist(*it);
+			if (!isKept(dist, positiveOnly))
+				continue;
+			++count;
+			maxValue = std::max(maxValue, dist);
+			if (dist > 0)
+				minPositive = std::min(minPositive, dist);
+			else
+				++zeroCount;
+		}
+		
+		// second pass: fill the histogram if it is smaller than the distances, or copy them
+		if (relativeError > 0 && count > zeroCount)
+		{
+			assert(relativeError < 1);
+			const double gamma((1 + double(relativeError)) / (1 - double(relativeError)));
+			const double logGamma(std::log(gamma));
+			const int minIndex(binIndex(minPositive, logGamma));
+			const int maxIndex(binIndex(maxValue, logGamma));
+			const std::size_t binCount(maxIndex - minIndex + 1);
+			if (binCount < count)
+			{
+				std::vector<std::size_t> counts(binCount, 0);
+				std::vector<double> sums(binCount, 0);
+				for (const T* it = begin; it != end; ++it)
+				{
+					const T dist(*it);
+					if (!isKept(dist, positiveOnly) || dist <= 0)
+						continue;
+					const int i(std::max(minIndex, std::min(maxIndex, binIndex(dist, logGamma))) - minIndex);
+					++counts[i];
+					sums[i] += dist;
+				}
+				
+				if (zeroCount > 0)
+					bins.push_back(Bin(0, 0, zeroCount, 0));
+				for (std::size_t i = 0; i < binCount; ++i)
+				{
+					if (counts[i] == 0)
+						continue;
+					// the bin holds (gamma^(index-1), gamma^index], whose values are all within relativeError of 2 gamma^index / (gamma + 1)
+					const double upperBound(std::pow(gamma, int(i) + minIndex));
+					const T value(std::max(minPositive, std::min(maxValue, T(2 * upperBound / (gamma + 1)))));
+					bins.push_back(Bin(value, std::min(maxValue, T(upperBound)), counts[i], sums[i]));
+				}
+				approximate = true;
+				return;
+			}
+		}
+		values.reserve(count);
+		for (const T* it = begin; it != end; ++it)
+			if (isKept(*it, positiveOnly))
+				values.push_back(*it);
+	}
+	
+	//! Return the number of distances
+	std::size_t size() const { return count; }
+	
+	//! Return whether there are no distances
+	bool empty() const { return count == 0; }
+	
+	//! Return whether the distances are approximated by a histogram
+	bool isApproximate() const { return approximate; }
+	
+	//! Return the distance at the quantile ratio of the sorted distances
+	T quantile(const T ratio)
+	{
+		if (empty())
+			throw ConvergenceError("No matches available for computing distance quantiles");
+		if (ratio < 0.0 || ratio > 1.0)
+			throw ConvergenceError("Distance quantile of matches must lie in the range [0,1]");
+		if (ratio == 1.0)
+			return maxValue;
+		return atRank(std::size_t(count * ratio));
+	}
+	
+	//! Return the median of absolute deviation, median(|x - median(x)|), a kind of robust standard deviation
+	T medianAbsDeviation()
+	{
+		if (empty())
+			throw ConvergenceError("No matches available for computing the median of absolute deviation");
+		const std::size_t rank(count / 2);
+		const T median(atRank(rank));
+		if (!approximate)
+		{
+			std::vector<T> deviations(values.size());
+			for (std::size_t i = 0; i < values.size(); ++i)
+				deviations[i] = std::fabs(values[i] - median);
+			std::nth_element(deviations.begin(), deviations.begin() + rank, deviations.end());
+			return deviations[rank];
+		}
+		
+		// walk the bins away from the median one, in increasing deviation
+		std::ptrdiff_t lower(binAtRank(rank));
+		std::size_t upper(lower + 1);
+		std::size_t seen(0);
+		while (true)
+		{
+			const bool takeLower(upper == bins.size() || (lower >= 0 && median - bins[lower].value <= bins[upper].value - median));
+			const Bin& bin(takeLower ? bins[lower--] : bins[upper++]);
+			seen += bin.count;
+			if (seen > rank)
+				return std::fabs(bin.value - median);
+		}
+	}
+	
+	//! Call f(prefixCount, prefixSum, prefixMax) for increasing prefixes of the sorted distances, up to the first one holding at least maxCount of them
+	/*!
+		In exact mode, the prefixes grow one distance at a time. In
+		approximate mode, they grow one bin at a time, prefixSum is exact and
+		prefixMax is the upper bound of the last bin.
+	*/
+	template<typename F>
+	void forEachPrefix(const std::size_t maxCount, const F& f)
+	{
+		if (approximate)
+		{
+			std::size_t prefixCount(0);
+			double prefixSum(0);
+			for (const Bin& bin: bins)
+			{
+				prefixCount += bin.count;
+				prefixSum += bin.sum;
+				f(prefixCount, T(prefixSum), bin.upperBound);
+				if (prefixCount >= maxCount)
+					return;
+			}
+			return;
+		}
+		
+		const std::size_t prefixCount(std::min(maxCount, count));
+		if (prefixCount > sortedCount)
+		{
+			if (prefixCount < count)
+				std::nth_element(values.begin() + sortedCount, values.begin() + prefixCount, values.end());
+			std::sort(values.begin() + sortedCount, values.begin() + prefixCount);
+			sortedCount = prefixCount;
+		}
+		T prefixSum(0);
+		for (std::size_t i = 0; i < prefixCount; ++i)
+		{
+			prefixSum += values[i];
+			f(i + 1, prefixSum, values[i]);
+		}
+	}
+	
+private:
+	//! Distances sharing a bin of the histogram
+	struct Bin
+	{
+		T value; //!< representative distance
+		T upperBound; //!< largest distance the bin can hold
+		std::size_t count; //!< number of distances
+		double sum; //!< sum of the distances
+		
+		Bin(const T value, const T upperBound, const std::size_t count, const double sum):
+			value(value),
+			upperBound(upperBound),
+			count(count),
+			sum(sum)
+		{}
+	};
+	
+	std::size_t count; //!< number of distances
+	T maxValue; //!< largest distance
+	bool approximate; //!< whether bins approximates the distances
+	std::vector<T> values; //!< distances, in exact mode
+	std::size_t sortedCount; //!< number of smallest values that are sorted, the others being larger
+	std::vector<Bin> bins; //!< non-empty bins in increasing order, in approximate mode
+	
+	//! Return whether dist is taken into account
+	static bool isKept(const T dist, const bool positiveOnly)
+	{
+		return dist != Matches::InvalidDist && (!positiveOnly || dist > 0);
+	}
+	
+	//! Return the index of the bin holding a positive dist
+	static int binIndex(const T dist, const double logGamma)
+	{
+		return int(std::ceil(std::log(double(dist)) / logGamma));
+	}
+	
+	//! Return the index of the bin holding the distance of given rank
+	std::size_t binAtRank(const std::size_t rank) const
+	{
+		std::size_t seen(0);
+		for (std::size_t i = 0; i < bins.size(); ++i)
+		{
+			seen += bins[i].count;
+			if (seen > rank)
+				return i;
+		}
+		return bins.size() - 1;
+	}
+	
+	//! Return the distance of given rank in the sorted distances
+	T atRank(const std::size_t rank)
+	{
+		assert(rank < count);
+		if (approximate)
+			return bins[binAtRank(rank)].value;
+		if (rank >= sortedCount)
+			std::nth_element(values.begin() + sortedCount, values.begin() + rank, values.end());
+		return values[rank];
+	}
+};
+
+#endif // __POINTMATCHER_MATCHESSTATISTICS_H
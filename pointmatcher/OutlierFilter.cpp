@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "StageTimer.h"
 #include <limits>
 
 using namespace std;
@@ -87,12 +88,18 @@ typename PointMatcher<T>::OutlierWeights PointMatcher<T>::OutlierFilters::comput
 	{
 		// apply filters, they should take care of infinite distances
 		//LOG_INFO_STREAM("Applying " << this->size() << " Outlier filters" );
-		OutlierWeights w = (*this->begin())->compute(filteredReading, filteredReference, input);
+		const unsigned nbPoints(input.ids.cols());
+		OutlierWeights w;
+		{
+			const StageTimer<T> timer("OutlierFilter", (*this->begin())->className, nbPoints);
+			w = (*this->begin())->compute(filteredReading, filteredReference, input);
+		}
 		//LOG_INFO_STREAM("* " << (*this->begin())->className );
 		if (this->size() > 1)
 		{
 			for (OutlierFiltersConstIt it = (this->begin() + 1); it != this->end(); ++it)
 			{
+				const StageTimer<T> timer("OutlierFilter", (*it)->className, nbPoints);
 				w = w.array() * (*it)->compute(filteredReading, filteredReference, input).array();
 				//LOG_INFO_STREAM("* " << (*it)->className );
 			}
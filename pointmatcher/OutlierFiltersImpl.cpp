@@ -34,6 +34,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "OutlierFiltersImpl.h"
+#include "DataPoints3D.h"
+#include "MatchesStatistics.h"
 #include "PointMatcherPrivate.h"
 #include "Functions.h"
 #include "MatchersImpl.h"
@@ -109,7 +111,8 @@ template struct OutlierFiltersImpl<double>::MinDistOutlierFilter;
 template<typename T>
 OutlierFiltersImpl<T>::MedianDistOutlierFilter::MedianDistOutlierFilter(const Parameters& params):
 	OutlierFilter("MedianDistOutlierFilter", MedianDistOutlierFilter::availableParameters(), params),
-	factor(Parametrizable::get<T>("factor"))
+	factor(Parametrizable::get<T>("factor")),
+	quantileRelativeError(Parametrizable::get<T>("quantileRelativeError"))
 {
 }
 
@@ -119,7 +122,7 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::MedianDistOutlie
 	const DataPoints& filteredReference,
 	const Matches& input)
 {
-	const T median = input.getDistsQuantile(0.5);
+	const T median = MatchesStatistics<T>(input, quantileRelativeError).quantile(0.5);
 	const T limit = factor * median;
 	return OutlierWeights((input.dists.array() <= limit).template cast<T>());
 }
@@ -132,7 +135,8 @@ template struct OutlierFiltersImpl<double>::MedianDistOutlierFilter;
 template<typename T>
 OutlierFiltersImpl<T>::TrimmedDistOutlierFilter::TrimmedDistOutlierFilter(const Parameters& params):
 	OutlierFilter("TrimmedDistOutlierFilter", TrimmedDistOutlierFilter::availableParameters(), params),
-	ratio(Parametrizable::get<T>("ratio"))
+	ratio(Parametrizable::get<T>("ratio")),
+	quantileRelativeError(Parametrizable::get<T>("quantileRelativeError"))
 {
 }
 
@@ -142,7 +146,7 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::TrimmedDistOutli
 	const DataPoints& filteredReference,
 	const Matches& input)
 {
-	const T limit = input.getDistsQuantile(ratio);
+	const T limit = MatchesStatistics<T>(input, quantileRelativeError).quantile(ratio);
 	return OutlierWeights((input.dists.array() <= limit).template cast<T>());
 }
 
@@ -155,7 +159,8 @@ OutlierFiltersImpl<T>::VarTrimmedDistOutlierFilter::VarTrimmedDistOutlierFilter(
 	OutlierFilter("VarTrimmedDistOutlierFilter", VarTrimmedDistOutlierFilter::availableParameters(), params),
 	minRatio(Parametrizable::get<T>("minRatio")),
 	maxRatio(Parametrizable::get<T>("maxRatio")),
-	lambda(Parametrizable::get<T>("lambda"))
+	lambda(Parametrizable::get<T>("lambda")),
+	quantileRelativeError(Parametrizable::get<T>("quantileRelativeError"))
 {
 	if (this->minRatio >= this->maxRatio)
 	{
@@ -169,54 +174,48 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::VarTrimmedDistOu
 	const DataPoints& filteredReference,
 	const Matches& input)
 {
-	const T tunedRatio = optimizeInlierRatio(input);
-	LOG_INFO_STREAM("Optimized ratio: " << tunedRatio);
-
-	const T limit = input.getDistsQuantile(tunedRatio);
+	// the ratio is optimized on the positive distances, sorted once for all tested ratios
+	MatchesStatistics<T> statistics(input, quantileRelativeError, true);
+	const T limit = optimizeInlierLimit(statistics);
 	return OutlierWeights((input.dists.array() <= limit).template cast<T>());
 }
 
 template<typename T>
-T OutlierFiltersImpl<T>::VarTrimmedDistOutlierFilter::optimizeInlierRatio(const Matches& matches)
+T OutlierFiltersImpl<T>::VarTrimmedDistOutlierFilter::optimizeInlierLimit(MatchesStatistics<T>& statistics)
 {
 	typedef typename PointMatcher<T>::ConvergenceError ConvergenceError;
-	typedef typename Eigen::Array<T, Eigen::Dynamic, 1> LineArray;
-
-	const int points_nbr = matches.dists.rows() * matches.dists.cols();
-
-	// vector containing the squared distances of the matches
-	std::vector<T> tmpSortedDist;
-	tmpSortedDist.reserve(points_nbr);
-	for (int x = 0; x < matches.dists.cols(); ++x)
-		for (int y = 0; y < matches.dists.rows(); ++y)
-			if ((matches.dists(y, x) != numeric_limits<T>::infinity()) && (matches.dists(y, x) > 0))
-				tmpSortedDist.push_back(matches.dists(y, x));
-	if (tmpSortedDist.empty())
-		throw ConvergenceError("Inlier ratio optimization failed due to absence of matches");
-
-	std::sort(tmpSortedDist.begin(), tmpSortedDist.end());
-	std::vector<T> tmpCumSumSortedDist;
-	tmpCumSumSortedDist.reserve(points_nbr);
-	std::partial_sum(tmpSortedDist.begin(), tmpSortedDist.end(), tmpCumSumSortedDist.begin());
 
-	const int minEl = floor(this->minRatio*points_nbr);
-	const int maxEl = floor(this->maxRatio*points_nbr);
-
-	// Return std::vector to an eigen::vector
-	Eigen::Map<LineArray> sortedDist(&tmpCumSumSortedDist[0], points_nbr);
+	if (statistics.empty())
+		throw ConvergenceError("Inlier ratio optimization failed due to absence of matches");
 
-	const LineArray trunkSortedDist = sortedDist.segment(minEl, maxEl-minEl);
+	// test the ratios of the distances kept between minRatio and maxRatio
+	const T points_nbr = statistics.size();
+	const size_t minEl = size_t(floor(this->minRatio*points_nbr)) + 1;
+	const size_t maxEl = max(size_t(floor(this->maxRatio*points_nbr)), minEl);
 
-	const LineArray ids = LineArray::LinSpaced(trunkSortedDist.rows(), minEl+1, maxEl);
-	const LineArray ratio = ids / points_nbr; // ratio for each of element between minEl and maxEl
-	const LineArray deno = ratio.pow(this->lambda); // f^λ
-	// frms = cumSumDists[minEl:maxEl] / id / (f^λ)²
-	const LineArray FRMS = trunkSortedDist * ids.inverse() * deno.inverse().square() ;
-	int minIndex(0);// = FRMS.minCoeff();
-	FRMS.minCoeff(&minIndex);
-	const T optRatio = (float)(minIndex + minEl)/ (float)points_nbr;
+	bool found = false;
+	T minFRMS = 0;
+	T optRatio = 0;
+	T limit = 0;
+	statistics.forEachPrefix(maxEl, [&](const size_t id, const T cumSumDist, const T dist)
+	{
+		if (id < minEl)
+			return;
+		const T ratio = T(id) / points_nbr;
+		const T deno = pow(ratio, this->lambda); // f^λ
+		// frms = cumSumDists / id / (f^λ)²
+		const T FRMS = cumSumDist / T(id) / (deno * deno);
+		if (!found || FRMS < minFRMS)
+		{
+			found = true;
+			minFRMS = FRMS;
+			optRatio = ratio;
+			limit = dist;
+		}
+	});
+	LOG_INFO_STREAM("Optimized ratio: " << optRatio);
 
-	return optRatio;
+	return limit;
 }
 
 template struct OutlierFiltersImpl<float>::VarTrimmedDistOutlierFilter;
@@ -409,6 +408,7 @@ OutlierFiltersImpl<T>::RobustOutlierFilter::RobustOutlierFilter(const std::strin
 	scaleEstimator(Parametrizable::get<string>("scaleEstimator")),
 	nbIterationForScale(Parametrizable::get<int>("nbIterationForScale")),
 	distanceType(Parametrizable::get<string>("distanceType")),
+	quantileRelativeError(Parametrizable::get<T>("quantileRelativeError")),
 	robustFctId(-1),
 	iteration(1),
 	scale(0.0),
@@ -479,14 +479,37 @@ OutlierFiltersImpl<T>::RobustOutlierFilter::computePointToPlaneDistance(
 	int nbr_read_point = input.dists.cols();
 	int nbr_match = input.dists.rows();
 
+	Matrix dists(Matrix::Zero(nbr_match, nbr_read_point));
+
+	// 3D fast path, reading the points and normals in place as fixed-size vectors
+	if (DataPoints3D<T>::isApplicable(reading) && DataPoints3D<T>::isApplicable(reference) && DataPoints3D<T>::hasDescriptor3D(reference, "normals"))
+	{
+		typedef typename DataPoints3D<T>::Vector3 Vector3;
+		const typename DataPoints3D<T>::ConstColumns readingPoints(DataPoints3D<T>::points(reading));
+		const typename DataPoints3D<T>::ConstColumns referencePoints(DataPoints3D<T>::points(reference));
+		const typename DataPoints3D<T>::ConstColumns normals(DataPoints3D<T>::descriptor(reference, "normals"));
+		for(int i = 0; i < nbr_read_point; ++i)
+		{
+			const Vector3 reading_point(readingPoints[i]);
+			for(int j = 0; j < nbr_match; ++j)
+			{
+				const int reference_idx = input.ids(j, i);
+				if (reference_idx != Matches::InvalidId) {
+					const Vector3 normal(normals[reference_idx].normalized());
+					// distance_point_to_plan = dot(n, p-q)²
+					dists(j, i) = pow(normal.dot(reading_point - referencePoints[reference_idx]), 2);
+				}
+			}
+		}
+		return dists;
+	}
+
 	Matrix normals = reference.getDescriptorViewByName("normals");
 
 	Vector reading_point(Vector::Zero(3));
 	Vector reference_point(Vector::Zero(3));
 	Vector normal(3);
 
-	Matrix dists(Matrix::Zero(nbr_match, nbr_read_point));
-
 	for(int i = 0; i < nbr_read_point; ++i)
 	{
 		reading_point = reading.features.block(0, i, 3, 1);
@@ -516,7 +539,7 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFil
 	{
 		if (iteration <= nbIterationForScale or nbIterationForScale == 0)
 		{
-			scale = sqrt(input.getMedianAbsDeviation());
+			scale = sqrt(MatchesStatistics<T>(input, quantileRelativeError).medianAbsDeviation());
 		}
 	} else if (scaleEstimator == "std")
 	{
@@ -532,7 +555,7 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFil
 			// It's a bit confusing to use the tuning constant for scaling...
 			if (iteration == 1)
 			{
-				scale = 1.9 * sqrt(input.getDistsQuantile(0.5));
+				scale = 1.9 * sqrt(MatchesStatistics<T>(input, quantileRelativeError).quantile(0.5));
 			}
 			else
 			{ // TODO: maybe add it has another parameter or make him a function of the max iteration
@@ -38,6 +38,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 
+template<typename T>
+struct MatchesStatistics;
+
 template<typename T>
 struct OutlierFiltersImpl
 {
@@ -115,11 +118,13 @@ struct OutlierFiltersImpl
 		inline static const ParametersDoc availableParameters()
 		{
 			return {
-				{"factor","points farther away factor * median will be considered outliers.", "3", "0.0000001", "inf", &P::Comp <T>}
+				{"factor","points farther away factor * median will be considered outliers.", "3", "0.0000001", "inf", &P::Comp <T>},
+				{"quantileRelativeError", "If larger than 0, the median is estimated from a histogram of the distances, within this relative error, which is faster on large sets of matches. If 0, it is computed exactly.", "0", "0", "0.5", &P::Comp<T>}
 			};
 		}
 		
 		const T factor;
+		const T quantileRelativeError;
 		
 		MedianDistOutlierFilter(const Parameters& params = Parameters());
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
@@ -134,11 +139,13 @@ struct OutlierFiltersImpl
 		inline static const ParametersDoc availableParameters()
 		{
 			return {
-				{"ratio", "percentage to keep", "0.85", "0.0000001", "1.0", &P::Comp<T>}
+				{"ratio", "percentage to keep", "0.85", "0.0000001", "1.0", &P::Comp<T>},
+				{"quantileRelativeError", "If larger than 0, the quantile is estimated from a histogram of the distances, within this relative error, which is faster on large sets of matches. If 0, it is computed exactly.", "0", "0", "0.5", &P::Comp<T>}
 			};
 		}
 		
 		const T ratio;
+		const T quantileRelativeError;
 		
 		TrimmedDistOutlierFilter(const Parameters& params = Parameters());
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
@@ -155,20 +162,22 @@ struct OutlierFiltersImpl
 			return {
 				{"minRatio", "min ratio", "0.05","0.0000001", "1", &P::Comp<T>},
 				{"maxRatio", "max ratio", "0.99", "0.0000001", "1", &P::Comp<T>},
-				{"lambda", "lambda (part of the term that balance the rmsd: 1/ratio^lambda", "2.35"}
+				{"lambda", "lambda (part of the term that balance the rmsd: 1/ratio^lambda", "2.35"},
+				{"quantileRelativeError", "If larger than 0, the ratio is optimized on a histogram of the distances, within this relative error on the distance threshold, which is faster on large sets of matches. If 0, it is optimized exactly.", "0", "0", "0.5", &P::Comp<T>}
 			};
 		}
 
 		const T minRatio;
 		const T maxRatio;
 		const T lambda;
+		const T quantileRelativeError;
 		
 		VarTrimmedDistOutlierFilter(const Parameters& params = Parameters());
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
 		
 	private:
-		// return the optimized ratio
-		T optimizeInlierRatio(const Matches& matches);
+		// return the distance threshold of the optimized ratio
+		T optimizeInlierLimit(MatchesStatistics<T>& statistics);
 	};
 	
 	
@@ -240,7 +249,8 @@ struct OutlierFiltersImpl
 				  "'berg': an iterative exponentially decreasing estimator", "mad"},
 				{"nbIterationForScale", "For how many iteration the 'scaleEstimator' is recalculated. After 'nbIterationForScale' iteration the previous scale is kept. A nbIterationForScale==0 means that the estiamtor is recalculated at each iteration.", "0", "0", "100", &P::Comp<int>},
 				{"distanceType", "Type of error distance used, either point to point ('point2point') or point to plane('point2plane'). Point to point gives better result normally.", "point2point"},
-				{"approximation", "If the matched distance is larger than this threshold, its weight will be forced to zero. This can save computation as zero values are not minimized. If set to inf (default value), no approximation is done. The unit of this parameter is the same as the distance used, typically meters.", "inf", "0.0", "inf", &P::Comp<T>}
+				{"approximation", "If the matched distance is larger than this threshold, its weight will be forced to zero. This can save computation as zero values are not minimized. If set to inf (default value), no approximation is done. The unit of this parameter is the same as the distance used, typically meters.", "inf", "0.0", "inf", &P::Comp<T>},
+				{"quantileRelativeError", "If larger than 0, the 'mad' and 'berg' scale estimators use a histogram of the distances, within this relative error, which is faster on large sets of matches. If 0, they are computed exactly.", "0", "0", "0.5", &P::Comp<T>}
 			};
 		}
 
@@ -267,6 +277,7 @@ struct OutlierFiltersImpl
 		const std::string scaleEstimator;
 		const int nbIterationForScale;
 		const std::string distanceType;
+		const T quantileRelativeError;
 		int robustFctId;
 		int iteration;
 		T scale;
@@ -56,6 +56,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <ostream>
 #include <memory>
+#include <atomic>
+#include <map>
 //#include <cstdint>
 #include <boost/cstdint.hpp>
 
@@ -413,6 +415,13 @@ struct PointMatcher
 		//! Transform point cloud in-place using the transformation matrix
 		virtual void inPlaceCompute(const TransformationParameters& parameters, DataPoints& cloud) const = 0;
 
+		//! Transform input into output using the transformation matrix, reusing the memory already held by output
+		/**
+			Subclasses overriding only one of the compute functions should keep the other one
+			visible with using Transformation::compute.
+		*/
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
+
 		//! Return whether the given parameters respect the expected constraints
 		virtual bool checkParameters(const TransformationParameters& parameters) const = 0;
 
@@ -425,6 +434,7 @@ struct PointMatcher
 	struct Transformations: public std::vector<std::shared_ptr<Transformation> >
 	{
 		void apply(DataPoints& cloud, const TransformationParameters& parameters) const;
+		void apply(const DataPoints& input, DataPoints& output, const TransformationParameters& parameters) const;
 	};
 	typedef typename Transformations::iterator TransformationsIt; //!< alias
 	typedef typename Transformations::const_iterator TransformationsConstIt; //!< alias
@@ -439,6 +449,8 @@ struct PointMatcher
 	*/
 	struct DataPointsFilter: public Parametrizable
 	{
+		typedef Eigen::Array<bool, Eigen::Dynamic, 1> KeepMask; //!< flag per point, true if the point is kept
+
 		DataPointsFilter();
 		DataPointsFilter(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
 		virtual ~DataPointsFilter();
@@ -449,6 +461,21 @@ struct PointMatcher
 
 		//! Apply these filters to a point cloud without copying.
 		virtual void inPlaceFilter(DataPoints& cloud) = 0;
+
+		//! Return whether the filter processes every point independently of the others, so that a cloud can be filtered by chunks
+		virtual bool isChunkSafe() const;
+
+		//! Return whether the filter only removes points, without modifying them, so that it can be applied with updateKeepMask()
+		virtual bool isPredicate() const;
+		//! Clear the flags of the points this filter removes from cloud, as inPlaceFilter() would do on the points whose flag is set
+		virtual void updateKeepMask(const DataPoints& cloud, KeepMask& keep);
+
+		//! Move the points of cloud whose flag is set to its beginning, in order, and remove the others
+		static void compact(DataPoints& cloud, const KeepMask& keep);
+
+	protected:
+		//! Implementation of inPlaceFilter() for predicate filters, using updateKeepMask()
+		void filterWithKeepMask(DataPoints& cloud);
 	};
 	
 	//! A chain of DataPointsFilter
@@ -458,6 +485,9 @@ struct PointMatcher
 		DataPointsFilters(std::istream& in);
 		void init();
 		void apply(DataPoints& cloud);
+
+		//! If true, consecutive predicate filters share a keep mask and the cloud is compacted once after them, instead of after every filter
+		bool fusePredicates;
 	};
 	typedef typename DataPointsFilters::iterator DataPointsFiltersIt; //!< alias
 	typedef typename DataPointsFilters::const_iterator DataPointsFiltersConstIt; //!< alias
@@ -466,13 +496,15 @@ struct PointMatcher
 	
 	// ---------------------------------
 	
+	struct Inspector;
+	
 	//! A matcher links points in the reading to points in the reference.
 	/**
 		This typically uses a space-partitioning structure such as a kd-tree for performance optimization.
 	*/
 	struct Matcher: public Parametrizable
 	{
-		unsigned long visitCounter; //!< number of points visited
+		std::atomic<unsigned long> visitCounter; //!< number of points visited, updated atomically so that concurrent queries can share a matcher
 		
 		Matcher();
 		Matcher(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
@@ -480,6 +512,8 @@ struct PointMatcher
 		
 		void resetVisitCount();
 		unsigned long getVisitCount() const;
+		virtual void addStats(Inspector& inspector);
+		virtual bool allowsConcurrentQueries() const;
 		
 		//! Init this matcher to find nearest neighbor in filteredReference
 		virtual void init(const DataPoints& filteredReference) = 0;
@@ -529,6 +563,21 @@ struct PointMatcher
 	*/
 	struct ErrorMinimizer: public Parametrizable
 	{
+		//! Associations kept by the outlier filters, as columns of the reading and of the reference, from which minimizers can work without copying the points
+		struct KeptMatches
+		{
+			IntMatrix readingIds; //!< reading column of every kept association
+			Matches matches; //!< reference column and distance of every kept association
+			OutlierWeights weights; //!< weight of every kept association
+			bool allReadingPointsKept; //!< whether readingIds is 0, 1, ..., that is every reading point has exactly one kept association
+			int nbRejectedMatches; //!< number of matches with zero weights
+			int nbRejectedPoints; //!< number of points with all matches set to zero weights
+			T pointUsedRatio;  //!< the ratio of how many points were used for error minimization
+			T weightedPointUsedRatio;//!< the ratio of how many points were used (with weight) for error minimization
+			
+			KeptMatches(const OutlierWeights& outlierWeights, const Matches& matches);
+		};
+		
 		//! A structure holding data ready for minimization. The data are "normalized", for instance there are no points with 0 weight, etc.
 		struct ErrorElements
 		{
@@ -543,6 +592,7 @@ struct PointMatcher
 
 			ErrorElements();
 			ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches);
+			ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const KeptMatches& keptMatches);
 		};
 		
 		ErrorMinimizer();
@@ -551,6 +601,14 @@ struct PointMatcher
 		
 		T getPointUsedRatio() const;
 		T getWeightedPointUsedRatio() const;
+		//! Return the error elements of the last minimization
+		/*!
+			PointToPointErrorMinimizer solves the transformation from weighted
+			sums over the matches, so the reading and reference of its error
+			elements are empty, unless its keepErrorElements parameter is set.
+			The ratios of used points and the numbers of rejected matches and
+			points are always kept.
+		*/
 		ErrorElements getErrorElements() const; //TODO: ensure that is return a usable value
 		virtual T getOverlap() const;
 		virtual Matrix getCovariance() const;
@@ -623,6 +681,16 @@ struct PointMatcher
 	//! An inspector allows to log data at the different steps, for analysis.
 	struct Inspector: public Parametrizable
 	{
+		//! Duration of a stage of a registration, reported to the inspectors that record timings
+		struct StageTiming
+		{
+			std::string stage; //!< name of the stage, for instance Matcher or DataPointsFilter
+			std::string module; //!< class name of the module run by the stage, empty if the stage runs a whole chain
+			int iteration; //!< iteration of the registration, -1 for the stages run outside of the iterations
+			double startTime; //!< start of the stage, in seconds from an arbitrary epoch
+			double duration; //!< duration of the stage, in seconds
+			unsigned pointCount; //!< number of points given to the stage
+		};
 		
 		Inspector();
 		Inspector(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
@@ -636,6 +704,10 @@ struct PointMatcher
 		virtual void dumpStats(std::ostream& stream);
 		virtual void dumpStatsHeader(std::ostream& stream);
 		
+		// timings of the stages
+		virtual bool recordsTimings() const;
+		virtual void addTiming(const StageTiming& timing);
+		
 		// data statistics 
 		virtual void dumpIteration(const size_t iterationNumber, const TransformationParameters& parameters, const DataPoints& filteredReference, const DataPoints& reading, const Matches& matches, const OutlierWeights& outlierWeights, const TransformationCheckers& transformationCheckers);
 		virtual void finish(const size_t iterationCount);
@@ -655,6 +727,17 @@ struct PointMatcher
 	struct ICPChainBase
 	{
 	public:
+		//! Coarse level of the registration, run on reduced clouds before the chain itself
+		struct PyramidLevel
+		{
+			DataPointsFilters readingDataPointsFilters; //!< filters for reading, applied after the reading filters of the chain
+			DataPointsFilters referenceDataPointsFilters; //!< filters for reference, applied after the reference filters of the chain
+			unsigned maxIterationCount; //!< maximum number of iterations at this level
+			
+			PyramidLevel();
+		};
+		typedef std::vector<PyramidLevel> PyramidLevels;
+		
 		DataPointsFilters readingDataPointsFilters; //!< filters for reading, applied once
 		DataPointsFilters readingStepDataPointsFilters; //!< filters for reading, applied at each step
 		DataPointsFilters referenceDataPointsFilters; //!< filters for reference
@@ -664,6 +747,7 @@ struct PointMatcher
 		std::shared_ptr<ErrorMinimizer> errorMinimizer; //!< error minimizer
 		TransformationCheckers transformationCheckers; //!< transformation checkers
 		std::shared_ptr<Inspector> inspector; //!< inspector
+		PyramidLevels pyramidLevels; //!< coarse levels, from the coarsest to the finest, registered before the chain by ICP::compute
 		
 		virtual ~ICPChainBase();
 
@@ -683,6 +767,7 @@ struct PointMatcher
 		ICPChainBase();
 		
 		void cleanup();
+		void cloneModulesInto(ICPChainBase& chain) const;
 		
         virtual void loadAdditionalYAMLContent(PointMatcherSupport::YAML::Node& doc);
 		
@@ -694,6 +779,9 @@ struct PointMatcher
 		template<typename R>
         const std::string& createModuleFromRegistrar(const std::string& regName, const PointMatcherSupport::YAML::Node& doc, const R& registrar, std::shared_ptr<typename R::TargetType>& module);
 		
+		//! Instantiate the coarse levels if they are in the YAML file
+        const std::string& createPyramidLevelsFromYAML(const std::string& regName, const PointMatcherSupport::YAML::Node& doc);
+		
 		//! Get the value of a field in a node
         std::string nodeVal(const std::string& regName, const PointMatcherSupport::YAML::Node& doc);
 	};
@@ -701,6 +789,49 @@ struct PointMatcher
 	//! ICP algorithm
 	struct ICP: ICPChainBase
 	{
+		//! Reference of a coarse level, expressed in frame <refMean>, with the matcher indexing it
+		/*!
+			The matcher may keep a reference to the cloud it indexes, so the
+			cloud is shared rather than copied along with the level.
+		*/
+		struct ReferenceLevel
+		{
+			std::shared_ptr<const DataPoints> reference; //!< reference filtered by the filters of the level
+			std::shared_ptr<Matcher> matcher; //!< matcher of the same type and parameters as the one of the chain, indexing reference
+		};
+		typedef std::vector<ReferenceLevel> ReferenceLevels;
+		
+		//! Reference filtered, centered and indexed once, against which many readings can be registered
+		/*!
+			The matcher may keep a reference to the cloud it indexes, so a
+			prepared reference cannot be copied, which would leave the matcher
+			of the copy indexing the cloud of the original. It is shared
+			through the pointer returned by prepareReference() instead.
+		*/
+		struct PreparedReference
+		{
+			DataPoints reference; //!< reference after the filters of the chain, expressed in frame <refMean>
+			TransformationParameters T_refIn_refMean; //!< offset of the reference centered on its mean
+			std::shared_ptr<Matcher> matcher; //!< matcher indexing reference
+			ReferenceLevels levels; //!< coarse levels of the reference, one per pyramid level of the chain
+			unsigned referenceInPointCount; //!< number of points of the reference before the filters
+
+			PreparedReference() = default;
+			PreparedReference(const PreparedReference&) = delete;
+			PreparedReference& operator=(const PreparedReference&) = delete;
+		};
+		
+		//! Outcome of a registration run by computeConcurrently()
+		struct Result
+		{
+			TransformationParameters transformation; //!< optimised transformation from the reading to the reference
+			DataPoints readingFiltered; //!< reading after the reading filters of the chain
+			bool maxNumIterationsReached; //!< whether the maximum number of iterations was reached
+			T pointUsedRatio; //!< ratio of the reading points used by the last error minimization
+			T weightedPointUsedRatio; //!< ratio of the reading points used by the last error minimization, with their weights
+			std::map<std::string, double> stats; //!< statistics that compute() adds to the inspector, by name
+		};
+		
 		TransformationParameters operator()(
 			const DataPoints& readingIn,
 			const DataPoints& referenceIn);
@@ -714,6 +845,19 @@ struct PointMatcher
 			const DataPoints& readingIn,
 			const DataPoints& referenceIn,
 			const TransformationParameters& initialTransformationParameters);
+		
+		std::shared_ptr<const PreparedReference> prepareReference(const DataPoints& referenceIn);
+		std::shared_ptr<const PreparedReference> prepareReferenceConcurrently(const DataPoints& referenceIn) const;
+		
+		TransformationParameters compute(
+			const DataPoints& readingIn,
+			const PreparedReference& reference,
+			const TransformationParameters& initialTransformationParameters);
+		
+		Result computeConcurrently(
+			const DataPoints& readingIn,
+			const PreparedReference& reference,
+			const TransformationParameters& initialTransformationParameters) const;
 
 		//! Return the filtered point cloud reading used in the ICP chain
 		const DataPoints& getReadingFiltered() const { return readingFiltered; }
@@ -723,7 +867,14 @@ struct PointMatcher
 			const DataPoints& readingIn, 
 			const DataPoints& reference, 
 			const TransformationParameters& T_refIn_refMean,
-			const TransformationParameters& initialTransformationParameters);
+			const TransformationParameters& initialTransformationParameters,
+			const ReferenceLevels& referenceLevels = ReferenceLevels(),
+			Matcher* referenceMatcher = 0);
+		
+		void filterReference(const DataPoints& referenceIn, PreparedReference& prepared);
+		ReferenceLevels createReferenceLevels(const DataPoints& reference, const Vector& meanReference);
+		bool runIterations(const DataPoints& reading, const DataPoints& reference, Matcher* levelMatcher, const unsigned maxIterationCount, TransformationParameters& T_iter, size_t& iterationCount);
+		virtual Matches findClosests(const DataPoints& stepReading);
 
 		DataPoints readingFiltered; //!< reading point cloud after the filters were applied
 	};
@@ -743,7 +894,10 @@ struct PointMatcher
 		
 		bool hasMap() const;
 		bool setMap(const DataPoints& map);
+		bool addToMap(const DataPoints& cloud, const TransformationParameters& T_map_cloud);
+		unsigned removeFromMap(const Vector& boxMin, const Vector& boxMax);
 		void clearMap();
+		unsigned getMapSegmentCount() const;
 		virtual void setDefault();
 		virtual void loadFromYaml(std::istream& in);
 		PM_DEPRECATED("Use getPrefilteredInternalMap instead. "
@@ -762,8 +916,29 @@ struct PointMatcher
 		const DataPoints getPrefilteredMap() const;
 		
 	protected:
-		DataPoints mapPointCloud; //!< point cloud of the map, always in global frame (frame of first point cloud)
+		//! Consecutive points of the map with their own matcher, used once points are added with addToMap()
+		/*!
+			A matcher may keep pointers to the features it indexes, which
+			would not stay in place as mapPointCloud grows. The first segment
+			thus keeps the cloud that was the map when the first points were
+			added, which the matcher of the chain indexes, while the other
+			segments index a copy of the features of their points.
+		*/
+		struct MapSegment
+		{
+			int begin; //!< index of the first point of the segment in mapPointCloud
+			int count; //!< number of points of the segment
+			std::shared_ptr<DataPoints> cloud; //!< features of the points of the segment, indexed by matcher
+			std::shared_ptr<Matcher> matcher; //!< matcher indexing cloud, the one of the chain for the first segment until it loses points
+		};
+		
+		virtual Matches findClosests(const DataPoints& stepReading);
+		MapSegment createMapSegment(const int begin, const int count) const;
+		void mergeMapSegments();
+		
+		std::shared_ptr<DataPoints> mapPointCloud = std::make_shared<DataPoints>(); //!< point cloud of the map, always in global frame (frame of first point cloud), shared with the first segment until points are added to it
 		TransformationParameters T_refIn_refMean; //!< offset for centered map
+		std::vector<MapSegment> mapSegments; //!< segments covering mapPointCloud in order, empty if the matcher of the chain indexes the whole map; otherwise, the matcher of the chain is only queried through the first segment, if it still has it
 	};
 	
 	// ---------------------------------
@@ -0,0 +1,175 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+ * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+
+#ifndef __POINTMATCHER_STAGETIMER_H
+#define __POINTMATCHER_STAGETIMER_H
+
+#include "PointMatcher.h"
+
+#include <chrono>
+#include <string>
+
+//! Timing of the stages of a registration, reported to the inspector of the running ICP if it records timings
+/*!
+	The filter and outlier chains do not know the ICP they run in, so the
+	inspector is kept in a thread-local context, set by a Scope for the
+	duration of a registration. When no inspector recording timings is active,
+	a StageTimer does not read the clock, so that the instrumentation costs a
+	thread-local read per stage.
+*/
+template<typename T>
+struct StageTimer
+{
+	typedef typename PointMatcher<T>::Inspector Inspector; //!< alias
+	typedef typename Inspector::StageTiming StageTiming; //!< alias
+	typedef std::chrono::steady_clock Clock; //!< clock used for the timings
+	
+	//! Inspector and iteration of the registration running in this thread
+	struct Context
+	{
+		Inspector* inspector = nullptr; //!< inspector receiving the timings, null if none records them
+		int iteration = -1; //!< current iteration, -1 outside of the iterations
+	};
+	
+	//! Return the context of this thread
+	static Context& context()
+	{
+		static thread_local Context threadContext;
+		return threadContext;
+	}
+	
+	//! Activate an inspector in this thread for the lifetime of the scope, restoring the previous one afterwards
+	struct Scope
+	{
+		Scope(Inspector* inspector):
+			previous(context())
+		{
+			Context& current(context());
+			current.inspector = (inspector && inspector->recordsTimings()) ? inspector : nullptr;
+			current.iteration = -1;
+		}
+		~Scope()
+		{
+			context() = previous;
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		
+	private:
+		const Context previous;
+	};
+	
+	//! Set the current iteration for the lifetime of the scope
+	struct IterationScope
+	{
+		IterationScope(const int iteration):
+			previous(context().iteration)
+		{
+			context().iteration = iteration;
+		}
+		~IterationScope()
+		{
+			context().iteration = previous;
+		}
+		IterationScope(const IterationScope&) = delete;
+		IterationScope& operator=(const IterationScope&) = delete;
+		
+	private:
+		const int previous;
+	};
+	
+	//! Start timing a stage, if an inspector records timings
+	StageTimer(const char* stage, const std::string& module, const unsigned pointCount):
+		inspector(context().inspector),
+		stage(stage),
+		module(inspector ? &module : nullptr),
+		pointCount(pointCount)
+	{
+		if (inspector)
+			start = Clock::now();
+	}
+	
+	//! Start timing a stage that runs a whole chain, if an inspector records timings
+	StageTimer(const char* stage, const unsigned pointCount):
+		inspector(context().inspector),
+		stage(stage),
+		module(nullptr),
+		pointCount(pointCount)
+	{
+		if (inspector)
+			start = Clock::now();
+	}
+	
+	//! Report the duration of the stage, including when it throws
+	/*!
+		A timing that cannot be recorded, for instance because of a failed
+		allocation, is dropped, as the destructor may run during stack unwinding.
+	*/
+	~StageTimer()
+	{
+		if (!inspector)
+			return;
+		const Clock::time_point end(Clock::now());
+		try
+		{
+			StageTiming timing;
+			timing.stage = stage;
+			if (module)
+				timing.module = *module;
+			timing.iteration = context().iteration;
+			timing.startTime = std::chrono::duration<double>(start.time_since_epoch()).count();
+			timing.duration = std::chrono::duration<double>(end - start).count();
+			timing.pointCount = pointCount;
+			inspector->addTiming(timing);
+		}
+		catch (...)
+		{
+		}
+	}
+	
+	StageTimer(const StageTimer&) = delete;
+	StageTimer& operator=(const StageTimer&) = delete;
+	
+private:
+	Inspector* const inspector;
+	const char* const stage;
+	const std::string* const module;
+	const unsigned pointCount;
+	Clock::time_point start;
+};
+
+#endif // __POINTMATCHER_STAGETIMER_H
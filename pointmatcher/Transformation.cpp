@@ -52,6 +52,14 @@ template<typename T>
 PointMatcher<T>::Transformation::~Transformation()
 {}
 
+//! Transform input into output, default implementation copies input and transforms it in place
+template<typename T>
+void PointMatcher<T>::Transformation::compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const
+{
+	output = input;
+	inPlaceCompute(parameters, output);
+}
+
 template struct PointMatcher<float>::Transformation;
 template struct PointMatcher<double>::Transformation;
 
@@ -75,5 +83,26 @@ void PointMatcher<T>::Transformations::apply(DataPoints& cloud, const Transforma
 		throw std::runtime_error("Transformations: Error, the transform should have been applied just once.");
 }
 
+//! Apply this chain to input, using parameters, and store the result in output
+/**
+	Contrary to the in-place version, input is left untouched and output
+	is overwritten, reusing its memory if it already has the right size.
+*/
+template<typename T>
+void PointMatcher<T>::Transformations::apply(const DataPoints& input, DataPoints& output, const TransformationParameters& parameters) const
+{
+	int num_iter = 0;
+	for (TransformationsConstIt it = this->begin(); it != this->end(); ++it)
+	{
+		if (num_iter == 0)
+			(*it)->compute(input, parameters, output);
+		else
+			(*it)->inPlaceCompute(parameters, output);
+		num_iter++;
+	}
+	if (num_iter != 1)
+		throw std::runtime_error("Transformations: Error, the transform should have been applied just once.");
+}
+
 template struct PointMatcher<float>::Transformations;
 template struct PointMatcher<double>::Transformations;
@@ -45,45 +45,185 @@ TransformationError::TransformationError(const std::string& reason):
 	runtime_error(reason)
 {}
 
-//! RigidTransformation
+//! Number of columns from which a 3D transformation is split between threads
+static const std::size_t parallelTransformMinColumnCount(1 << 16);
+
+//! Return whether a descriptor is a direction, rotated but not translated by rigid transformations
+static inline bool isDirectionDescriptor(const std::string& name)
+{
+	return name == "normals" || name == "observationDirections";
+}
+
+//! Collect the first rows of the directions of cloud in directionRows, return false if one of them does not have 3 rows
 template<typename T>
-typename PointMatcher<T>::DataPoints TransformationsImpl<T>::RigidTransformation::compute(
-	const DataPoints& input,
-	const TransformationParameters& parameters) const
+static bool getDirectionRows3D(const typename PointMatcher<T>::DataPoints& cloud, std::vector<int>& directionRows)
 {
-	DataPoints transformedCloud = input;
-	inPlaceCompute(parameters, transformedCloud);
-	return transformedCloud;
+	int row(0);
+	for (size_t i = 0; i < cloud.descriptorLabels.size(); ++i)
+	{
+		const int span(cloud.descriptorLabels[i].span);
+		if (isDirectionDescriptor(cloud.descriptorLabels[i].text))
+		{
+			if (span != 3)
+				return false;
+			directionRows.push_back(row);
+		}
+		row += span;
+	}
+	return true;
 }
 
-//! RigidTransformation
+//! Transform the features of a homogeneous 3D cloud and rotate its directions, in one pass over the columns
+/**
+	The columns of inFeatures are multiplied by parameters as fixed-size 4-vectors,
+	which Eigen vectorizes, and the 3 rows of inDescriptors starting at each of
+	directionRows are rotated while the column is in cache. The results are
+	written to outFeatures and outDescriptors, which must have the size of the
+	inputs and can be the same matrices. Very large clouds are split between
+	threads; as transformations have no parameters, their number is always chosen
+	automatically from the number of columns and the hardware concurrency.
+*/
 template<typename T>
-void TransformationsImpl<T>::RigidTransformation::inPlaceCompute(
-	const TransformationParameters& parameters,
-	DataPoints& cloud) const
+static void transformColumns3D(
+	const typename PointMatcher<T>::Matrix& inFeatures,
+	const typename PointMatcher<T>::Matrix& inDescriptors,
+	const typename PointMatcher<T>::TransformationParameters& parameters,
+	const std::vector<int>& directionRows,
+	typename PointMatcher<T>::Matrix& outFeatures,
+	typename PointMatcher<T>::Matrix& outDescriptors)
 {
-	assert(cloud.features.rows() == parameters.rows());
+	typedef Eigen::Matrix<T, 4, 4> Matrix44;
+	typedef Eigen::Matrix<T, 3, 3> Matrix33;
+	typedef Eigen::Matrix<T, 4, 1> Vector4;
+	typedef Eigen::Matrix<T, 3, 1> Vector3;
+
+	assert(parameters.rows() == 4 && parameters.cols() == 4);
+	assert(inFeatures.rows() == 4);
+
+	const Matrix44 transform(parameters);
+	const Matrix33 R(transform.template topLeftCorner<3, 3>());
+	const std::size_t count(inFeatures.cols());
+	parallelFor(count, getThreadCountForSize(count, parallelTransformMinColumnCount), [&](const std::size_t begin, const std::size_t end, unsigned)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const Vector4 point(inFeatures.template block<4, 1>(0, i));
+			outFeatures.template block<4, 1>(0, i).noalias() = transform * point;
+			for (size_t j = 0; j < directionRows.size(); ++j)
+			{
+				const Vector3 direction(inDescriptors.template block<3, 1>(directionRows[j], i));
+				outDescriptors.template block<3, 1>(directionRows[j], i).noalias() = R * direction;
+			}
+		}
+	});
+}
+
+//! Write the transformation of input into output, reusing the memory of output
+/**
+	Features are multiplied by parameters and, if rotateDirections is true,
+	the normals and observation directions are rotated by the upper-left block
+	of parameters. The other descriptors and the times are copied as is.
+	This gives the same result as a copy followed by an in-place transformation,
+	without the temporaries.
+*/
+template<typename T>
+static void transformCloud(
+	const typename PointMatcher<T>::DataPoints& input,
+	const typename PointMatcher<T>::TransformationParameters& parameters,
+	const bool rotateDirections,
+	typename PointMatcher<T>::DataPoints& output)
+{
+	typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
+
+	assert(input.features.rows() == parameters.rows());
 	assert(parameters.rows() == parameters.cols());
+	assert(&input != &output);
 
 	const unsigned int nbRows = parameters.rows()-1;
 	const unsigned int nbCols = parameters.cols()-1;
-
 	const TransformationParameters R(parameters.topLeftCorner(nbRows, nbCols));
 
-	if(this->checkParameters(parameters) == false)	
-		throw TransformationError("RigidTransformation: Error, rotation matrix is not orthogonal.");	
-	
+	// Homogeneous 3D clouds are transformed column by column after the copy of the other descriptors
+	std::vector<int> directionRows;
+	const bool fixed3D(parameters.rows() == 4 && (!rotateDirections || getDirectionRows3D<T>(input, directionRows)));
+
 	// Apply the transformation to features
-	cloud.features.applyOnTheLeft(parameters);
+	output.featureLabels = input.featureLabels;
+	if (fixed3D)
+		output.features.resize(input.features.rows(), input.features.cols());
+	else
+		output.features.noalias() = parameters * input.features;
 
 	// Apply the transformation to descriptors
+	output.descriptorLabels = input.descriptorLabels;
+	output.descriptors.resize(input.descriptors.rows(), input.descriptors.cols());
+	int row(0);
+	const int descCols(input.descriptors.cols());
+	for (size_t i = 0; i < input.descriptorLabels.size(); ++i)
+	{
+		const int span(input.descriptorLabels[i].span);
+		const std::string& name(input.descriptorLabels[i].text);
+		if (rotateDirections && isDirectionDescriptor(name))
+		{
+			if (!fixed3D)
+				output.descriptors.block(row, 0, span, descCols).noalias() = R * input.descriptors.block(row, 0, span, descCols);
+		}
+		else
+			output.descriptors.block(row, 0, span, descCols) = input.descriptors.block(row, 0, span, descCols);
+		
+		row += span;
+	}
+
+	if (fixed3D)
+		transformColumns3D<T>(input.features, input.descriptors, parameters, directionRows, output.features, output.descriptors);
+
+	// Times are not affected
+	output.timeLabels = input.timeLabels;
+	output.times = input.times;
+}
+
+//! Transform cloud in place, with the same results as transformCloud
+/**
+	Homogeneous 3D clouds go through transformColumns3D, like in transformCloud,
+	so that the in-place and the copying transformations share the same code path.
+	Other clouds are transformed by dynamic-size products.
+*/
+template<typename T>
+static void transformCloudInPlace(
+	const typename PointMatcher<T>::TransformationParameters& parameters,
+	const bool rotateDirections,
+	typename PointMatcher<T>::DataPoints& cloud)
+{
+	typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
+
+	assert(cloud.features.rows() == parameters.rows());
+	assert(parameters.rows() == parameters.cols());
+
+	// Fast path for homogeneous 3D clouds, in one pass over the columns
+	std::vector<int> directionRows;
+	if (parameters.rows() == 4 && (!rotateDirections || getDirectionRows3D<T>(cloud, directionRows)))
+	{
+		transformColumns3D<T>(cloud.features, cloud.descriptors, parameters, directionRows, cloud.features, cloud.descriptors);
+		return;
+	}
+
+	// Apply the transformation to features
+	cloud.features.applyOnTheLeft(parameters);
+
+	if (!rotateDirections)
+		return;
+
+	// Apply the rotation to the directions
+	const unsigned int nbRows = parameters.rows()-1;
+	const unsigned int nbCols = parameters.cols()-1;
+	const TransformationParameters R(parameters.topLeftCorner(nbRows, nbCols));
 	int row(0);
 	const int descCols(cloud.descriptors.cols());
 	for (size_t i = 0; i < cloud.descriptorLabels.size(); ++i)
 	{
 		const int span(cloud.descriptorLabels[i].span);
 		const std::string& name(cloud.descriptorLabels[i].text);
-		if (name == "normals" || name == "observationDirections")
+		if (isDirectionDescriptor(name))
 		{
 			cloud.descriptors.block(row, 0, span, descCols).applyOnTheLeft(R);
 		}
@@ -92,6 +232,45 @@ void TransformationsImpl<T>::RigidTransformation::inPlaceCompute(
 	}
 }
 
+//! RigidTransformation
+template<typename T>
+typename PointMatcher<T>::DataPoints TransformationsImpl<T>::RigidTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters) const
+{
+	DataPoints transformedCloud = input;
+	inPlaceCompute(parameters, transformedCloud);
+	return transformedCloud;
+}
+
+//! RigidTransformation, writing into output
+template<typename T>
+void TransformationsImpl<T>::RigidTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters,
+	DataPoints& output) const
+{
+	if(this->checkParameters(parameters) == false)
+		throw TransformationError("RigidTransformation: Error, rotation matrix is not orthogonal.");
+
+	transformCloud<T>(input, parameters, true, output);
+}
+
+//! RigidTransformation
+template<typename T>
+void TransformationsImpl<T>::RigidTransformation::inPlaceCompute(
+	const TransformationParameters& parameters,
+	DataPoints& cloud) const
+{
+	assert(cloud.features.rows() == parameters.rows());
+	assert(parameters.rows() == parameters.cols());
+
+	if(this->checkParameters(parameters) == false)	
+		throw TransformationError("RigidTransformation: Error, rotation matrix is not orthogonal.");	
+	
+	transformCloudInPlace<T>(parameters, true, cloud);
+}
+
 //! Ensure orthogonality of the rotation matrix
 template<typename T>
 bool TransformationsImpl<T>::RigidTransformation::checkParameters(const TransformationParameters& parameters) const
@@ -170,6 +349,19 @@ typename PointMatcher<T>::DataPoints TransformationsImpl<T>::SimilarityTransform
 	return transformedCloud;
 }
 
+//! SimilarityTransformation, writing into output
+template<typename T>
+void TransformationsImpl<T>::SimilarityTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters,
+	DataPoints& output) const
+{
+	if(this->checkParameters(parameters) == false)
+		throw TransformationError("SimilarityTransformation: Error, invalid similarity transform.");
+
+	transformCloud<T>(input, parameters, true, output);
+}
+
 //! SimilarityTransformation
 template<typename T>
 void TransformationsImpl<T>::SimilarityTransformation::inPlaceCompute(
@@ -179,31 +371,10 @@ void TransformationsImpl<T>::SimilarityTransformation::inPlaceCompute(
 	assert(cloud.features.rows() == parameters.rows());
 	assert(parameters.rows() == parameters.cols());
 
-	const unsigned int nbRows = parameters.rows()-1;
-	const unsigned int nbCols = parameters.cols()-1;
-
-	const TransformationParameters R(parameters.topLeftCorner(nbRows, nbCols));
-
 	if(this->checkParameters(parameters) == false)
 		throw TransformationError("SimilarityTransformation: Error, invalid similarity transform.");
-	
-	// Apply the transformation to features
-	cloud.features.applyOnTheLeft(parameters);
-	
-	// Apply the transformation to descriptors
-	int row(0);
-	const int descCols(cloud.descriptors.cols());
-	for (size_t i = 0; i < cloud.descriptorLabels.size(); ++i)
-	{
-		const int span(cloud.descriptorLabels[i].span);
-		const std::string& name(cloud.descriptorLabels[i].text);
-		if (name == "normals" || name == "observationDirections")
-		{
-			cloud.descriptors.block(row, 0, span, descCols).applyOnTheLeft(R);
-		}
-		
-		row += span;
-	}
+
+	transformCloudInPlace<T>(parameters, true, cloud);
 }
 
 //! Nothing to check for a similarity transform
@@ -232,6 +403,15 @@ typename PointMatcher<T>::DataPoints TransformationsImpl<T>::PureTranslation::co
 	return transformedCloud;
 }
 
+template<typename T>
+void TransformationsImpl<T>::PureTranslation::compute(const DataPoints& input,
+		const TransformationParameters& parameters, DataPoints& output) const {
+	if(this->checkParameters(parameters) == false)
+		throw PointMatcherSupport::TransformationError("PureTranslation: Error, left part  not identity.");
+
+	transformCloud<T>(input, parameters, false, output);
+}
+
 template<typename T>
 void TransformationsImpl<T>::PureTranslation::inPlaceCompute(
 	const TransformationParameters& parameters,
@@ -242,8 +422,7 @@ void TransformationsImpl<T>::PureTranslation::inPlaceCompute(
 	if(this->checkParameters(parameters) == false)
 		throw PointMatcherSupport::TransformationError("PureTranslation: Error, left part  not identity.");
 
-	// Apply the transformation to features
-	cloud.features.applyOnTheLeft(parameters);
+	transformCloudInPlace<T>(parameters, false, cloud);
 }
 
 template<typename T>
@@ -59,7 +59,9 @@ struct TransformationsImpl
 		}
 
 		RigidTransformation() : Transformation("RigidTransformation",  ParametersDoc(), Parameters()) {}
+		using Transformation::compute;
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual void inPlaceCompute(const TransformationParameters& parameters, DataPoints& cloud) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
@@ -73,7 +75,9 @@ struct TransformationsImpl
 		}
 		
 		SimilarityTransformation() : Transformation("SimilarityTransformation",  ParametersDoc(), Parameters()) {}
+		using Transformation::compute;
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual void inPlaceCompute(const TransformationParameters& parameters, DataPoints& cloud) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
@@ -87,7 +91,9 @@ struct TransformationsImpl
 		}
 
 		PureTranslation() : Transformation("PureTranslation",  ParametersDoc(), Parameters()) {}
+		using Transformation::compute;
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual void inPlaceCompute(const TransformationParameters& parameters, DataPoints& cloud) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
@@ -10,9 +10,16 @@ namespace python
 		{
 			using PointToPointErrorMinimizer = ErrorMinimizersImpl<ScalarType>::PointToPointErrorMinimizer;
 			py::class_<PointToPointErrorMinimizer, std::shared_ptr<PointToPointErrorMinimizer>, ErrorMinimizer>(p_module, "PointToPointErrorMinimizer")
-				.def(py::init<>())
+				.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
 				.def(py::init<const std::string&, const ParametersDoc, const Parameters&>(), py::arg("className"), py::arg("paramsDoc"), py::arg("params"))
-				.def("compute", &PointToPointErrorMinimizer::compute, py::arg("mPts"))
+
+				.def_readonly("keepErrorElements", &PointToPointErrorMinimizer::keepErrorElements)
+
+				.def_static("description", &PointToPointErrorMinimizer::description)
+				.def_static("availableParameters", &PointToPointErrorMinimizer::availableParameters)
+
+				.def("compute", (TransformationParameters (PointToPointErrorMinimizer::*)(const DataPoints&, const DataPoints&, const OutlierWeights&, const Matches&)) &PointToPointErrorMinimizer::compute, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("outlierWeights"), py::arg("matches"))
+				.def("compute", (TransformationParameters (PointToPointErrorMinimizer::*)(const ErrorElements&)) &PointToPointErrorMinimizer::compute, py::arg("mPts"))
 				.def("compute_in_place", &PointToPointErrorMinimizer::compute_in_place, py::arg("mPts"))
 				.def("getResidualError", &PointToPointErrorMinimizer::getResidualError, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("outlierWeights"), py::arg("matches"))
 				.def("getOverlap", &PointToPointErrorMinimizer::getOverlap)
@@ -16,7 +16,8 @@ namespace python
 				.def_readwrite("covMatrix", &PointToPointWithCovErrorMinimizer::covMatrix)
 				.def_static("description", &PointToPointWithCovErrorMinimizer::description)
 				.def_static("availableParameters", &PointToPointWithCovErrorMinimizer::availableParameters)
-				.def("compute", &PointToPointWithCovErrorMinimizer::compute, py::arg("mPts"))
+				.def("compute", (TransformationParameters (PointToPointWithCovErrorMinimizer::*)(const DataPoints&, const DataPoints&, const OutlierWeights&, const Matches&)) &PointToPointWithCovErrorMinimizer::compute, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("outlierWeights"), py::arg("matches"))
+				.def("compute", (TransformationParameters (PointToPointWithCovErrorMinimizer::*)(const ErrorElements&)) &PointToPointWithCovErrorMinimizer::compute, py::arg("mPts"))
 				.def("getCovariance", &PointToPointWithCovErrorMinimizer::getCovariance)
 				.def("estimateCovariance", &PointToPointWithCovErrorMinimizer::estimateCovariance, py::arg("mPts"), py::arg("transformation"));
 		}
@@ -14,6 +14,18 @@ An error minimizer will compute a transformation matrix such as to minimize the
 Typical error minimized are point-to-point and point-to-plane.
 )pbdoc";
 
+			py::class_<KeptMatches>(pyErrorMinimizer, "KeptMatches", "Associations kept by the outlier filters, as columns of the reading and of the reference")
+				.def_readwrite("readingIds", &KeptMatches::readingIds, "reading column of every kept association")
+				.def_readwrite("matches", &KeptMatches::matches, "reference column and distance of every kept association")
+				.def_readwrite("weights", &KeptMatches::weights, "weight of every kept association")
+				.def_readwrite("allReadingPointsKept", &KeptMatches::allReadingPointsKept, "whether every reading point has exactly one kept association")
+				.def_readwrite("nbRejectedMatches", &KeptMatches::nbRejectedMatches, "number of matches with zero weights")
+				.def_readwrite("nbRejectedPoints", &KeptMatches::nbRejectedPoints, "number of points with all matches set to zero weights")
+				.def_readwrite("pointUsedRatio", &KeptMatches::pointUsedRatio, "the ratio of how many points were used for error minimization")
+				.def_readwrite("weightedPointUsedRatio", &KeptMatches::weightedPointUsedRatio, "the ratio of how many points were used (with weight) for error minimization")
+
+				.def(py::init<const OutlierWeights&, const Matches&>(), py::arg("outlierWeights"), py::arg("matches"));
+
 			py::class_<ErrorElements>(pyErrorMinimizer, "ErrorElements", "A structure holding data ready for minimization. The data are \"normalized\", for instance there are no points with 0 weight, etc.")
 				.def_readwrite("reading", &ErrorElements::reading, "reading point cloud")
 				.def_readwrite("reference", &ErrorElements::reference, "reference point cloud")
@@ -25,7 +37,8 @@ Typical error minimized are point-to-point and point-to-plane.
 				.def_readwrite("weightedPointUsedRatio", &ErrorElements::weightedPointUsedRatio, "the ratio of how many points were used (with weight) for error minimization")
 
 				.def(py::init<>())
-				.def(py::init<const DataPoints&, const DataPoints&, const OutlierWeights&, const Matches&>(), py::arg("requestedPts"), py::arg("sourcePts"), py::arg("outlierWeights"), py::arg("matches"));
+				.def(py::init<const DataPoints&, const DataPoints&, const OutlierWeights&, const Matches&>(), py::arg("requestedPts"), py::arg("sourcePts"), py::arg("outlierWeights"), py::arg("matches"))
+				.def(py::init<const DataPoints&, const DataPoints&, const KeptMatches&>(), py::arg("requestedPts"), py::arg("sourcePts"), py::arg("keptMatches"));
 
 			pyErrorMinimizer.def("getPointUsedRatio", &ErrorMinimizer::getPointUsedRatio)
 				.def("getWeightedPointUsedRatio", &ErrorMinimizer::getWeightedPointUsedRatio)
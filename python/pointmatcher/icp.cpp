@@ -6,10 +6,38 @@ namespace python
 	{
 		void pybindICP(py::class_<PM>& p_class)
 		{
-			py::class_<ICP, ICPChaineBase>(p_class, "ICP", "ICP algorithm").def(py::init<>())
+			using PreparedReference = ICP::PreparedReference;
+			using Result = ICP::Result;
+
+			py::class_<ICP, ICPChaineBase> pyICP(p_class, "ICP", "ICP algorithm");
+
+			py::class_<PreparedReference, std::shared_ptr<PreparedReference>>(pyICP, "PreparedReference", "Reference filtered, centered and indexed once, against which many readings can be registered")
+				.def_readonly("reference", &PreparedReference::reference, "reference after the filters of the chain, expressed in frame <refMean>")
+				.def_readonly("T_refIn_refMean", &PreparedReference::T_refIn_refMean, "offset of the reference centered on its mean")
+				.def_readonly("referenceInPointCount", &PreparedReference::referenceInPointCount, "number of points of the reference before the filters");
+
+			py::class_<Result>(pyICP, "Result", "Outcome of a registration run by computeConcurrently()")
+				.def_readonly("transformation", &Result::transformation, "optimised transformation from the reading to the reference")
+				.def_readonly("readingFiltered", &Result::readingFiltered, "reading after the reading filters of the chain")
+				.def_readonly("maxNumIterationsReached", &Result::maxNumIterationsReached, "whether the maximum number of iterations was reached")
+				.def_readonly("pointUsedRatio", &Result::pointUsedRatio, "ratio of the reading points used by the last error minimization")
+				.def_readonly("weightedPointUsedRatio", &Result::weightedPointUsedRatio, "ratio of the reading points used by the last error minimization, with their weights")
+				.def_readonly("stats", &Result::stats, "statistics that compute() adds to the inspector, by name");
+
+			pyICP.def(py::init<>())
 				.def("__call__", (TransformationParameters (ICP::*)(const DataPoints&, const DataPoints&)) &ICP::operator(), py::arg("readingIn"), py::arg("referenceIn"))
 				.def("__call__", (TransformationParameters (ICP::*)(const DataPoints&, const DataPoints&, const TransformationParameters&)) &ICP::operator(), py::arg("readingIn"), py::arg("referenceIn"), py::arg("initialTransformationParameters"))
-				.def("compute", &ICP::compute, py::arg("readingIn"), py::arg("referenceIn"), py::arg("initialTransformationParameters"))
+				.def("compute", (TransformationParameters (ICP::*)(const DataPoints&, const DataPoints&, const TransformationParameters&)) &ICP::compute, py::arg("readingIn"), py::arg("referenceIn"), py::arg("initialTransformationParameters"))
+				.def("prepareReference", [](ICP& self, const DataPoints& referenceIn)
+				{
+					return std::const_pointer_cast<PreparedReference>(self.prepareReference(referenceIn));
+				}, py::arg("referenceIn"))
+				.def("prepareReferenceConcurrently", [](const ICP& self, const DataPoints& referenceIn)
+				{
+					return std::const_pointer_cast<PreparedReference>(self.prepareReferenceConcurrently(referenceIn));
+				}, py::arg("referenceIn"), py::call_guard<py::gil_scoped_release>())
+				.def("compute", (TransformationParameters (ICP::*)(const DataPoints&, const PreparedReference&, const TransformationParameters&)) &ICP::compute, py::arg("readingIn"), py::arg("reference"), py::arg("initialTransformationParameters"))
+				.def("computeConcurrently", &ICP::computeConcurrently, py::arg("readingIn"), py::arg("reference"), py::arg("initialTransformationParameters"), py::call_guard<py::gil_scoped_release>())
 				.def("getReadingFiltered", &ICP::getReadingFiltered, "Return the filtered point cloud reading used in the ICP chain");
 		}
 	}
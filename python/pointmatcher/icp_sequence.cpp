@@ -21,6 +21,9 @@ Warning: used with caution, you need to set the map manually.
 				.def("compute", &ICPSequence::compute, py::arg("cloudIn"), py::arg("initialTransformationParameters"))
 
 				.def("hasMap", &ICPSequence::hasMap).def("setMap", &ICPSequence::setMap)
+				.def("addToMap", &ICPSequence::addToMap, py::arg("cloud"), py::arg("T_map_cloud"))
+				.def("removeFromMap", &ICPSequence::removeFromMap, py::arg("boxMin"), py::arg("boxMax"))
+				.def("getMapSegmentCount", &ICPSequence::getMapSegmentCount)
 				.def("clearMap", &ICPSequence::clearMap).def("setDefault", &ICPSequence::setDefault)
 				.def("loadFromYaml", [](ICPSequence& self, const std::string& in)
 				{
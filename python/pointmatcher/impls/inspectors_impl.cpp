@@ -61,6 +61,40 @@ namespace python
 					.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
 
 					.def("init", &VTKFileInspector::init).def("finish", &VTKFileInspector::finish);
+
+				using ProfilingInspector = InspectorsImpl::ProfilingInspector;
+				py::class_<ProfilingInspector, std::shared_ptr<ProfilingInspector>, Inspector> pyProfilingInspector(pyInspectorsImpl, "ProfilingInspector");
+
+				using StageSummary = ProfilingInspector::StageSummary;
+				py::class_<StageSummary>(pyProfilingInspector, "StageSummary", "Summary of the timings of a stage and module, durations are in seconds")
+					.def_readonly("stage", &StageSummary::stage, "name of the stage")
+					.def_readonly("module", &StageSummary::module, "class name of the module, empty for whole chains")
+					.def_readonly("count", &StageSummary::count, "number of timings recorded")
+					.def_readonly("totalDuration", &StageSummary::totalDuration, "sum of all durations recorded")
+					.def_readonly("p50", &StageSummary::p50, "median of the durations in the ring buffer")
+					.def_readonly("p95", &StageSummary::p95, "95th percentile of the durations in the ring buffer")
+					.def_readonly("p99", &StageSummary::p99, "99th percentile of the durations in the ring buffer")
+					.def_readonly("meanPointCount", &StageSummary::meanPointCount, "mean number of points given to the stage");
+
+				pyProfilingInspector
+					.def_static("description", &ProfilingInspector::description)
+					.def_static("availableParameters", &ProfilingInspector::availableParameters)
+
+					.def_readonly("ringSize", &ProfilingInspector::ringSize)
+					.def_readonly("traceFileName", &ProfilingInspector::traceFileName)
+					.def_readonly("traceFormat", &ProfilingInspector::traceFormat)
+					.def_readonly("bDumpSummaryOnExit", &ProfilingInspector::bDumpSummaryOnExit)
+
+					.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
+
+					.def("getSummaries", &ProfilingInspector::getSummaries)
+					.def("reset", &ProfilingInspector::reset)
+					.def("dumpStats", [](ProfilingInspector& self)
+					{
+						std::ostringstream oss;
+						self.dumpStats(oss);
+						py::print(oss.str());
+					});
 			}
 		}
 	}
@@ -46,6 +46,7 @@ namespace python
 					.def_static("availableParameters", &MedianDistOutlierFilter::availableParameters)
 
 					.def_readonly("factor", &MedianDistOutlierFilter::factor)
+					.def_readonly("quantileRelativeError", &MedianDistOutlierFilter::quantileRelativeError)
 
 					.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
 					.def("compute", &MedianDistOutlierFilter::compute, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("input"));
@@ -56,6 +57,7 @@ namespace python
 					.def_static("availableParameters", &TrimmedDistOutlierFilter::availableParameters)
 
 					.def_readonly("ratio", &TrimmedDistOutlierFilter::ratio)
+					.def_readonly("quantileRelativeError", &TrimmedDistOutlierFilter::quantileRelativeError)
 
 					.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
 					.def("compute", &TrimmedDistOutlierFilter::compute, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("input"));
@@ -68,6 +70,7 @@ namespace python
 					.def_readonly("minRatio", &VarTrimmedDistOutlierFilter::minRatio)
 					.def_readonly("maxRatio", &VarTrimmedDistOutlierFilter::maxRatio)
 					.def_readonly("lambda", &VarTrimmedDistOutlierFilter::lambda)
+					.def_readonly("quantileRelativeError", &VarTrimmedDistOutlierFilter::quantileRelativeError)
 
 					.def(py::init<const Parameters&>(), py::arg("params") = Parameters())
 					.def("compute", &VarTrimmedDistOutlierFilter::compute, py::arg("filteredReading"), py::arg("filteredReference"), py::arg("input"));
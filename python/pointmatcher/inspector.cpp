@@ -6,7 +6,19 @@ namespace python
 	{
 		void pybindInspector(py::class_<PM>& p_class)
 		{
-			py::class_<Inspector, std::shared_ptr<Inspector>, Parametrizable>(p_class, "Inspector", "An inspector allows to log data at the different steps, for analysis.")
+			py::class_<Inspector, std::shared_ptr<Inspector>, Parametrizable> pyInspector(p_class, "Inspector", "An inspector allows to log data at the different steps, for analysis.");
+
+			using StageTiming = Inspector::StageTiming;
+			py::class_<StageTiming>(pyInspector, "StageTiming", "Duration of a stage of a registration, reported to the inspectors that record timings")
+				.def(py::init<>())
+				.def_readwrite("stage", &StageTiming::stage, "name of the stage, for instance Matcher or DataPointsFilter")
+				.def_readwrite("module", &StageTiming::module, "class name of the module run by the stage, empty if the stage runs a whole chain")
+				.def_readwrite("iteration", &StageTiming::iteration, "iteration of the registration, -1 for the stages run outside of the iterations")
+				.def_readwrite("startTime", &StageTiming::startTime, "start of the stage, in seconds from an arbitrary epoch")
+				.def_readwrite("duration", &StageTiming::duration, "duration of the stage, in seconds")
+				.def_readwrite("pointCount", &StageTiming::pointCount, "number of points given to the stage");
+
+			pyInspector
 				.def(py::init<>())
 				.def(py::init<const std::string&, const ParametersDoc, const Parameters&>(), py::arg("className"), py::arg("paramsDoc"), py::arg("params"))
 
@@ -25,6 +37,9 @@ namespace python
 					py::print(oss.str());
 				})
 
+				.def("recordsTimings", &Inspector::recordsTimings)
+				.def("addTiming", &Inspector::addTiming, py::arg("timing"))
+
 				.def("dumpIteration", &Inspector::dumpIteration, py::arg("iterationNumber"), py::arg("parameters"), py::arg("filteredReference"), py::arg("reading"), py::arg("matches"), py::arg("outlierWeights"), py::arg("transformationCheckers"))
 				.def("finish", &Inspector::finish, py::arg("iterationCount"));
 		}
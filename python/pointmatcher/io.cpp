@@ -74,10 +74,13 @@ The order is important (i.e., nx before ny). This can also be used to remap 1D d
 				.def_static("saveVTK", (void (*)(const DataPoints&, const std::string&, bool)) &PMIO::saveVTK, py::arg("data"), py::arg("fileName"), py::arg("binary") = false)
 
 				.def_static("loadPLY", (DataPoints (*)(const std::string&)) &PMIO::loadPLY, py::arg("fileName"))
-				.def_static("savePLY", (void (*)(const DataPoints&, const std::string&)) &PMIO::savePLY, py::arg("data"), py::arg("fileName"), "save datapoints to PLY point cloud format")
+				.def_static("savePLY", (void (*)(const DataPoints&, const std::string&, bool)) &PMIO::savePLY, py::arg("data"), py::arg("fileName"), py::arg("binary") = false, "save datapoints to PLY point cloud format")
 
 				.def_static("loadPCD", (DataPoints (*)(const std::string&)) &PMIO::loadPCD, py::arg("fileName"))
-				.def_static("savePCD", (void (*)(const DataPoints&, const std::string&)) &PMIO::savePCD, py::arg("data"), py::arg("fileName"), "save datapoints to PCD point cloud format");
+				.def_static("savePCD", (void (*)(const DataPoints&, const std::string&, bool)) &PMIO::savePCD, py::arg("data"), py::arg("fileName"), py::arg("binary") = false, "save datapoints to PCD point cloud format")
+
+				.def_static("loadPMD", &PMIO::loadPMD, py::arg("fileName"))
+				.def_static("savePMD", &PMIO::savePMD, py::arg("data"), py::arg("fileName"), "save datapoints to the native binary point cloud format");
 
 			using FileInfo = PMIO::FileInfo;
 			using Vector3 = FileInfo::Vector3;
@@ -198,7 +201,7 @@ Implementation of PLY element interface for the vertex element
 				.def_readwrite("height", &PCDheader::height, "height of sensor matrix")
 				.def_readwrite("viewPoint", &PCDheader::viewPoint, "not used")
 				.def_readwrite("nbPoints", &PCDheader::nbPoints, "number of points, same as width*height")
-				.def_readwrite("dataType", &PCDheader::dataType, "ascii or binary")
+				.def_readwrite("dataType", &PCDheader::dataType, "ascii, binary or binary_compressed")
 
 				.def(py::init<>());
 		}
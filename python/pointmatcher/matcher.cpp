@@ -7,9 +7,10 @@ namespace python
 		void pybindMatcher(py::class_<PM>& p_class)
 		{
 			py::class_<Matcher, std::shared_ptr<Matcher>, Parametrizable>(p_class, "Matcher")
-				.def_readwrite("visitCounter", &Matcher::visitCounter)
+				.def_property("visitCounter", [](const Matcher& self) { return self.visitCounter.load(); }, [](Matcher& self, unsigned long visitCounter) { self.visitCounter = visitCounter; })
 
-				.def("resetVisitCount", &Matcher::resetVisitCount).def("getVisitCount", &Matcher::getVisitCount);
+				.def("resetVisitCount", &Matcher::resetVisitCount).def("getVisitCount", &Matcher::getVisitCount)
+				.def("allowsConcurrentQueries", &Matcher::allowsConcurrentQueries);
 		}
 	}
 }
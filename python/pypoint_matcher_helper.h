@@ -26,6 +26,7 @@ using OutlierFilter = PM::OutlierFilter;
 using OutlierFilters = PM::OutlierFilters;
 using ErrorMinimizer = PM::ErrorMinimizer;
 using ErrorElements = ErrorMinimizer::ErrorElements;
+using KeptMatches = ErrorMinimizer::KeptMatches;
 using TransformationChecker = PM::TransformationChecker;
 using TransformationCheckers = PM::TransformationCheckers;
 using Inspector = PM::Inspector;
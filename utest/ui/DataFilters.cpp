@@ -1,6 +1,7 @@
 #include "../utest.h"
 #include <ciso646>
 #include <cmath>
+#include "Eigen/Eigenvalues"
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -239,6 +240,108 @@ TEST_F(DataFilterTest, SurfaceNormalDataPointsFilter)
 	// 3- impact on ICP (that's what we test now)
 }
 
+TEST_F(DataFilterTest, SurfaceNormalDataPointsFilter3DFastPath)
+{
+	const int knn = 7;
+	params = PM::Parameters();
+	params["knn"] = toParam(knn);
+	params["keepNormals"] = "1";
+	params["keepDensities"] = "1";
+	params["keepEigenValues"] = "1";
+	params["keepEigenVectors"] = "1";
+	params["keepMatchedIds"] = "1";
+	params["keepMeanDist"] = "1";
+	params["sortEigen"] = "1";
+	params["nbThreads"] = "4";
+
+	std::shared_ptr<PM::DataPointsFilter> normalFilter =
+		PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params);
+	const DP input = generateRandomDataPoints(500);
+	const DP cloud = normalFilter->filter(input);
+
+	params["nbThreads"] = "1";
+	std::shared_ptr<PM::DataPointsFilter> singleThreadFilter =
+		PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params);
+	const DP singleThreadCloud = singleThreadFilter->filter(input);
+	EXPECT_TRUE(cloud.getDescriptorViewByName("normals").cwiseAbs() == singleThreadCloud.getDescriptorViewByName("normals").cwiseAbs());
+
+	// Compare with a general eigen decomposition of the neighbors
+	const DP::ConstView normals = cloud.getDescriptorViewByName("normals");
+	const DP::ConstView eigValues = cloud.getDescriptorViewByName("eigValues");
+	const DP::ConstView eigVectors = cloud.getDescriptorViewByName("eigVectors");
+	const DP::ConstView matchedIds = cloud.getDescriptorViewByName("matchedIds");
+	const DP::ConstView densities = cloud.getDescriptorViewByName("densities");
+	const DP::ConstView meanDists = cloud.getDescriptorViewByName("meanDists");
+	for(int i = 0; i < cloud.getNbPoints(); i += 10)
+	{
+		PM::Matrix d(3, knn);
+		for(int j = 0; j < knn; ++j)
+			d.col(j) = cloud.features.block(0, int(matchedIds(j, i)), 3, 1);
+		const PM::Vector mean = d.rowwise().sum() / knn;
+		const PM::Matrix NN = d.colwise() - mean;
+		const Eigen::EigenSolver<PM::Matrix> solver(NN * NN.transpose());
+		PM::Vector expectedValues = solver.eigenvalues().real();
+		std::sort(expectedValues.data(), expectedValues.data() + 3);
+
+		for(int k = 0; k < 3; ++k)
+			EXPECT_NEAR(expectedValues(k), eigValues(k, i), 1e-4);
+		const PM::Vector normal = normals.col(i);
+		EXPECT_NEAR(1, normal.norm(), 1e-4);
+		EXPECT_NEAR(expectedValues(0), (NN * NN.transpose() * normal).dot(normal), 1e-4);
+		EXPECT_NEAR(normal(0), eigVectors(0, i), 1e-6);
+		EXPECT_NEAR(normal(1), eigVectors(3, i), 1e-6);
+		EXPECT_NEAR(normal(2), eigVectors(6, i), 1e-6);
+		EXPECT_NEAR(knn / (4. / 3. * M_PI * std::pow(NN.colwise().norm().maxCoeff(), 3)), densities(0, i), 1e-2 * densities(0, i));
+		EXPECT_NEAR((cloud.features.block(0, i, 3, 1) - mean).norm(), meanDists(0, i), 1e-5);
+	}
+
+	// In double, the sorted eigen decomposition is computed in closed form
+	typedef PointMatcher<double> PMD;
+	PMD::DataPoints::Labels doubleLabels;
+	for(const DP::Label& label: input.featureLabels)
+		doubleLabels.push_back(PMD::DataPoints::Label(label.text, label.span));
+	const PMD::DataPoints doubleInput(input.features.cast<double>(), doubleLabels);
+	const PMD::DataPoints doubleCloud =
+		PMD::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params)->filter(doubleInput);
+	const PMD::DataPoints::ConstView doubleNormals = doubleCloud.getDescriptorViewByName("normals");
+	const PMD::DataPoints::ConstView doubleEigValues = doubleCloud.getDescriptorViewByName("eigValues");
+	for(int i = 0; i < cloud.getNbPoints(); i += 10)
+	{
+		for(int k = 0; k < 3; ++k)
+			EXPECT_NEAR(eigValues(k, i), doubleEigValues(k, i), 1e-4);
+		EXPECT_NEAR(1, std::abs(normals.col(i).cast<double>().dot(doubleNormals.col(i))), 1e-3);
+	}
+
+	// Without sorting, the eigenvalues and eigenvectors keep the order and the sign of the general eigen decomposition
+	params["sortEigen"] = "0";
+	const DP unsortedCloud =
+		PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params)->filter(input);
+	const DP::ConstView unsortedNormals = unsortedCloud.getDescriptorViewByName("normals");
+	const DP::ConstView unsortedValues = unsortedCloud.getDescriptorViewByName("eigValues");
+	const DP::ConstView unsortedVectors = unsortedCloud.getDescriptorViewByName("eigVectors");
+	for(int i = 0; i < unsortedCloud.getNbPoints(); i += 10)
+	{
+		PM::Matrix d(3, knn);
+		for(int j = 0; j < knn; ++j)
+			d.col(j) = unsortedCloud.features.block(0, int(matchedIds(j, i)), 3, 1);
+		const PM::Vector mean = d.rowwise().sum() / knn;
+		const PM::Matrix NN = d.colwise() - mean;
+		const Eigen::EigenSolver<PM::Matrix> solver(NN * NN.transpose());
+		const PM::Vector expectedValues = solver.eigenvalues().real();
+		const PM::Matrix expectedVectors = solver.eigenvectors().real();
+
+		int smallestId;
+		expectedValues.minCoeff(&smallestId);
+		for(int k = 0; k < 3; ++k)
+		{
+			EXPECT_NEAR(expectedValues(k), unsortedValues(k, i), 1e-4);
+			EXPECT_NEAR(expectedVectors(k, smallestId), unsortedNormals(k, i), 1e-3);
+			for(int l = 0; l < 3; ++l)
+				EXPECT_NEAR(expectedVectors(k, l), unsortedVectors(k*3 + l, i), 1e-3);
+		}
+	}
+}
+
 TEST_F(DataFilterTest, MaxDensityDataPointsFilter)
 {
 	// Ratio has been selected to not affect the points too much
@@ -493,6 +596,38 @@ TEST_F(DataFilterTest, OctreeGridDataPointsFilter)
 			}
 }
 
+TEST_F(DataFilterTest, LinearOctreeGridDataPointsFilter)
+{
+	DP cloud3D = generateRandomDataPoints(20000);
+	DP cloud2D(cloud3D);
+	cloud2D.features = cloud3D.features.bottomRows(3);
+	cloud2D.featureLabels = DP::Labels();
+	cloud2D.featureLabels.push_back(DP::Label("x", 1));
+	cloud2D.featureLabels.push_back(DP::Label("y", 1));
+	cloud2D.featureLabels.push_back(DP::Label("pad", 1));
+
+	// The linear octree has the same leaves, visited in the same order,
+	// so every sampling method gives the same cloud
+	for(const DP& cloud : {cloud3D, cloud2D})
+		for(const int meth : {0,1,2,3})
+			for(const size_t maxData : {1,5})
+				for(const float maxSize : {0.,0.05})
+				{
+					params.clear();
+					params["maxPointByNode"] = toParam(maxData);
+					params["maxSizeByNode"] = toParam(maxSize);
+					params["samplingMethod"] = toParam(meth);
+					params["buildParallel"] = "1";
+
+					params["linear"] = "0";
+					const DP filteredCloud = PM::get().DataPointsFilterRegistrar.create("OctreeGridDataPointsFilter", params)->filter(cloud);
+					params["linear"] = "1";
+					const DP linearFilteredCloud = PM::get().DataPointsFilterRegistrar.create("OctreeGridDataPointsFilter", params)->filter(cloud);
+
+					EXPECT_TRUE(linearFilteredCloud == filteredCloud);
+				}
+}
+
 TEST_F(DataFilterTest, NormalSpaceDataPointsFilter)
 {
 	const size_t nbPts = 60000;
@@ -671,6 +806,66 @@ TEST_F(DataFilterTest, VoxelGridDataPointsFilter)
 	}
 }
 
+TEST_F(DataFilterTest, SparseVoxelGridDataPointsFilter)
+{
+	const DP cloud = generateRandomDataPoints(1000);
+
+	params = PM::Parameters();
+	params["vSizeX"] = "0.3";
+	params["vSizeY"] = "0.3";
+	params["vSizeZ"] = "0.3";
+	params["useCentroid"] = toParam(true);
+	params["averageExistingDescriptors"] = toParam(true);
+
+	// With centroids, the sparse grid must give the same result as the dense one
+	std::shared_ptr<PM::DataPointsFilter> denseFilter =
+			PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+	params["useSparseGrid"] = toParam(true);
+	std::shared_ptr<PM::DataPointsFilter> sparseFilter =
+			PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+
+	const DP denseCloud = denseFilter->filter(cloud);
+	const DP sparseCloud = sparseFilter->filter(cloud);
+	EXPECT_GT(cloud.getNbPoints(), sparseCloud.getNbPoints());
+	EXPECT_TRUE(denseCloud == sparseCloud);
+
+	// With centers, every point must lie in the middle of a voxel
+	params["useCentroid"] = toParam(false);
+	sparseFilter = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+	const DP centerCloud = sparseFilter->filter(cloud);
+	EXPECT_EQ(sparseCloud.getNbPoints(), centerCloud.getNbPoints());
+	const PM::Vector minValues = cloud.features.rowwise().minCoeff();
+	for (unsigned i = 0; i < centerCloud.getNbPoints(); ++i)
+	{
+		for (int d = 0; d < 3; ++d)
+		{
+			const NumericType coord = centerCloud.features(d, i) / 0.3 - minValues(d) / 0.3;
+			EXPECT_NEAR(coord - floor(coord), 0.5, 1e-3);
+		}
+	}
+
+	// Memory of the sparse grid does not depend on the extent of the cloud
+	DP farCloud = generateRandomDataPoints(10);
+	farCloud.features(0, 0) = 1e4;
+	farCloud.features(1, 1) = -1e4;
+	farCloud.features(2, 2) = 1e4;
+	params = PM::Parameters();
+	params["vSizeX"] = "0.001";
+	params["vSizeY"] = "0.001";
+	params["vSizeZ"] = "0.001";
+	denseFilter = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+	params["useSparseGrid"] = toParam(true);
+	sparseFilter = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+	EXPECT_THROW(denseFilter->filter(farCloud), PM::DataPointsFilter::InvalidParameter);
+	EXPECT_THROW(sparseFilter->filter(farCloud), PM::DataPointsFilter::InvalidParameter);
+
+	params["vSizeX"] = "0.01";
+	params["vSizeY"] = "0.01";
+	params["vSizeZ"] = "0.01";
+	sparseFilter = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params);
+	EXPECT_EQ(farCloud.getNbPoints(), sparseFilter->filter(farCloud).getNbPoints());
+}
+
 TEST_F(DataFilterTest, CutAtDescriptorThresholdDataPointsFilter)
 {
 	// Copied from density ratio above
@@ -822,6 +1017,45 @@ TEST_F(DataFilterTest, SameFilterInstanceTwice)
 	icp.readingDataPointsFilters.push_back(df);
 }
 
+TEST_F(DataFilterTest, FusedPredicateFilters)
+{
+	PM::DataPointsFilters filters;
+	params = PM::Parameters();
+	params["xMin"] = "-0.5";
+	params["xMax"] = "0.5";
+	params["yMin"] = "-0.5";
+	params["yMax"] = "0.5";
+	params["zMin"] = "-0.5";
+	params["zMax"] = "0.5";
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("BoundingBoxDataPointsFilter", params));
+	params = PM::Parameters();
+	params["maxDist"] = "1.5";
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("MaxDistDataPointsFilter", params));
+	params = PM::Parameters();
+	params["dim"] = "1";
+	params["ratio"] = "0.9";
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("MaxQuantileOnAxisDataPointsFilter", params));
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("ObservationDirectionDataPointsFilter"));
+	params = PM::Parameters();
+	params["minDist"] = "0.2";
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("MinDistDataPointsFilter", params));
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("RemoveNaNDataPointsFilter"));
+
+	// Compacting the cloud once per run of predicate filters gives the same cloud
+	const DP cloud = generateRandomDataPoints(1000);
+	DP filteredCloud(cloud);
+	filters.apply(filteredCloud);
+	DP fusedCloud(cloud);
+	filters.fusePredicates = true;
+	filters.apply(fusedCloud);
+	EXPECT_GT(cloud.getNbPoints(), fusedCloud.getNbPoints());
+	EXPECT_TRUE(fusedCloud == filteredCloud);
+
+	// A keep mask can only be updated by predicate filters
+	PM::DataPointsFilter::KeepMask keep(PM::DataPointsFilter::KeepMask::Constant(cloud.getNbPoints(), true));
+	EXPECT_THROW(filters[3]->updateKeepMask(cloud, keep), runtime_error);
+}
+
 TEST_F(DataFilterTest, RemoveSensorBiasDataPointsFilter)
 {
 	const size_t nbPts = 6;
@@ -907,6 +1141,16 @@ TEST_F(DataFilterTest, SaliencyDataPointsFilter)
 
 	addFilter("SaliencyDataPointsFilter", params);
 	validate3dTransformation();
+
+	// The votes are accumulated by several threads over several rounds, which only changes the order of the sums
+	const DP cloud = generateRandomDataPoints(10000);
+	params["nbThreads"] = "4";
+	const DP multiThreadCloud = PM::get().DataPointsFilterRegistrar.create("SaliencyDataPointsFilter", params)->filter(cloud);
+	params["nbThreads"] = "1";
+	const DP singleThreadCloud = PM::get().DataPointsFilterRegistrar.create("SaliencyDataPointsFilter", params)->filter(cloud);
+	EXPECT_TRUE(multiThreadCloud.getDescriptorViewByName("surfaceness").isApprox(singleThreadCloud.getDescriptorViewByName("surfaceness"), 1e-4));
+	EXPECT_TRUE(multiThreadCloud.getDescriptorViewByName("curveness").isApprox(singleThreadCloud.getDescriptorViewByName("curveness"), 1e-4));
+	EXPECT_TRUE(multiThreadCloud.getDescriptorViewByName("pointness").isApprox(singleThreadCloud.getDescriptorViewByName("pointness"), 1e-4));
 }
 
 TEST_F(DataFilterTest, SpectralDecompositionDataPointsFilter)
@@ -1,4 +1,5 @@
 #include "../utest.h"
+#include "pointmatcher/DataPoints3D.h"
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -345,3 +346,39 @@ TEST(PointCloudTest, AddRemove)
 	EXPECT_TRUE(ref3DCopy.descriptors.isApprox(ref3D.descriptors));
 
 }
+
+TEST(PointCloudTest, FixedSizeViews3D)
+{
+	typedef DataPoints3D<NumericType> DP3D;
+
+	DP cloud(ref3D);
+	cloud.addDescriptor("intensity", PM::Matrix::Random(1, cloud.getNbPoints()));
+	cloud.addDescriptor("normals", PM::Matrix::Random(3, cloud.getNbPoints()));
+	cloud.addDescriptor("eigValues", PM::Matrix::Random(2, cloud.getNbPoints()));
+
+	ASSERT_TRUE(DP3D::isApplicable(cloud));
+	EXPECT_FALSE(DP3D::isApplicable(data2D));
+	EXPECT_TRUE(DP3D::hasDescriptor3D(cloud, "normals"));
+	EXPECT_FALSE(DP3D::hasDescriptor3D(cloud, "eigValues"));
+
+	// Views read the columns in place
+	const DP& constCloud(cloud);
+	const DP3D::ConstColumns points(DP3D::points(constCloud));
+	const DP3D::ConstColumns normals(DP3D::descriptor(constCloud, "normals"));
+	ASSERT_EQ(points.size(), cloud.features.cols());
+	ASSERT_EQ(normals.size(), cloud.descriptors.cols());
+	const DP::ConstView normalsView(constCloud.getDescriptorViewByName("normals"));
+	for (int i = 0; i < cloud.features.cols(); ++i)
+	{
+		EXPECT_TRUE(points[i] == cloud.features.block(0, i, 3, 1));
+		EXPECT_TRUE(normals[i] == normalsView.col(i));
+	}
+
+	// Writable views write through to the cloud
+	const DP3D::Vector3 value(1, 2, 3);
+	DP3D::descriptor(cloud, "normals")[1] = value;
+	DP3D::points(cloud)[2] = value;
+	EXPECT_TRUE(cloud.getDescriptorViewByName("normals").col(1) == value);
+	EXPECT_TRUE(cloud.features.block(0, 2, 3, 1) == value);
+	EXPECT_EQ(cloud.features(3, 2), 1);
+}
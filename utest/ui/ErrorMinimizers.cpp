@@ -1,4 +1,5 @@
 #include "../utest.h"
+#include "pointmatcher/ErrorMinimizersImpl.h"
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -105,3 +106,236 @@ TEST_F(ErrorMinimizerTest, ErrorElements)
 
 }
 
+
+TEST_F(ErrorMinimizerTest, ErrorElementsCompaction)
+{
+	// Large enough to be split between threads
+	const int nbPoints = 100000;
+	const int knn = 3;
+
+	DP reading(PM::Matrix::Random(4, nbPoints), data3D.featureLabels);
+	reading.addDescriptor("dummyDesc", PM::Matrix::Random(2, nbPoints));
+	reading.addTime("dummyTime", PM::Int64Matrix::Random(1, nbPoints));
+	DP reference(PM::Matrix::Random(4, nbPoints), data3D.featureLabels);
+	reference.addDescriptor("normals", PM::Matrix::Random(3, nbPoints));
+
+	// Matches with some invalid entries and zero weights
+	PM::Matches matches(PM::Matches::Dists(knn, nbPoints), PM::Matches::Ids(knn, nbPoints));
+	PM::OutlierWeights weights(knn, nbPoints);
+	for (int i = 0; i < nbPoints; ++i)
+	{
+		for (int k = 0; k < knn; ++k)
+		{
+			matches.ids(k, i) = (i * 7 + k * 13) % nbPoints;
+			matches.dists(k, i) = (i + k) % 11 == 0 ? PM::Matches::InvalidDist : NumericType(k + 1);
+			weights(k, i) = (i * k) % 5 == 1 ? 0 : NumericType(1) / (k + 1);
+		}
+	}
+
+	// Serial reference implementation
+	std::vector<int> expectedReadingIds, expectedReferenceIds;
+	int expectedRejectedMatches(0), expectedRejectedPoints(0);
+	for (int i = 0; i < nbPoints; ++i)
+	{
+		bool matchExist(false);
+		for (int k = 0; k < knn; ++k)
+		{
+			if (matches.dists(k, i) == PM::Matches::InvalidDist)
+				continue;
+			if (weights(k, i) != 0)
+			{
+				expectedReadingIds.push_back(i);
+				expectedReferenceIds.push_back(matches.ids(k, i));
+				matchExist = true;
+			}
+			else
+				++expectedRejectedMatches;
+		}
+		if (!matchExist)
+			++expectedRejectedPoints;
+	}
+
+	const PM::ErrorMinimizer::ErrorElements mPts(reading, reference, weights, matches);
+	const int keptCount(expectedReadingIds.size());
+	ASSERT_EQ(mPts.reading.getNbPoints(), unsigned(keptCount));
+	ASSERT_EQ(mPts.reference.getNbPoints(), unsigned(keptCount));
+	EXPECT_EQ(mPts.nbRejectedMatches, expectedRejectedMatches);
+	EXPECT_EQ(mPts.nbRejectedPoints, expectedRejectedPoints);
+	EXPECT_FLOAT_EQ(mPts.pointUsedRatio, NumericType(keptCount) / (knn * nbPoints));
+	EXPECT_EQ(mPts.reading.descriptorLabels, reading.descriptorLabels);
+	EXPECT_EQ(mPts.reference.descriptorLabels, reference.descriptorLabels);
+	for (int j = 0; j < keptCount; ++j)
+	{
+		ASSERT_TRUE(mPts.reading.features.col(j) == reading.features.col(expectedReadingIds[j]));
+		ASSERT_TRUE(mPts.reading.descriptors.col(j) == reading.descriptors.col(expectedReadingIds[j]));
+		ASSERT_TRUE(mPts.reading.times.col(j) == reading.times.col(expectedReadingIds[j]));
+		ASSERT_TRUE(mPts.reference.features.col(j) == reference.features.col(expectedReferenceIds[j]));
+		ASSERT_TRUE(mPts.reference.descriptors.col(j) == reference.descriptors.col(expectedReferenceIds[j]));
+		ASSERT_EQ(mPts.matches.ids(0, j), expectedReferenceIds[j]);
+	}
+
+	// A single match per point, all kept: the reading is kept as a whole
+	const PM::Matches firstMatches(PM::Matches::Dists(PM::Matches::Dists::Ones(1, nbPoints)), PM::Matches::Ids(matches.ids.topRows(1)));
+	const PM::ErrorMinimizer::KeptMatches allKept(PM::OutlierWeights::Ones(1, nbPoints), firstMatches);
+	EXPECT_TRUE(allKept.allReadingPointsKept);
+	const PM::ErrorMinimizer::ErrorElements densePts(reading, reference, allKept);
+	EXPECT_TRUE(densePts.reading == reading);
+	EXPECT_TRUE(densePts.reference.features.col(12) == reference.features.col(firstMatches.ids(0, 12)));
+	EXPECT_EQ(densePts.nbRejectedPoints, 0);
+	EXPECT_EQ(densePts.pointUsedRatio, 1);
+}
+
+TEST_F(ErrorMinimizerTest, PointToPointWeightedSums)
+{
+	// Large enough to be split between threads
+	const int nbPoints = 100000;
+	const int knn = 2;
+
+	PM::TransformationParameters groundTruth(PM::TransformationParameters::Identity(4, 4));
+	groundTruth.topLeftCorner(3, 3) = Eigen::AngleAxis<NumericType>(0.3, Eigen::Matrix<NumericType, 3, 1>(1, 2, 3).normalized()).toRotationMatrix();
+	groundTruth.topRightCorner(3, 1) << 0.5, -0.2, 0.1;
+
+	DP reference(PM::Matrix::Random(4, nbPoints), data3D.featureLabels);
+	reference.features.row(3).setOnes();
+	DP reading(reference);
+	reading.features = groundTruth.inverse() * reference.features;
+
+	// Exact matches, with invalid entries, zero weights and wrong second matches
+	PM::Matches matches(PM::Matches::Dists(knn, nbPoints), PM::Matches::Ids(knn, nbPoints));
+	PM::OutlierWeights weights(knn, nbPoints);
+	for (int i = 0; i < nbPoints; ++i)
+	{
+		matches.ids(0, i) = i;
+		matches.dists(0, i) = i % 13 == 0 ? PM::Matches::InvalidDist : NumericType(1);
+		weights(0, i) = i % 7 == 0 ? 0 : NumericType(1 + i % 3);
+		matches.ids(1, i) = (i + 1) % nbPoints;
+		matches.dists(1, i) = NumericType(2);
+		weights(1, i) = 0;
+	}
+
+	std::shared_ptr<PM::ErrorMinimizer> minimizer(PM::get().ErrorMinimizerRegistrar.create("PointToPointErrorMinimizer"));
+	const PM::TransformationParameters streamed(minimizer->compute(reading, reference, weights, matches));
+	EXPECT_TRUE(streamed.isApprox(groundTruth, 1e-4)) << streamed;
+
+	// Same result and statistics as from gathered paired points
+	const PM::ErrorMinimizer::ErrorElements mPts(reading, reference, weights, matches);
+	const PM::TransformationParameters gathered(minimizer->compute(mPts));
+	EXPECT_TRUE(streamed.isApprox(gathered, 1e-5)) << streamed << "\n" << gathered;
+	EXPECT_FLOAT_EQ(minimizer->getPointUsedRatio(), mPts.pointUsedRatio);
+	EXPECT_FLOAT_EQ(minimizer->getWeightedPointUsedRatio(), mPts.weightedPointUsedRatio);
+	EXPECT_FLOAT_EQ(minimizer->getOverlap(), mPts.weightedPointUsedRatio);
+	EXPECT_EQ(minimizer->getErrorElements().nbRejectedMatches, mPts.nbRejectedMatches);
+	EXPECT_EQ(minimizer->getErrorElements().nbRejectedPoints, mPts.nbRejectedPoints);
+	EXPECT_EQ(minimizer->getErrorElements().reading.getNbPoints(), 0u);
+
+	// The paired points are gathered on request
+	std::shared_ptr<PM::ErrorMinimizer> keepingMinimizer(PM::get().ErrorMinimizerRegistrar.create("PointToPointErrorMinimizer", {{"keepErrorElements", "1"}}));
+	EXPECT_TRUE(keepingMinimizer->compute(reading, reference, weights, matches).isApprox(streamed, 1e-5));
+	EXPECT_EQ(keepingMinimizer->getErrorElements().reading.getNbPoints(), mPts.reading.getNbPoints());
+	EXPECT_EQ(keepingMinimizer->getErrorElements().reference.getNbPoints(), mPts.reference.getNbPoints());
+
+	// Derived minimizers are solved by their own compute(const ErrorElements&)
+	struct CountingMinimizer: public PointToPointErrorMinimizer<NumericType>
+	{
+		int calls = 0;
+		CountingMinimizer(): PointToPointErrorMinimizer<NumericType>("CountingMinimizer", ParametersDoc(), Parameters()) {}
+		virtual TransformationParameters compute(const ErrorElements& mPts)
+		{
+			++calls;
+			return PointToPointErrorMinimizer<NumericType>::compute(mPts);
+		}
+	};
+	std::shared_ptr<CountingMinimizer> countingMinimizer(new CountingMinimizer());
+	EXPECT_TRUE(std::static_pointer_cast<PM::ErrorMinimizer>(countingMinimizer)->compute(reading, reference, weights, matches).isApprox(streamed, 1e-5));
+	EXPECT_EQ(countingMinimizer->calls, 1);
+
+	// 2D clouds use the same solver
+	DP reference2D(PM::Matrix::Random(3, 1000), data2D.featureLabels);
+	reference2D.features.row(2).setOnes();
+	PM::TransformationParameters groundTruth2D(PM::TransformationParameters::Identity(3, 3));
+	groundTruth2D.topLeftCorner(2, 2) = Eigen::Rotation2D<NumericType>(0.2).toRotationMatrix();
+	groundTruth2D.topRightCorner(2, 1) << 0.3, 0.1;
+	DP reading2D(reference2D);
+	reading2D.features = groundTruth2D.inverse() * reference2D.features;
+	PM::Matches matches2D(PM::Matches::Dists::Ones(1, 1000), PM::Matches::Ids(1, 1000));
+	for (int i = 0; i < 1000; ++i)
+		matches2D.ids(0, i) = i;
+	const PM::TransformationParameters streamed2D(minimizer->compute(reading2D, reference2D, PM::OutlierWeights::Ones(1, 1000), matches2D));
+	EXPECT_TRUE(streamed2D.isApprox(groundTruth2D, 1e-4)) << streamed2D;
+}
+
+TEST_F(ErrorMinimizerTest, PointToPlaneNormalEquations)
+{
+	// Large enough to be split between threads
+	const int nbPoints = 100000;
+
+	DP reference(PM::Matrix::Random(4, nbPoints), data3D.featureLabels);
+	reference.features.row(3).setOnes();
+	PM::Matrix normals(PM::Matrix::Random(3, nbPoints));
+	normals.colwise().normalize();
+	reference.addDescriptor("normals", normals);
+
+	PM::Matches matches(PM::Matches::Dists::Ones(1, nbPoints), PM::Matches::Ids(1, nbPoints));
+	PM::OutlierWeights weights(1, nbPoints);
+	for (int i = 0; i < nbPoints; ++i)
+	{
+		matches.ids(0, i) = i;
+		weights(0, i) = NumericType(1 + i % 3);
+	}
+
+	struct Variant
+	{
+		std::string force2D;
+		std::string force4DOF;
+		PM::TransformationParameters groundTruth;
+	};
+	std::vector<Variant> variants(3, Variant{"0", "0", PM::TransformationParameters::Identity(4, 4)});
+	// A small rotation, for which the linearized solution is close to the exact one
+	variants[0].groundTruth.topLeftCorner(3, 3) = Eigen::AngleAxis<NumericType>(0.01, Eigen::Matrix<NumericType, 3, 1>(1, 2, 3).normalized()).toRotationMatrix();
+	variants[0].groundTruth.topRightCorner(3, 1) << 0.05, -0.02, 0.01;
+	variants[1].force4DOF = "1";
+	variants[1].groundTruth.topLeftCorner(3, 3) = Eigen::AngleAxis<NumericType>(0.01, Eigen::Matrix<NumericType, 3, 1>::UnitZ()).toRotationMatrix();
+	variants[1].groundTruth.topRightCorner(3, 1) << 0.05, -0.02, 0.01;
+	variants[2].force2D = "1";
+	variants[2].groundTruth.topLeftCorner(3, 3) = Eigen::AngleAxis<NumericType>(0.01, Eigen::Matrix<NumericType, 3, 1>::UnitZ()).toRotationMatrix();
+	variants[2].groundTruth.topRightCorner(3, 1) << 0.05, -0.02, 0;
+
+	for (const Variant& variant: variants)
+	{
+		std::shared_ptr<PM::ErrorMinimizer> minimizer(PM::get().ErrorMinimizerRegistrar.create("PointToPlaneErrorMinimizer", {{"force2D", variant.force2D}, {"force4DOF", variant.force4DOF}}));
+		DP reading(reference);
+		reading.features = variant.groundTruth.inverse() * reference.features;
+		const PM::TransformationParameters result(minimizer->compute(reading, reference, weights, matches));
+		EXPECT_TRUE(result.isApprox(variant.groundTruth, 1e-3)) << "force2D: " << variant.force2D << ", force4DOF: " << variant.force4DOF << "\n" << result;
+
+		// A pure translation is solved exactly
+		DP translated(reference);
+		translated.features.topRows(3).colwise() -= variant.groundTruth.topRightCorner(3, 1).col(0);
+		const PM::TransformationParameters translation(minimizer->compute(translated, reference, weights, matches));
+		PM::TransformationParameters expected(PM::TransformationParameters::Identity(4, 4));
+		expected.topRightCorner(3, 1) = variant.groundTruth.topRightCorner(3, 1);
+		EXPECT_TRUE(translation.isApprox(expected, 1e-4)) << "force2D: " << variant.force2D << ", force4DOF: " << variant.force4DOF << "\n" << translation;
+	}
+
+	// 2D clouds
+	DP reference2D(PM::Matrix::Random(3, nbPoints), data2D.featureLabels);
+	reference2D.features.row(2).setOnes();
+	PM::Matrix normals2D(PM::Matrix::Random(2, nbPoints));
+	normals2D.colwise().normalize();
+	reference2D.addDescriptor("normals", normals2D);
+	PM::TransformationParameters groundTruth2D(PM::TransformationParameters::Identity(3, 3));
+	groundTruth2D.topLeftCorner(2, 2) = Eigen::Rotation2D<NumericType>(0.01).toRotationMatrix();
+	groundTruth2D.topRightCorner(2, 1) << 0.05, -0.02;
+	DP reading2D(reference2D);
+	reading2D.features = groundTruth2D.inverse() * reference2D.features;
+	setError("PointToPlaneErrorMinimizer");
+	const PM::TransformationParameters result2D(errorMin->compute(reading2D, reference2D, weights, matches));
+	EXPECT_TRUE(result2D.isApprox(groundTruth2D, 1e-3)) << result2D;
+
+	// 3D clouds need 3D normals
+	DP withoutNormals(reference.features, reference.featureLabels);
+	EXPECT_THROW(errorMin->compute(reference, withoutNormals, weights, matches), PM::DataPoints::InvalidField);
+	DP withNormals2D(withoutNormals);
+	withNormals2D.addDescriptor("normals", normals2D);
+	EXPECT_THROW(errorMin->compute(reference, withNormals2D, weights, matches), PM::DataPoints::InvalidField);
+}
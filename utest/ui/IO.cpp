@@ -252,6 +252,76 @@ TEST(IOTest, loadPLY)
 }
 
 
+// Append a value to a buffer in big endian, whatever the platform endianness
+template<typename S>
+static void appendBigEndian(std::string& data, const S value)
+{
+	char bytes[sizeof(S)];
+	std::memcpy(bytes, &value, sizeof(S));
+	const uint16_t one(1);
+	if(*reinterpret_cast<const uint8_t*>(&one) == 1)
+		std::reverse(bytes, bytes + sizeof(S));
+	data.append(bytes, sizeof(S));
+}
+
+TEST(IOTest, loadBinaryPLY)
+{
+	typedef PointMatcherIO<float> IO;
+
+	std::string data;
+	// face element stored before the vertices
+	appendBigEndian(data, uint8_t(3)); appendBigEndian(data, int32_t(0)); appendBigEndian(data, int32_t(1)); appendBigEndian(data, int32_t(2));
+	for(int i = 0; i < 3; ++i)
+	{
+		appendBigEndian(data, double(i)); appendBigEndian(data, float(2*i)); appendBigEndian(data, int16_t(-i));
+		appendBigEndian(data, uint8_t(2)); appendBigEndian(data, uint32_t(7)); appendBigEndian(data, uint32_t(8));
+		appendBigEndian(data, uint8_t(255)); appendBigEndian(data, int32_t(10*i));
+	}
+
+	std::istringstream is(
+	"ply\n"
+	"format binary_big_endian 1.0\n"
+	"element face 1\n"
+	"property list uchar int vertex_indices\n"
+	"element vertex 3\n"
+	"property double x\n"
+	"property float32 y\n"
+	"property short z\n"
+	"property list uint8 uint32 ids\n"
+	"property uchar red\n"
+	"property int grrrr\n"
+	"end_header\n" + data);
+
+	const DP pointCloud = IO::loadPLY(is);
+
+	EXPECT_EQ(3, pointCloud.getNbPoints());
+	EXPECT_EQ(4, pointCloud.features.rows()); //x, y, z, pad
+	EXPECT_TRUE(pointCloud.descriptorExists("color", 1));
+	EXPECT_TRUE(pointCloud.descriptorExists("grrrr", 1));
+	EXPECT_FALSE(pointCloud.descriptorExists("ids"));
+	for(int i = 0; i < 3; ++i)
+	{
+		EXPECT_EQ(i, pointCloud.features(0, i));
+		EXPECT_EQ(2*i, pointCloud.features(1, i));
+		EXPECT_EQ(-i, pointCloud.features(2, i));
+		EXPECT_EQ(1, pointCloud.getDescriptorViewByName("color")(0, i));
+		EXPECT_EQ(10*i, pointCloud.getDescriptorViewByName("grrrr")(0, i));
+	}
+
+	// truncated data
+	std::istringstream truncated(
+	"ply\n"
+	"format binary_little_endian 1.0\n"
+	"element vertex 3\n"
+	"property float x\n"
+	"property float y\n"
+	"end_header\n"
+	"12345678");
+
+	EXPECT_THROW(IO::loadPLY(truncated), runtime_error);
+}
+
+
 TEST(IOTest, loadPCD)
 {
 	typedef PointMatcherIO<float> IO;
@@ -340,6 +410,86 @@ TEST(IOTest, loadPCD)
 
 }
 
+// Append a value to a buffer in the platform endianness
+template<typename S>
+static void appendNative(std::string& data, const S value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(S));
+}
+
+TEST(IOTest, loadBinaryPCD)
+{
+	typedef PointMatcherIO<float> IO;
+
+	const std::string header(
+	"# .PCD v.7 - Point Cloud Data file format\n"
+	"VERSION .7\n"
+	"FIELDS x y z _ intensity\n"
+	"SIZE 4 4 8 1 2\n"
+	"TYPE F F F U U\n"
+	"COUNT 1 1 1 3 1\n"
+	"WIDTH 3\n"
+	"HEIGHT 1\n"
+	"VIEWPOINT 0 0 0 1 0 0 0\n"
+	"POINTS 3\n");
+
+	// binary, one point after the other
+	std::string data;
+	for(int i = 0; i < 3; ++i)
+	{
+		appendNative(data, float(i)); appendNative(data, float(2*i)); appendNative(data, double(-i));
+		data.append(3, '\0');
+		appendNative(data, uint16_t(10*i));
+	}
+	std::istringstream binary(header + "DATA binary\n" + data);
+	const DP binaryCloud = IO::loadPCD(binary);
+
+	EXPECT_EQ(3, binaryCloud.getNbPoints());
+	EXPECT_EQ(4, binaryCloud.features.rows()); //x, y, z, pad
+	EXPECT_EQ(1, binaryCloud.descriptors.rows()); //intensity, without padding
+	for(int i = 0; i < 3; ++i)
+	{
+		EXPECT_EQ(i, binaryCloud.features(0, i));
+		EXPECT_EQ(2*i, binaryCloud.features(1, i));
+		EXPECT_EQ(-i, binaryCloud.features(2, i));
+		EXPECT_EQ(10*i, binaryCloud.getDescriptorViewByName("intensity")(0, i));
+	}
+
+	std::istringstream truncated(header + "DATA binary\n" + data.substr(0, data.size() - 1));
+	EXPECT_THROW(IO::loadPCD(truncated), runtime_error);
+
+	// binary_compressed, one field after the other
+	std::string fields;
+	for(int i = 0; i < 3; ++i) appendNative(fields, float(i));
+	for(int i = 0; i < 3; ++i) appendNative(fields, float(2*i));
+	for(int i = 0; i < 3; ++i) appendNative(fields, double(-i));
+	const std::string before(fields);
+	for(int i = 0; i < 3; ++i) appendNative(fields, uint16_t(10*i));
+	const std::string after(fields.substr(before.size()));
+
+	// LZF stream made of literal runs, and of a back reference for the padding
+	std::string lzf;
+	for(size_t begin = 0; begin < before.size(); begin += 32)
+	{
+		const size_t length(std::min<size_t>(32, before.size() - begin));
+		lzf += char(length - 1);
+		lzf += before.substr(begin, length);
+	}
+	lzf += char(0); lzf += char(0); // one literal null byte
+	lzf += char(6 << 5); lzf += char(0); // copy the previous byte 8 times
+	lzf += char(after.size() - 1);
+	lzf += after;
+
+	std::string sizes;
+	appendNative(sizes, uint32_t(lzf.size()));
+	appendNative(sizes, uint32_t(before.size() + 9 + after.size()));
+	std::istringstream compressed(header + "DATA binary_compressed\n" + sizes + lzf);
+	const DP compressedCloud = IO::loadPCD(compressed);
+
+	EXPECT_TRUE(compressedCloud.features == binaryCloud.features);
+	EXPECT_TRUE(compressedCloud.descriptors == binaryCloud.descriptors);
+}
+
 class IOLoadSaveTest : public testing::Test
 {
 
@@ -413,6 +563,30 @@ public:
 
 	}
 
+	// read the saved file by chunks, and compare to the whole cloud
+	void chunkedLoadTest(const unsigned chunkSize = 3)
+	{
+		PointMatcherIO<float>::DataPointsChunkReader reader(testFileName, chunkSize);
+		EXPECT_EQ(ptCloudFromFile.getNbPoints(), reader.getNbPoints());
+
+		DP chunk;
+		unsigned col = 0;
+		while (reader.read(chunk))
+		{
+			const unsigned n = chunk.getNbPoints();
+			ASSERT_LE(n, chunkSize);
+			ASSERT_LE(col + n, ptCloudFromFile.getNbPoints());
+			EXPECT_TRUE(chunk.featureLabels == ptCloudFromFile.featureLabels);
+			EXPECT_TRUE(chunk.descriptorLabels == ptCloudFromFile.descriptorLabels);
+			EXPECT_TRUE(chunk.timeLabels == ptCloudFromFile.timeLabels);
+			EXPECT_TRUE(chunk.features == ptCloudFromFile.features.middleCols(col, n));
+			EXPECT_TRUE(chunk.descriptors == ptCloudFromFile.descriptors.middleCols(col, n));
+			EXPECT_TRUE(chunk.times == ptCloudFromFile.times.middleCols(col, n));
+			col += n;
+		}
+		EXPECT_EQ(ptCloudFromFile.getNbPoints(), col);
+	}
+
 	virtual void TearDown()
 	{
 		EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(testFileName)));
@@ -458,14 +632,110 @@ TEST_F(IOLoadSaveTest, VTKBinary)
 TEST_F(IOLoadSaveTest, PLY)
 {
 	loadSaveTest(dataPath + "unit_test.ply", true);
+	chunkedLoadTest();
+}
+
+TEST_F(IOLoadSaveTest, PLYBinary)
+{
+	loadSaveTest(dataPath + "unit_test.bin.ply", true, 10, true);
+	chunkedLoadTest();
 }
 
 TEST_F(IOLoadSaveTest, PCD)
 {
 	loadSaveTest(dataPath + "unit_test.pcd");
+	chunkedLoadTest();
+}
+
+TEST_F(IOLoadSaveTest, PCDBinary)
+{
+	loadSaveTest(dataPath + "unit_test.bin.pcd", false, 10, true);
+	chunkedLoadTest();
 }
 
 TEST_F(IOLoadSaveTest, CSV)
 {
 	loadSaveTest(dataPath + "unit_test.csv");
 }
+
+TEST_F(IOLoadSaveTest, PMD)
+{
+	ptCloud.addTime("genericTime", PM::Int64Matrix::Random(1, nbPts));
+
+	loadSaveTest(dataPath + "unit_test.pmd");
+
+	EXPECT_TRUE(ptCloudFromFile == ptCloud);
+
+	// the mapped cloud exposes the same data without copy
+	const PointMatcherIO<float>::MappedDataPoints mappedCloud(testFileName);
+	EXPECT_EQ(ptCloud.getNbPoints(), mappedCloud.getNbPoints());
+	EXPECT_TRUE(mappedCloud.featureLabels == ptCloud.featureLabels);
+	EXPECT_TRUE(mappedCloud.descriptorLabels == ptCloud.descriptorLabels);
+	EXPECT_TRUE(mappedCloud.timeLabels == ptCloud.timeLabels);
+	EXPECT_TRUE(mappedCloud.features() == ptCloud.features);
+	EXPECT_TRUE(mappedCloud.descriptors() == ptCloud.descriptors);
+	EXPECT_TRUE(mappedCloud.times() == ptCloud.times);
+
+	// a truncated file is rejected
+	const string truncatedFileName(dataPath + "unit_test_truncated.pmd");
+	{
+		std::ifstream ifs(testFileName.c_str(), std::ios::binary);
+		const string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		std::ofstream ofs(truncatedFileName.c_str(), std::ios::binary);
+		ofs << content.substr(0, content.size() - 1);
+	}
+	EXPECT_THROW(DP::load(truncatedFileName), runtime_error);
+	EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(truncatedFileName)));
+
+	// corrupted label lengths and spans are rejected, the first feature label starting after 48 bytes of header
+	const string corruptedFileName(dataPath + "unit_test_corrupted.pmd");
+	const auto saveCorrupted = [&](const size_t pos, const string& value)
+	{
+		std::ifstream ifs(testFileName.c_str(), std::ios::binary);
+		string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		content.replace(pos, value.size(), value);
+		std::ofstream ofs(corruptedFileName.c_str(), std::ios::binary);
+		ofs << content;
+	};
+	const uint32_t hugeLength(0xffffffff);
+	saveCorrupted(48, string(reinterpret_cast<const char*>(&hugeLength), sizeof(hugeLength)));
+	EXPECT_THROW(DP::load(corruptedFileName), runtime_error);
+	const uint64_t hugeSpan(uint64_t(1) << 62);
+	saveCorrupted(48 + sizeof(uint32_t) + ptCloud.featureLabels[0].text.size(), string(reinterpret_cast<const char*>(&hugeSpan), sizeof(hugeSpan)));
+	EXPECT_THROW(DP::load(corruptedFileName), runtime_error);
+	EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(corruptedFileName)));
+
+	// scalars of another size cannot be mapped
+	EXPECT_THROW(PointMatcherIO<double>::MappedDataPoints mapped(testFileName), runtime_error);
+
+	chunkedLoadTest();
+}
+
+TEST_F(IOLoadSaveTest, LoadFiltered)
+{
+	loadSaveTest(dataPath + "unit_test.pcd", false, 10, true);
+
+	PM::Parameters params;
+	params["xMin"] = "-0.5";
+	params["xMax"] = "0.5";
+	params["yMin"] = "-0.5";
+	params["yMax"] = "0.5";
+	params["zMin"] = "-0.5";
+	params["zMax"] = "0.5";
+	PM::DataPointsFilters filters;
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("BoundingBoxDataPointsFilter", params));
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("RemoveNaNDataPointsFilter"));
+
+	// filtering by chunks gives the same cloud as filtering the whole cloud
+	DP filteredCloud(ptCloudFromFile);
+	filters.apply(filteredCloud);
+	const DP chunkFilteredCloud = PointMatcherIO<float>::loadFiltered(testFileName, filters, 3);
+	EXPECT_TRUE(chunkFilteredCloud == filteredCloud);
+
+	// filters depending on neighboring points are rejected
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+	EXPECT_THROW(PointMatcherIO<float>::loadFiltered(testFileName, filters, 3), runtime_error);
+
+	// formats without random access are rejected
+	EXPECT_THROW(PointMatcherIO<float>::DataPointsChunkReader reader(dataPath + "2D_oneBox.csv"), runtime_error);
+}
@@ -1,4 +1,5 @@
 #include "../utest.h"
+#include "pointmatcher/InspectorsImpl.h"
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -33,3 +34,60 @@ TEST(Inspectors, VTKFileInspector)
 		);
 	//TODO: we only test constructor here, check other things...
 }
+
+TEST(Inspectors, ProfilingInspector)
+{
+	typedef InspectorsImpl<PM::ScalarType>::ProfilingInspector ProfilingInspector;
+	
+	const std::string traceFileName("/tmp/utest_profiling_trace.json");
+	std::shared_ptr<ProfilingInspector> profiling(new ProfilingInspector({
+		{"ringSize", "4"},
+		{"traceFileName", traceFileName},
+		{"traceFormat", "chrome"}
+	}));
+	ASSERT_TRUE(profiling->recordsTimings());
+	
+	PM::ICP icp;
+	icp.setDefault();
+	icp.inspector = profiling;
+	icp(data3D, ref3D);
+	
+	const ProfilingInspector::StageSummaries summaries(profiling->getSummaries());
+	std::map<std::string, size_t> counts;
+	for (const ProfilingInspector::StageSummary& summary: summaries)
+	{
+		counts[summary.stage] += summary.count;
+		EXPECT_LE(summary.p50, summary.p95);
+		EXPECT_LE(summary.p95, summary.p99);
+		EXPECT_GE(summary.totalDuration, summary.p99);
+	}
+	
+	// every stage of the registration is recorded, the filters once per module
+	const size_t iterationCount(counts["Matcher"]);
+	EXPECT_GT(iterationCount, 0u);
+	EXPECT_EQ(counts["ReadingDataPointsFilters"], 1u);
+	EXPECT_EQ(counts["ReferenceDataPointsFilters"], 1u);
+	EXPECT_EQ(counts["MatcherInit"], 1u);
+	EXPECT_EQ(counts["DataPointsFilter"], icp.readingDataPointsFilters.size() + icp.referenceDataPointsFilters.size());
+	EXPECT_EQ(counts["Transformation"], iterationCount);
+	EXPECT_EQ(counts["OutlierFilter"], iterationCount * icp.outlierFilters.size());
+	EXPECT_EQ(counts["ErrorElements"], iterationCount);
+	EXPECT_EQ(counts["ErrorMinimization"], iterationCount);
+	EXPECT_EQ(counts["TransformationCheckers"], iterationCount);
+	
+	// without an inspector recording timings, nothing is measured
+	icp.inspector = PM::get().REG(Inspector).create("NullInspector");
+	icp(data3D, ref3D);
+	EXPECT_EQ(profiling->getSummaries().size(), summaries.size());
+	EXPECT_EQ(profiling->getSummaries().front().count, summaries.front().count);
+	
+	// the trace is a JSON array once the inspector is destroyed
+	icp.inspector.reset();
+	profiling.reset();
+	std::ifstream trace(traceFileName.c_str());
+	const std::string content((std::istreambuf_iterator<char>(trace)), std::istreambuf_iterator<char>());
+	ASSERT_GT(content.size(), 2u);
+	EXPECT_EQ(content.front(), '[');
+	EXPECT_EQ(content.substr(content.size() - 2), "]\n");
+	EXPECT_NE(content.find("\"cat\":\"Matcher\""), std::string::npos);
+}
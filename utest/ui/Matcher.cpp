@@ -61,3 +61,70 @@ TEST_F(MatcherTest, KDTreeMatcher)
 		}
 	}
 }
+
+TEST_F(MatcherTest, KDTreeMatcherMultithreaded)
+{
+	std::shared_ptr<PM::Matcher> serialMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", {{"knn", "3"}, {"maxDist", "0.5"}});
+	std::shared_ptr<PM::Matcher> parallelMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", {{"knn", "3"}, {"maxDist", "0.5"}, {"nbThreads", "4"}});
+
+	serialMatcher->init(ref3D);
+	parallelMatcher->init(ref3D);
+	const PM::Matches serialMatches(serialMatcher->findClosests(data3D));
+	const PM::Matches parallelMatches(parallelMatcher->findClosests(data3D));
+
+	// Results must be identical to the serial search, including visit statistics
+	EXPECT_TRUE(serialMatches.ids == parallelMatches.ids);
+	EXPECT_TRUE(serialMatches.dists == parallelMatches.dists);
+	EXPECT_EQ(serialMatcher->getVisitCount(), parallelMatcher->getVisitCount());
+
+	addFilter("KDTreeMatcher", {{"nbThreads", "0"}});
+	validate2dTransformation();
+	validate3dTransformation();
+}
+
+TEST_F(MatcherTest, WarmStartKDTreeMatcher)
+{
+	// Inspector keeping the last value of every statistic
+	struct StatsInspector: public PM::Inspector
+	{
+		std::map<std::string, double> stats;
+		virtual void addStat(const std::string& name, double data) { stats[name] = data; }
+	} inspector;
+
+	for (const std::string neighborhoodSize : {"0", "4"})
+	{
+		std::shared_ptr<PM::Matcher> kdTreeMatcher =
+			PM::get().MatcherRegistrar.create("KDTreeMatcher", {{"knn", "2"}});
+		std::shared_ptr<PM::Matcher> warmStartMatcher =
+			PM::get().MatcherRegistrar.create("WarmStartKDTreeMatcher", {{"knn", "2"}, {"neighborhoodSize", neighborhoodSize}});
+		kdTreeMatcher->init(ref3D);
+		warmStartMatcher->init(ref3D);
+
+		// Move the reading by smaller and smaller steps, as in ICP
+		std::shared_ptr<PM::Transformation> rigidTrans = PM::get().REG(Transformation).create("RigidTransformation");
+		PM::DataPoints reading(data3D);
+		for (int i = 0; i < 5; ++i)
+		{
+			const NumericType step(0.1 / (1 << (2 * i)));
+			PM::TransformationParameters T(PM::TransformationParameters::Identity(4, 4));
+			T.topLeftCorner(3, 3) = Eigen::AngleAxis<NumericType>(step, Eigen::Matrix<NumericType, 3, 1>::UnitZ()).toRotationMatrix();
+			T(0, 3) = step;
+			rigidTrans->inPlaceCompute(T, reading);
+
+			const PM::Matches expected(kdTreeMatcher->findClosests(reading));
+			const PM::Matches matches(warmStartMatcher->findClosests(reading));
+			EXPECT_TRUE(expected.ids == matches.ids);
+			EXPECT_TRUE(expected.dists.isApprox(matches.dists));
+		}
+
+		warmStartMatcher->addStats(inspector);
+		EXPECT_EQ(inspector.stats["WarmStartHitCount"] + inspector.stats["WarmStartMissCount"], 5 * data3D.getNbPoints());
+		EXPECT_GT(inspector.stats["WarmStartHitCount"], 0);
+	}
+
+	addFilter("WarmStartKDTreeMatcher", {{"knn", "2"}, {"maxDist", "0.5"}});
+	validate2dTransformation();
+	validate3dTransformation();
+}
@@ -1,5 +1,10 @@
 #include "../utest.h"
 #include "pointmatcher/OutlierFiltersImpl.h"
+#include "pointmatcher/MatchesStatistics.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -111,6 +116,14 @@ TEST_F(OutlierFilterTest, TrimmedDistOutlierFilter)
 }
 
 
+TEST_F(OutlierFilterTest, TrimmedDistOutlierFilterApproximate)
+{
+	addFilter("TrimmedDistOutlierFilter", {{"ratio", toParam(0.85)}, {"quantileRelativeError", toParam(0.01)}});
+	validate2dTransformation();
+	validate3dTransformation();
+}
+
+
 TEST_F(OutlierFilterTest, VarTrimmedDistOutlierFilter)
 {
 	addFilter("VarTrimmedDistOutlierFilter", {
@@ -150,3 +163,86 @@ TEST_F(OutlierFilterTest, VarTrimmedDistOutlierFilterParameters)
 	ASSERT_EQ(1.0f, weights(0, 0));
 	ASSERT_EQ(1.0f, weights(0, 1));
 }
+
+TEST_F(OutlierFilterTest, MatchesStatistics)
+{
+	// Squared distances spanning several orders of magnitude, with zeros and invalid matches
+	const int nbPoints = 100000;
+	const int knn = 2;
+	PM::Matches::Dists dists(knn, nbPoints);
+	std::mt19937 generator(42);
+	std::lognormal_distribution<NumericType> distribution(-4, 2);
+	for (int i = 0; i < dists.size(); ++i)
+		dists(i) = i % 17 == 0 ? PM::Matches::InvalidDist : i % 101 == 0 ? 0 : distribution(generator);
+	const PM::Matches matches(dists, PM::Matches::Ids::Zero(knn, nbPoints));
+
+	std::vector<NumericType> sorted;
+	for (int i = 0; i < dists.size(); ++i)
+		if (dists(i) != PM::Matches::InvalidDist)
+			sorted.push_back(dists(i));
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<NumericType> deviations;
+	for (const NumericType dist: sorted)
+		deviations.push_back(std::fabs(dist - sorted[sorted.size() / 2]));
+	std::sort(deviations.begin(), deviations.end());
+	const NumericType mad = deviations[deviations.size() / 2];
+
+	// Exact statistics, queried several times on the same gathered distances
+	MatchesStatistics<NumericType> exact(matches);
+	EXPECT_FALSE(exact.isApproximate());
+	EXPECT_EQ(exact.size(), sorted.size());
+	EXPECT_EQ(exact.quantile(0.5), matches.getDistsQuantile(0.5));
+	EXPECT_EQ(exact.medianAbsDeviation(), mad);
+	EXPECT_EQ(exact.medianAbsDeviation(), matches.getMedianAbsDeviation());
+	NumericType sum = 0;
+	std::size_t prefixCount = 0;
+	exact.forEachPrefix(1000, [&](const std::size_t count, const NumericType prefixSum, const NumericType prefixMax)
+	{
+		sum += sorted[count - 1];
+		EXPECT_EQ(count, ++prefixCount);
+		EXPECT_EQ(prefixMax, sorted[count - 1]);
+		EXPECT_FLOAT_EQ(prefixSum, sum);
+	});
+	EXPECT_EQ(prefixCount, 1000u);
+	for (const NumericType ratio: {0.0, 0.1, 0.5, 0.85, 0.99, 1.0})
+		EXPECT_EQ(exact.quantile(ratio), ratio == 1.0 ? sorted.back() : sorted[std::size_t(sorted.size() * NumericType(ratio))]) << ratio;
+
+	// Approximate statistics are within the relative error of the exact ones
+	const NumericType relativeError = 0.01;
+	MatchesStatistics<NumericType> approximate(matches, relativeError);
+	EXPECT_TRUE(approximate.isApproximate());
+	EXPECT_EQ(approximate.size(), sorted.size());
+	for (const NumericType ratio: {0.0, 0.1, 0.5, 0.85, 0.99, 1.0})
+	{
+		const NumericType expected = ratio == 1.0 ? sorted.back() : sorted[std::size_t(sorted.size() * NumericType(ratio))];
+		EXPECT_LE(std::fabs(approximate.quantile(ratio) - expected), 1.01 * relativeError * expected) << ratio;
+	}
+	EXPECT_LE(std::fabs(approximate.medianAbsDeviation() - mad), 1.01 * relativeError * (mad + 2 * sorted[sorted.size() / 2]));
+	std::size_t lastCount = 0;
+	approximate.forEachPrefix(sorted.size() / 2, [&](const std::size_t count, const NumericType prefixSum, const NumericType prefixMax)
+	{
+		EXPECT_GT(count, lastCount);
+		lastCount = count;
+		const double expectedSum = std::accumulate(sorted.begin(), sorted.begin() + count, 0.0);
+		EXPECT_NEAR(prefixSum, expectedSum, 1e-5 * expectedSum);
+		EXPECT_GE(prefixMax, sorted[count - 1]);
+		EXPECT_LE(prefixMax, sorted[count - 1] * (1 + 2.01 * relativeError));
+	});
+	EXPECT_GE(lastCount, sorted.size() / 2);
+
+	// Distances spread over more bins than their number are kept exactly, repeated ones are binned
+	PM::Matches few(PM::Matches::Dists(1, 10), PM::Matches::Ids::Zero(1, 10));
+	for (int i = 0; i < 10; ++i)
+		few.dists(0, i) = std::pow(NumericType(2), i);
+	EXPECT_FALSE(MatchesStatistics<NumericType>(few, relativeError).isApproximate());
+	few.dists.setConstant(2);
+	EXPECT_TRUE(MatchesStatistics<NumericType>(few, relativeError).isApproximate());
+	EXPECT_FLOAT_EQ(MatchesStatistics<NumericType>(few, relativeError).quantile(0.5), 2);
+
+	// Without distances, no statistics
+	const PM::Matches invalid(PM::Matches::Dists::Constant(1, 10, PM::Matches::InvalidDist), PM::Matches::Ids::Zero(1, 10));
+	MatchesStatistics<NumericType> empty(invalid, relativeError);
+	EXPECT_TRUE(empty.empty());
+	EXPECT_THROW(empty.quantile(0.5), PM::ConvergenceError);
+	EXPECT_THROW(empty.medianAbsDeviation(), PM::ConvergenceError);
+}
@@ -60,6 +60,14 @@ static inline void assertOnDataPointsTransformation(const PM::DataPoints& cloud,
     EXPECT_EQ(cloud.descriptorLabels, transformedCloud.descriptorLabels);
     EXPECT_EQ(cloud.timeLabels, transformedCloud.timeLabels);
     EXPECT_EQ(cloud.times, transformedCloud.times);
+
+    // Transforming into a separate cloud must give exactly the same result, also when reusing it.
+    PM::DataPoints outputCloud;
+    for (int i = 0; i < 2; ++i)
+    {
+        transformator->compute(cloud, transformation, outputCloud);
+        EXPECT_TRUE(outputCloud == transformedCloud);
+    }
 }
 
 //---------------------------
@@ -299,6 +307,27 @@ TEST(Transformation, ComputeRigidTransformDataPoints3D)
     }
 }
 
+TEST(Transformation, ComputeRigidTransformLargeDataPoints3D)
+{
+    std::shared_ptr<PM::Transformation> transformator = PM::get().REG(Transformation).create("RigidTransformation");
+
+    // Large enough to be split between threads, with directions around other descriptors.
+    const int nbPoints(300000);
+    PM::Matrix features(PM::Matrix::Random(4, nbPoints));
+    features.row(3).setOnes();
+    PM::DataPoints cloud(features, data3D.featureLabels);
+    cloud.addDescriptor("normals", PM::Matrix::Random(3, nbPoints));
+    cloud.addDescriptor("intensity", PM::Matrix::Random(1, nbPoints));
+    cloud.addDescriptor("observationDirections", PM::Matrix::Random(3, nbPoints));
+
+    const NumericType kEpsilonNumericalError = 1e-6;
+    const Eigen::Matrix<NumericType, 3, 1> translation{ 1, -3, -4 };
+    const Eigen::Quaternion<NumericType> rotation{ 0.3, -2.54, 0.1, 0.5 };
+    const Eigen::Transform<NumericType, 3, Eigen::Affine> transformation = buildUpTransformation3D(translation, rotation);
+    // Transform and assert on the result.
+    assertOnDataPointsTransformation(cloud, transformation.matrix(), transformator, kEpsilonNumericalError);
+}
+
 TEST(Transformation, ComputeSimilarityTransformDataPoints2D)
 {
     std::shared_ptr<PM::Transformation> transformator = PM::get().REG(Transformation).create("SimilarityTransformation");
@@ -34,6 +34,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "utest.h"
+#include "pointmatcher/BatchRegistration.h"
+
+#include <thread>
+#include <type_traits>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -289,6 +293,375 @@ TEST(icpTest, icpSequenceTest)
 	EXPECT_EQ(map.getHomogeneousDim(), 0u);
 }
 
+//! Sequence exposing how its map is indexed
+struct SegmentedSequence: public PM::ICPSequence
+{
+	using PM::ICPSequence::mapPointCloud;
+	using PM::ICPSequence::mapSegments;
+};
+
+TEST(icpTest, icpSequenceIncrementalMapTest)
+{
+	const DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	const DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	const int ptCount(pts0.getNbPoints());
+	
+	// Deterministic chains, so that the map only depends on the points given
+	PM::ICPSequence fullSequence;
+	SegmentedSequence incrementalSequence;
+	for (PM::ICPSequence* sequence: {&fullSequence, static_cast<PM::ICPSequence*>(&incrementalSequence)})
+	{
+		sequence->setDefault();
+		sequence->readingDataPointsFilters.clear();
+		sequence->referenceDataPointsFilters.clear();
+		sequence->errorMinimizer = PM::get().ErrorMinimizerRegistrar.create("PointToPointErrorMinimizer");
+	}
+	
+	// Build the map from the first half of the cloud, and then add the rest by chunks
+	const int firstCount(ptCount / 2);
+	const int chunkSize(1000);
+	EXPECT_TRUE(incrementalSequence.setMap(DP(pts0.features.leftCols(firstCount), pts0.featureLabels)));
+	EXPECT_EQ(incrementalSequence.getMapSegmentCount(), 1u);
+	const DP* const indexedMap(incrementalSequence.mapPointCloud.get());
+	for (int begin = firstCount; begin < ptCount; begin += chunkSize)
+	{
+		const int count(std::min(chunkSize, ptCount - begin));
+		EXPECT_TRUE(incrementalSequence.addToMap(DP(pts0.features.middleCols(begin, count), pts0.featureLabels), PM::Matrix::Identity(4, 4)));
+	}
+	EXPECT_GT(incrementalSequence.getMapSegmentCount(), 1u);
+	EXPECT_LT(incrementalSequence.getMapSegmentCount(), 10u);
+	
+	// The points of setMap() stay indexed by the matcher of the chain, without being copied
+	ASSERT_FALSE(incrementalSequence.mapSegments.empty());
+	EXPECT_EQ(incrementalSequence.mapSegments[0].matcher, incrementalSequence.matcher);
+	EXPECT_EQ(incrementalSequence.mapSegments[0].cloud.get(), indexedMap);
+	EXPECT_EQ(incrementalSequence.mapSegments[0].count, firstCount);
+	EXPECT_EQ(incrementalSequence.getPrefilteredMap().getNbPoints(), unsigned(ptCount));
+	
+	EXPECT_TRUE(fullSequence.setMap(pts0));
+	const PM::TransformationParameters fullT(fullSequence(pts1));
+	const PM::TransformationParameters incrementalT(incrementalSequence(pts1));
+	EXPECT_TRUE(fullT.isApprox(incrementalT, 1e-3)) << fullT << std::endl << incrementalT;
+	
+	// Remove the points with a positive x coordinate
+	PM::Vector boxMin(PM::Vector::Constant(3, -std::numeric_limits<NumericType>::infinity()));
+	PM::Vector boxMax(PM::Vector::Constant(3, std::numeric_limits<NumericType>::infinity()));
+	boxMin(0) = 0;
+	const int removedCount((pts0.features.row(0).array() >= 0).count());
+	EXPECT_EQ(incrementalSequence.removeFromMap(boxMin, boxMax), unsigned(removedCount));
+	const DP remainingMap(incrementalSequence.getPrefilteredMap());
+	EXPECT_EQ(remainingMap.getNbPoints(), unsigned(ptCount - removedCount));
+	EXPECT_TRUE((remainingMap.features.row(0).array() < 0).all());
+	
+	EXPECT_TRUE(fullSequence.setMap(remainingMap));
+	EXPECT_TRUE(fullSequence(pts1).isApprox(incrementalSequence(pts1), 1e-3));
+	
+	// Points added in another frame are expressed in the global frame
+	PM::TransformationParameters T_map_cloud(PM::Matrix::Identity(4, 4));
+	T_map_cloud(0, 3) = 10;
+	EXPECT_TRUE(incrementalSequence.addToMap(DP(pts0.features.leftCols(10), pts0.featureLabels), T_map_cloud));
+	const DP movedMap(incrementalSequence.getPrefilteredMap());
+	EXPECT_NEAR(movedMap.features(0, ptCount - removedCount), pts0.features(0, 0) + 10, 1e-3);
+	
+	incrementalSequence.clearMap();
+	EXPECT_FALSE(incrementalSequence.hasMap());
+	EXPECT_EQ(incrementalSequence.getMapSegmentCount(), 0u);
+}
+
+TEST(icpTest, icpPyramidTest)
+{
+	const DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	const DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	
+	// Deterministic chain, so that both runs only differ by the coarse levels
+	const std::string chain(
+		"matcher:\n"
+		"  KDTreeMatcher:\n"
+		"    knn: 1\n"
+		"outlierFilters:\n"
+		"  - TrimmedDistOutlierFilter:\n"
+		"      ratio: 0.75\n"
+		"errorMinimizer:\n"
+		"  PointToPointErrorMinimizer\n"
+		"transformationCheckers:\n"
+		"  - CounterTransformationChecker:\n"
+		"      maxIterationCount: 100\n"
+		"  - DifferentialTransformationChecker:\n"
+		"      minDiffRotErr: 0.0001\n"
+		"      minDiffTransErr: 0.0001\n"
+		"      smoothLength: 4\n"
+		"inspector:\n"
+		"  NullInspector\n"
+	);
+	const std::string pyramid(
+		"pyramid:\n"
+		"  - maxIterationCount: 20\n"
+		"    referenceDataPointsFilters:\n"
+		"      - VoxelGridDataPointsFilter:\n"
+		"          vSizeX: 0.5\n"
+		"          vSizeY: 0.5\n"
+		"          vSizeZ: 0.5\n"
+		"    readingDataPointsFilters:\n"
+		"      - VoxelGridDataPointsFilter:\n"
+		"          vSizeX: 0.5\n"
+		"          vSizeY: 0.5\n"
+		"          vSizeZ: 0.5\n"
+		"  - maxIterationCount: 10\n"
+		"    referenceDataPointsFilters:\n"
+		"      - VoxelGridDataPointsFilter:\n"
+		"          vSizeX: 0.2\n"
+		"          vSizeY: 0.2\n"
+		"          vSizeZ: 0.2\n"
+	);
+	
+	PM::ICP icp;
+	std::istringstream chainStream(chain);
+	icp.loadFromYaml(chainStream);
+	EXPECT_TRUE(icp.pyramidLevels.empty());
+	const PM::TransformationParameters T(icp(pts0, pts1));
+	
+	PM::ICP pyramidIcp;
+	std::istringstream pyramidStream(chain + pyramid);
+	pyramidIcp.loadFromYaml(pyramidStream);
+	ASSERT_EQ(pyramidIcp.pyramidLevels.size(), 2u);
+	EXPECT_EQ(pyramidIcp.pyramidLevels[0].maxIterationCount, 20u);
+	EXPECT_EQ(pyramidIcp.pyramidLevels[0].readingDataPointsFilters.size(), 1u);
+	EXPECT_EQ(pyramidIcp.pyramidLevels[1].readingDataPointsFilters.size(), 0u);
+	const PM::TransformationParameters pyramidT(pyramidIcp(pts0, pts1));
+	EXPECT_TRUE(T.isApprox(pyramidT, 1e-2)) << T << std::endl << pyramidT;
+	
+	// Unknown entries of a level are rejected like unknown modules
+	PM::ICP invalidIcp;
+	std::istringstream invalidStream(chain + "pyramid:\n  - maxIterationCounts: 10\n");
+	EXPECT_THROW(invalidIcp.loadFromYaml(invalidStream), PointMatcherSupport::InvalidModuleType);
+	
+	// setDefault removes the coarse levels
+	pyramidIcp.setDefault();
+	EXPECT_TRUE(pyramidIcp.pyramidLevels.empty());
+}
+
+//! Matcher recording the cloud passed to init(), to check that it is the cloud kept with the matcher
+struct CloudRecordingMatcher: public PM::Matcher
+{
+	const DP* cloud; //!< cloud passed to init()
+	
+	inline static const std::string description()
+	{
+		return "Brute-force nearest neighbor, recording the indexed cloud.";
+	}
+	
+	CloudRecordingMatcher():
+		PM::Matcher("CloudRecordingMatcher", PM::Matcher::ParametersDoc(), PM::Matcher::Parameters()),
+		cloud(0)
+	{}
+	
+	virtual void init(const DP& filteredReference)
+	{
+		cloud = &filteredReference;
+	}
+	
+	virtual PM::Matches findClosests(const DP& filteredReading)
+	{
+		PM::Matches matches(1, filteredReading.getNbPoints());
+		for (unsigned i = 0; i < filteredReading.getNbPoints(); ++i)
+		{
+			Eigen::Index id;
+			matches.dists(0, i) = (cloud->features.colwise() - filteredReading.features.col(i)).colwise().squaredNorm().minCoeff(&id);
+			matches.ids(0, i) = id;
+		}
+		return matches;
+	}
+};
+
+TEST(icpTest, icpPyramidReferenceLifetimeTest)
+{
+	typedef PointMatcherSupport::Registrar<PM::Matcher>::GenericClassDescriptorNoParam<CloudRecordingMatcher> Descriptor;
+	const_cast<PM&>(PM::get()).MatcherRegistrar.reg("CloudRecordingMatcher", std::make_shared<Descriptor>());
+	
+	const DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	const DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	
+	// Deterministic chain, so that the results only depend on the clouds
+	PM::ICP icp;
+	icp.setDefault();
+	icp.readingDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+	icp.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("MaxDistDataPointsFilter", {{"maxDist", "5"}}));
+	icp.readingDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", {{"vSizeX", "0.2"}, {"vSizeY", "0.2"}, {"vSizeZ", "0.2"}}));
+	icp.matcher = PM::get().MatcherRegistrar.create("CloudRecordingMatcher");
+	icp.pyramidLevels.resize(2);
+	for (PM::ICP::PyramidLevel& level: icp.pyramidLevels)
+	{
+		level.readingDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", {{"vSizeX", "0.5"}, {"vSizeY", "0.5"}, {"vSizeZ", "0.5"}}));
+		level.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", {{"vSizeX", "0.5"}, {"vSizeY", "0.5"}, {"vSizeZ", "0.5"}}));
+	}
+	
+	// Every matcher indexes the cloud kept next to it, not a cloud that was since copied or destroyed
+	const std::shared_ptr<const PM::ICP::PreparedReference> reference(icp.prepareReference(pts0));
+	EXPECT_EQ(std::dynamic_pointer_cast<CloudRecordingMatcher>(reference->matcher)->cloud, &reference->reference);
+	ASSERT_EQ(reference->levels.size(), 2u);
+	const PM::ICP::ReferenceLevels levels(reference->levels);
+	for (size_t l = 0; l < levels.size(); ++l)
+	{
+		ASSERT_TRUE(levels[l].reference != nullptr);
+		EXPECT_EQ(levels[l].reference, reference->levels[l].reference);
+		EXPECT_EQ(std::dynamic_pointer_cast<CloudRecordingMatcher>(levels[l].matcher)->cloud, levels[l].reference.get());
+	}
+	
+	// Registration through the levels matches the one of the chain
+	EXPECT_TRUE(icp.compute(pts1, *reference, PM::Matrix::Identity(4, 4)).isApprox(icp(pts1, pts0), 1e-5));
+}
+
+TEST(icpTest, icpPreparedReferenceTest)
+{
+	const DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	const DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	const DP pts2 = DP::load(dataPath + "cloud.00002.vtk");
+	
+	// Deterministic chain, so that the results only depend on the clouds
+	PM::ICP icp;
+	icp.setDefault();
+	icp.readingDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+	icp.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("MaxDistDataPointsFilter", {{"maxDist", "5"}}));
+	
+	const std::shared_ptr<const PM::ICP::PreparedReference> reference(icp.prepareReference(pts0));
+	EXPECT_EQ(reference->referenceInPointCount, pts0.getNbPoints());
+	EXPECT_LT(reference->reference.getNbPoints(), pts0.getNbPoints());
+	EXPECT_TRUE(reference->levels.empty());
+	
+	// A copy would leave its matchers indexing the clouds of the original
+	static_assert(!std::is_copy_constructible<PM::ICP::PreparedReference>::value, "PreparedReference must not be copyable");
+	static_assert(!std::is_copy_assignable<PM::ICP::PreparedReference>::value, "PreparedReference must not be copyable");
+	
+	// Registering against the chain with other clouds does not alter the prepared reference
+	const PM::TransformationParameters T1(icp(pts1, pts0));
+	const PM::TransformationParameters T2(icp(pts2, pts0));
+	EXPECT_TRUE(icp.compute(pts2, *reference, PM::Matrix::Identity(4, 4)).isApprox(T2, 1e-5));
+	EXPECT_EQ(icp.getPrefilteredReferencePtsCount(), reference->reference.getNbPoints());
+	icp(pts0, pts1);
+	EXPECT_TRUE(icp.compute(pts1, *reference, PM::Matrix::Identity(4, 4)).isApprox(T1, 1e-5));
+	
+	// A reference must be prepared with the coarse levels of the chain
+	icp.pyramidLevels.resize(1);
+	EXPECT_THROW(icp.compute(pts1, *reference, PM::Matrix::Identity(4, 4)), std::runtime_error);
+	const std::shared_ptr<const PM::ICP::PreparedReference> pyramidReference(icp.prepareReference(pts0));
+	EXPECT_EQ(pyramidReference->levels.size(), 1u);
+	EXPECT_TRUE(icp.compute(pts1, *pyramidReference, PM::Matrix::Identity(4, 4)).isApprox(icp(pts1, pts0), 1e-5));
+}
+
+TEST(icpTest, icpConcurrentComputeTest)
+{
+	const DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	const std::vector<DP> readings = {
+		DP::load(dataPath + "cloud.00001.vtk"),
+		DP::load(dataPath + "cloud.00002.vtk")
+	};
+	
+	// Deterministic chain, with a robust outlier filter keeping state between iterations
+	const auto configure = [](PM::ICP& icp)
+	{
+		icp.setDefault();
+		icp.readingDataPointsFilters.clear();
+		icp.outlierFilters.clear();
+		icp.outlierFilters.push_back(PM::get().OutlierFilterRegistrar.create("RobustOutlierFilter", {{"robustFct", "cauchy"}, {"tuning", "1"}, {"scaleEstimator", "berg"}, {"nbIterationForScale", "2"}}));
+	};
+	PM::ICP icp;
+	configure(icp);
+	const std::shared_ptr<const PM::ICP::PreparedReference> reference(icp.prepareReference(pts0));
+	
+	// Sequential registrations, each with a chain in its initial state
+	std::vector<PM::TransformationParameters> expectedTs;
+	for (const DP& reading: readings)
+	{
+		PM::ICP sequentialIcp;
+		configure(sequentialIcp);
+		expectedTs.push_back(sequentialIcp.compute(reading, *reference, PM::Matrix::Identity(4, 4)));
+	}
+	
+	// Every thread registers all readings, in a different order
+	const unsigned threadCount(4);
+	std::vector<std::vector<PM::ICP::Result> > results(threadCount);
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < threadCount; ++t)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			for (size_t i = 0; i < readings.size(); ++i)
+			{
+				const DP& reading(readings[(i + t) % readings.size()]);
+				results[t].push_back(icp.computeConcurrently(reading, *reference, PM::Matrix::Identity(4, 4)));
+			}
+		}));
+	}
+	for (std::thread& thread: threads)
+		thread.join();
+	
+	for (unsigned t = 0; t < threadCount; ++t)
+	{
+		for (size_t i = 0; i < readings.size(); ++i)
+		{
+			const size_t readingId((i + t) % readings.size());
+			const PM::ICP::Result& result(results[t][i]);
+			EXPECT_TRUE(result.transformation.isApprox(expectedTs[readingId], 1e-5)) << result.transformation << std::endl << expectedTs[readingId];
+			EXPECT_EQ(result.readingFiltered.getNbPoints(), readings[readingId].getNbPoints());
+			EXPECT_GT(result.stats.at("IterationsCount"), 0);
+			EXPECT_EQ(result.stats.count("PointCountTouched"), 0u);
+			EXPECT_GT(result.pointUsedRatio, 0);
+		}
+	}
+	
+	// A matcher keeping state between calls cannot be shared by concurrent calls
+	icp.matcher = PM::get().MatcherRegistrar.create("WarmStartKDTreeMatcher");
+	const std::shared_ptr<const PM::ICP::PreparedReference> warmStartReference(icp.prepareReference(pts0));
+	EXPECT_THROW(icp.computeConcurrently(readings[0], *warmStartReference, PM::Matrix::Identity(4, 4)), std::runtime_error);
+}
+
+TEST(icpTest, icpBatchRegistrationTest)
+{
+	typedef BatchRegistration<NumericType> Batch;
+	typedef PointMatcherIO<NumericType> PMIO;
+	
+	const std::shared_ptr<const DP> pts0(std::make_shared<const DP>(DP::load(dataPath + "cloud.00000.vtk")));
+	const std::shared_ptr<const DP> pts1(std::make_shared<const DP>(DP::load(dataPath + "cloud.00001.vtk")));
+	const std::shared_ptr<const DP> pts2(std::make_shared<const DP>(DP::load(dataPath + "cloud.00002.vtk")));
+	
+	// Deterministic chain, so that references prepared separately are identical
+	PM::ICP icp;
+	icp.setDefault();
+	icp.readingDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.clear();
+	icp.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+	
+	const Batch::Pairs pairs = {
+		{pts1, pts0},
+		{pts2, pts0, PM::Matrix::Identity(4, 4)},
+		{pts2, pts1},
+		{pts0, pts1}
+	};
+	const Batch::Outcomes outcomes(Batch(icp, 3).compute(pairs));
+	ASSERT_EQ(outcomes.size(), pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i)
+	{
+		const PM::TransformationParameters expectedT(icp.computeConcurrently(*pairs[i].reading, *icp.prepareReference(*pairs[i].reference), PM::Matrix::Identity(4, 4)).transformation);
+		EXPECT_TRUE(outcomes[i].succeeded()) << outcomes[i].error;
+		EXPECT_TRUE(outcomes[i].result.transformation.isApprox(expectedT, 1e-5)) << outcomes[i].result.transformation << std::endl << expectedT;
+		EXPECT_GT(outcomes[i].result.stats.at("IterationsCount"), 0);
+	}
+	
+	// A pair that fails does not stop the others
+	PMIO::FileInfoVector files;
+	files.push_back(PMIO::FileInfo(dataPath + "cloud.00001.vtk", dataPath + "cloud.00000.vtk"));
+	files.push_back(PMIO::FileInfo(dataPath + "missing.vtk", dataPath + "cloud.00000.vtk"));
+	const Batch::Outcomes fileOutcomes(Batch(icp, 2).compute(files));
+	ASSERT_EQ(fileOutcomes.size(), files.size());
+	EXPECT_TRUE(fileOutcomes[0].succeeded()) << fileOutcomes[0].error;
+	EXPECT_TRUE(fileOutcomes[0].result.transformation.isApprox(outcomes[0].result.transformation, 1e-5));
+	EXPECT_FALSE(fileOutcomes[1].succeeded());
+}
+
 // Utility classes
 class GenericTest: public IcpHelper
 {
@@ -12,6 +12,16 @@
 #include "boost/filesystem/path.hpp"
 #include "boost/filesystem/operations.hpp"
 
+namespace Eigen
+{
+	//! Print matrices in the messages of EXPECT_EQ, as gtest takes them for containers otherwise
+	template<typename Scalar, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+	void PrintTo(const Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>& matrix, std::ostream* os)
+	{
+		*os << "\n" << matrix;
+	}
+}
+
 typedef float NumericType;
 typedef PointMatcher<NumericType> PM;
 typedef PM::DataPoints DP;